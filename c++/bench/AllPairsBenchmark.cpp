@@ -0,0 +1,194 @@
+// AllPairsBenchmark.cpp
+// Compares the blocked Floyd-Warshall engine with the original nested-vector triple loop,
+// then measures how the engine scales with the number of threads, what route lookups cost with next hops,
+// and how price ticks applied incrementally compare with computing everything again
+//
+// usage: allpairs_benchmark [numberOfVertices...]    (default: 250 500 1000)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "DirectedMatrixGraph.h"
+#include "AllPairsShortestPaths.h"
+#include "ThreadPool.h"
+#include "ExchangeGenerator.h"
+
+static const unsigned int kNumberOfHubs = 4;
+static const unsigned int kThreadCounts[] = { 1, 2, 4, 8, 16, 32 };
+static const unsigned int kNumberOfRouteLookups = 100000;
+static const unsigned int kNumberOfTicks = 20;
+static const double kMarketsPerTick = 0.01;
+
+static void buildExchange(DirectedMatrixGraph<std::string>& graph, unsigned int numberOfVertices, std::mt19937& random)
+{
+    for (unsigned int i = 0; i < numberOfVertices; ++i)
+        graph.addVertex(symbolOf(i));
+
+    for (auto& market : generateExchange(ExchangeTopology { numberOfVertices, kNumberOfHubs, 2, 1, false }, random)) {
+        graph.addEdgeById(market.base, market.quote, market.price);
+        graph.addEdgeById(market.quote, market.base, 1.0 / market.price);
+    }
+}
+
+// the all-pairs loop as it was before the blocked engine: copy of the nested vectors, INF checks in the inner loop
+static std::vector< std::vector<double> > referenceFloydWarshall(const std::vector< std::vector<double> >& adjMatrix)
+{
+    const unsigned int V = (unsigned int) adjMatrix.size();
+    std::vector< std::vector<double> > dists(adjMatrix);
+
+    for (unsigned int k = 0; k < V; ++k)
+        for (unsigned int i = 0; i < V; ++i)
+            for (unsigned int j = 0; j < V; ++j)
+                if (dists[i][k] != INF && dists[k][j] != INF && dists[i][k] + dists[k][j] < dists[i][j])
+                    dists[i][j] = dists[i][k] + dists[k][j];
+
+    return dists;
+}
+
+template <class Function>
+static double measureMilliseconds(Function function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<unsigned int> sizes;
+    for (int i = 1; i < argc; ++i)
+        sizes.push_back((unsigned int) std::atoi(argv[i]));
+
+    if (sizes.empty())
+        sizes = { 250, 500, 1000 };
+
+    for (unsigned int numberOfVertices : sizes) {
+        std::mt19937 random(numberOfVertices);
+
+        DirectedMatrixGraph<std::string> graph;
+        buildExchange(graph, numberOfVertices, random);
+
+        std::vector< std::vector<double> > adjMatrix(numberOfVertices, std::vector<double>(numberOfVertices));
+        for (unsigned int i = 0; i < numberOfVertices; ++i)
+            for (unsigned int j = 0; j < numberOfVertices; ++j)
+                adjMatrix[i][j] = graph.getWeightById(i, j);
+
+        std::vector< std::vector<double> > expected;
+        std::vector< std::vector<double> > actual;
+
+        const double referenceMs = measureMilliseconds([&]() { expected = referenceFloydWarshall(adjMatrix); });
+        const double blockedMs = measureMilliseconds([&]() { actual = graph.computeShortestDistanceBetweenAllVertices(); });
+
+        double maxDifference = 0;
+        for (unsigned int i = 0; i < numberOfVertices; ++i)
+            for (unsigned int j = 0; j < numberOfVertices; ++j)
+                maxDifference = std::max(maxDifference, std::abs(expected[i][j] - actual[i][j]));
+
+        std::cout << "computeShortestDistanceBetweenAllVertices vertices=" << numberOfVertices
+                  << " kernel=" << AllPairsShortestPaths::getKernelName()
+                  << " reference_ms=" << referenceMs
+                  << " blocked_ms=" << blockedMs
+                  << " speedup=" << referenceMs / blockedMs
+                  << " max_difference=" << maxDifference << "\n";
+
+        // the parallel runs have to give exactly the serial result
+        AllPairsShortestPaths serial;
+        serial.load(graph);
+        const double serialMs = measureMilliseconds([&]() { serial.compute(); });
+
+        for (unsigned int threads : kThreadCounts) {
+            ThreadPool pool(threads);
+            AllPairsShortestPaths parallel;
+            parallel.load(graph);
+            const double parallelMs = measureMilliseconds([&]() { parallel.compute(&pool); });
+
+            bool identical = true;
+            for (unsigned int i = 0; i < numberOfVertices; ++i)
+                for (unsigned int j = 0; j < numberOfVertices; ++j)
+                    identical = identical && serial.getDistance(i, j) == parallel.getDistance(i, j);
+
+            std::cout << "AllPairsShortestPaths::compute vertices=" << numberOfVertices
+                      << " threads=" << threads
+                      << " hardware_threads=" << ThreadPool::getHardwareConcurrency()
+                      << " ms=" << parallelMs
+                      << " speedup=" << serialMs / parallelMs
+                      << " identical=" << (identical ? "yes" : "no") << "\n";
+        }
+
+        // one run with next hops, then many route lookups from it
+        AllPairsShortestPaths withRoutes(0, true);
+        withRoutes.load(graph);
+        const double routesMs = measureMilliseconds([&]() { withRoutes.compute(); });
+
+        std::vector<unsigned int> route;
+        unsigned long totalHops = 0;
+        const double lookupMs = measureMilliseconds([&]() {
+            for (unsigned int q = 0; q < kNumberOfRouteLookups; ++q) {
+                withRoutes.getRoute((unsigned int) (random() % numberOfVertices), (unsigned int) (random() % numberOfVertices), route);
+                totalHops += route.empty() ? 0 : route.size() - 1;
+            }
+        });
+
+        std::cout << "AllPairsShortestPaths::getRoute vertices=" << numberOfVertices
+                  << " compute_with_routes_ms=" << routesMs
+                  << " lookups=" << kNumberOfRouteLookups
+                  << " mean_lookup_ns=" << lookupMs * 1e6 / kNumberOfRouteLookups
+                  << " mean_hops=" << (double) totalHops / kNumberOfRouteLookups << "\n";
+
+        // ticks that reprice a small share of the markets, applied to the matrices computed above
+        std::vector< std::pair<unsigned int, unsigned int> > markets;
+        for (unsigned int i = 0; i < numberOfVertices; ++i)
+            for (unsigned int j = i + 1; j < numberOfVertices; ++j)
+                if (graph.getWeightById(i, j) != INF)
+                    markets.push_back(std::make_pair(i, j));
+
+        const unsigned int marketsPerTick = std::max(1u, (unsigned int) (kMarketsPerTick * markets.size()));
+        std::uniform_real_distribution<double> price(0.5, 2.0);
+        double incrementalMs = 0;
+        double fullMs = 0;
+        double tickDifference = 0;
+        unsigned long repairedPairs = 0;
+
+        for (unsigned int tick = 0; tick < kNumberOfTicks; ++tick) {
+            std::vector<AllPairsShortestPaths::EdgeChange> changes;
+            for (unsigned int m = 0; m < marketsPerTick; ++m) {
+                const std::pair<unsigned int, unsigned int>& market = markets[random() % markets.size()];
+                const double p = price(random);
+                changes.push_back({ market.first, market.second, graph.getWeightById(market.first, market.second), p });
+                changes.push_back({ market.second, market.first, graph.getWeightById(market.second, market.first), 1.0 / p });
+                graph.addEdgeById(market.first, market.second, p);
+                graph.addEdgeById(market.second, market.first, 1.0 / p);
+            }
+
+            incrementalMs += measureMilliseconds([&]() { repairedPairs += withRoutes.applyEdgeChanges(graph, changes); });
+
+            AllPairsShortestPaths full(0, true);
+            fullMs += measureMilliseconds([&]() {
+                full.load(graph);
+                full.compute();
+            });
+
+            for (unsigned int i = 0; i < numberOfVertices; ++i)
+                for (unsigned int j = 0; j < numberOfVertices; ++j)
+                    tickDifference = std::max(tickDifference, std::abs(full.getDistance(i, j) - withRoutes.getDistance(i, j)));
+        }
+
+        std::cout << "AllPairsShortestPaths::applyEdgeChanges vertices=" << numberOfVertices
+                  << " markets=" << markets.size()
+                  << " markets_per_tick=" << marketsPerTick
+                  << " ticks=" << kNumberOfTicks
+                  << " incremental_ms=" << incrementalMs / kNumberOfTicks
+                  << " full_ms=" << fullMs / kNumberOfTicks
+                  << " speedup=" << fullMs / incrementalMs
+                  << " mean_repaired_pairs=" << (double) repairedPairs / kNumberOfTicks
+                  << " max_difference=" << tickDifference << "\n";
+    }
+
+    return 0;
+}
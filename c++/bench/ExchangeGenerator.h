@@ -0,0 +1,91 @@
+// ExchangeGenerator.h
+// Synthetic exchange topologies shared by the benchmarks
+
+#ifndef KRYPTOS_EXCHANGEGENERATOR_H
+#define KRYPTOS_EXCHANGEGENERATOR_H
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Hub-and-spoke exchange: every asset trades against a few hub currencies, like the quote currencies of an exchange
+// (BTC, ETH, USDT...), and against a few other assets picked at random. The hubs are assets 0 to numberOfHubs - 1
+struct ExchangeTopology {
+    unsigned int numberOfAssets;
+    unsigned int numberOfHubs;
+    unsigned int hubMarketsPerAsset;   // consecutive hubs each asset trades against
+    unsigned int crossMarketsPerAsset; // random assets each asset trades against
+
+    // true for prices that are ratios of asset values, whose logs add up to 0 around every cycle (no arbitrage).
+    // false for independent prices in [0.5, 2)
+    bool consistentPrices;
+};
+
+// one market of the exchange: one unit of base costs price units of quote
+struct Market {
+    unsigned int base;
+    unsigned int quote;
+    double price;
+};
+
+inline std::string symbolOf(unsigned int asset)
+{
+    return "C" + std::to_string(asset);
+}
+
+/*! generateExchange - markets of the topology, the same for the same topology and seed
+ *
+ * A market drawn twice is listed twice, the second price wins when the markets are applied in order
+ */
+inline std::vector<Market> generateExchange(const ExchangeTopology& topology, std::mt19937& random)
+{
+    std::uniform_real_distribution<double> price(0.5, 2.0);
+
+    std::vector<double> values;
+    if (topology.consistentPrices) {
+        std::uniform_real_distribution<double> logValue(-5.0, 5.0);
+        for (unsigned int asset = 0; asset < topology.numberOfAssets; ++asset)
+            values.push_back(std::exp(logValue(random)));
+    }
+
+    std::vector<Market> markets;
+    std::vector<unsigned int> others;
+
+    for (unsigned int asset = topology.numberOfHubs; asset < topology.numberOfAssets; ++asset) {
+        others.clear();
+        for (unsigned int hub = 0; hub < topology.hubMarketsPerAsset; ++hub)
+            others.push_back((asset + hub) % topology.numberOfHubs);
+        for (unsigned int cross = 0; cross < topology.crossMarketsPerAsset; ++cross)
+            others.push_back((unsigned int) (random() % topology.numberOfAssets));
+
+        for (unsigned int other : others) {
+            if (other == asset)
+                continue;
+
+            const double p = topology.consistentPrices ? values[asset] / values[other] : price(random);
+            markets.push_back(Market { asset, other, p });
+        }
+    }
+
+    return markets;
+}
+
+/*! toTickerLines - "from,to,price" lines of the markets, the input of CurrencyPairParser and GraphManager::updateGraph
+ */
+inline std::string toTickerLines(const std::vector<Market>& markets)
+{
+    std::string lines;
+    char price[32];
+
+    // std::to_string keeps 6 decimals, small prices would round to 0
+    for (auto& market : markets) {
+        std::snprintf(price, sizeof(price), "%.17g", market.price);
+        lines += symbolOf(market.base) + "," + symbolOf(market.quote) + "," + price + "\n";
+    }
+
+    return lines;
+}
+
+#endif //KRYPTOS_EXCHANGEGENERATOR_H
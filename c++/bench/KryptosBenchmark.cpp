@@ -0,0 +1,381 @@
+// KryptosBenchmark.cpp
+// Throughput of the graph, parser and manager operations on synthetic hub-and-spoke exchanges of several sizes,
+// written as one record per measurement so that results can be compared release over release
+//
+// usage: kryptos_benchmark [--json] [--perf] [--hubs N] [--hub-markets N] [--cross-markets N] [--repetitions N]
+//                          [numberOfAssets...]    (default: 250 1000 4000)
+//
+// Every record names the operation, the graph it ran on and the size of the exchange, then gives the number of
+// operations of one repetition and the minimum and median time over the repetitions. Records are "name key=value"
+// lines, or JSON objects one per line with --json. The first record describes the machine and the build
+//
+// With --perf, every record is followed by "perf" records with the hardware counters of its phases, see
+// PerfCounters.h: phase "repetition" is the whole timed body, the others the kernels and ingestion phases it ran.
+// Counts are means per call of the phase, counters the machine does not offer are "-" (null in JSON)
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "DirectedMatrixGraph.h"
+#include "DirectedSparseGraph.h"
+#include "AllPairsShortestPaths.h"
+#include "CurrencyPairParser.h"
+#include "GraphManager.h"
+#include "PerfCounters.h"
+#include "ThreadPool.h"
+#include "ExchangeGenerator.h"
+
+static const unsigned int kNumberOfQueries = 50;
+
+// Floyd-Warshall is O(V^3), larger exchanges skip it
+static const unsigned int kMaxAllPairsAssets = 2000;
+
+// the parser reads the ticker lines of the exchange repeated up to this size, so small exchanges still give a
+// stable throughput
+static const size_t kMinParsedBytes = 4 << 20;
+
+struct Options {
+    bool json;
+    bool perf;
+    unsigned int repetitions;
+    ExchangeTopology topology;
+    std::vector<unsigned int> sizes;
+};
+
+// one measurement: seconds holds the time of every repetition
+struct Record {
+    std::string operation;
+    std::string graph;
+    unsigned int assets;
+    size_t markets;
+    size_t operations; // per repetition
+    size_t bytes;      // per repetition, 0 if the operation does not read any input
+    std::vector<double> seconds;
+};
+
+// the counters of the phases measured for record, then forgets them for the next one
+static void printPerfRecords(const Record& record, const Options& options)
+{
+    for (const PerfCounters::Phase& phase : PerfCounters::summarize()) {
+        std::ostringstream out;
+        out.precision(6);
+
+        const double calls = (double) phase.calls;
+        if (options.json) {
+            out << "{\"operation\":\"perf\",\"of\":\"" << record.operation << "\",\"graph\":\"" << record.graph << "\""
+                << ",\"assets\":" << record.assets << ",\"phase\":\"" << phase.name << "\""
+                << ",\"calls\":" << phase.calls << ",\"ms_per_call\":" << phase.nanoseconds / calls / 1e6;
+            for (unsigned int counter = 0; counter < PerfCounters::kNumberOfCounters; ++counter) {
+                out << ",\"" << PerfCounters::kCounterNames[counter] << "\":";
+                if (phase.available[counter])
+                    out << phase.counts[counter] / calls;
+                else
+                    out << "null";
+            }
+            out << "}";
+        } else {
+            out << "perf of=" << record.operation << " graph=" << record.graph << " assets=" << record.assets
+                << " phase=" << phase.name << " calls=" << phase.calls
+                << " ms_per_call=" << phase.nanoseconds / calls / 1e6;
+            for (unsigned int counter = 0; counter < PerfCounters::kNumberOfCounters; ++counter) {
+                out << " " << PerfCounters::kCounterNames[counter] << "=";
+                if (phase.available[counter])
+                    out << phase.counts[counter] / calls;
+                else
+                    out << "-";
+            }
+        }
+
+        std::cout << out.str() << std::endl;
+    }
+
+    PerfCounters::reset();
+}
+
+static void printRecord(const Record& record, const Options& options)
+{
+    std::vector<double> sorted(record.seconds);
+    std::sort(sorted.begin(), sorted.end());
+
+    const double minimum = sorted.front();
+    const double median = sorted[sorted.size() / 2];
+
+    std::ostringstream out;
+    out.precision(6);
+
+    if (options.json) {
+        out << "{\"operation\":\"" << record.operation << "\",\"graph\":\"" << record.graph << "\""
+            << ",\"assets\":" << record.assets << ",\"markets\":" << record.markets
+            << ",\"operations\":" << record.operations << ",\"repetitions\":" << sorted.size()
+            << ",\"min_ms\":" << minimum * 1e3 << ",\"median_ms\":" << median * 1e3
+            << ",\"operations_per_second\":" << record.operations / median;
+        if (record.bytes > 0)
+            out << ",\"megabytes_per_second\":" << record.bytes / median / 1e6;
+        out << "}";
+    } else {
+        out << record.operation << " graph=" << record.graph
+            << " assets=" << record.assets << " markets=" << record.markets
+            << " operations=" << record.operations << " repetitions=" << sorted.size()
+            << " min_ms=" << minimum * 1e3 << " median_ms=" << median * 1e3
+            << " operations_per_second=" << record.operations / median;
+        if (record.bytes > 0)
+            out << " megabytes_per_second=" << record.bytes / median / 1e6;
+    }
+
+    std::cout << out.str() << std::endl;
+
+    if (options.perf)
+        printPerfRecords(record, options);
+}
+
+static void printEnvironment(const Options& options)
+{
+    const std::string compiler = __VERSION__;
+
+    std::string counters;
+    for (unsigned int counter = 0; counter < PerfCounters::kNumberOfCounters; ++counter) {
+        if (PerfCounters::isAvailable((PerfCounters::Counter) counter))
+            counters += std::string(counters.empty() ? "" : ",") + PerfCounters::kCounterNames[counter];
+    }
+
+    if (options.json) {
+        std::cout << "{\"operation\":\"environment\",\"kernel\":\"" << AllPairsShortestPaths::getKernelName() << "\""
+                  << ",\"hardware_threads\":" << ThreadPool::getHardwareConcurrency()
+                  << ",\"compiler\":\"" << compiler << "\""
+                  << ",\"hubs\":" << options.topology.numberOfHubs
+                  << ",\"hub_markets_per_asset\":" << options.topology.hubMarketsPerAsset
+                  << ",\"cross_markets_per_asset\":" << options.topology.crossMarketsPerAsset
+                  << ",\"perf_counters\":\"" << counters << "\"}" << std::endl;
+    } else {
+        std::cout << "environment kernel=" << AllPairsShortestPaths::getKernelName()
+                  << " hardware_threads=" << ThreadPool::getHardwareConcurrency()
+                  << " compiler=\"" << compiler << "\""
+                  << " hubs=" << options.topology.numberOfHubs
+                  << " hub_markets_per_asset=" << options.topology.hubMarketsPerAsset
+                  << " cross_markets_per_asset=" << options.topology.crossMarketsPerAsset
+                  << " perf_counters=" << (counters.empty() ? "-" : counters) << std::endl;
+    }
+}
+
+// time body once per repetition, setup runs before every repetition and is not timed
+static std::vector<double> measureSeconds(unsigned int repetitions, const std::function<void()>& setup,
+                                          const std::function<void()>& body)
+{
+    // the counters of the work done before, building the inputs, are not the measurement's
+    PerfCounters::reset();
+
+    std::vector<double> seconds;
+    for (unsigned int repetition = 0; repetition < repetitions; ++repetition) {
+        setup();
+
+        const auto start = std::chrono::steady_clock::now();
+        {
+            PerfCounters::Scope perfScope("repetition");
+            body();
+        }
+        seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    return seconds;
+}
+
+template <class GraphType>
+static void buildGraph(GraphType& graph, unsigned int numberOfAssets, const std::vector<Market>& markets)
+{
+    for (unsigned int asset = 0; asset < numberOfAssets; ++asset)
+        graph.addVertex(symbolOf(asset));
+
+    for (auto& market : markets) {
+        graph.addEdgeById(market.base, market.quote, market.price);
+        graph.addEdgeById(market.quote, market.base, 1.0 / market.price);
+    }
+}
+
+// addVertex, addEdge, getShortestPairsBetween and computeShortestDistanceBetweenAllVertices on one graph type
+template <class GraphType>
+static void benchmarkGraph(const std::string& graphName, const std::vector<Market>& markets, const Options& options,
+                           std::mt19937& random)
+{
+    const unsigned int numberOfAssets = options.topology.numberOfAssets;
+    std::unique_ptr<GraphType> graph;
+
+    const std::function<void()> newGraph = [&]() { graph.reset(new GraphType()); };
+    const std::function<void()> newGraphWithAssets = [&]() {
+        graph.reset(new GraphType());
+        for (unsigned int asset = 0; asset < numberOfAssets; ++asset)
+            graph->addVertex(symbolOf(asset));
+    };
+
+    std::vector<std::string> symbols;
+    for (unsigned int asset = 0; asset < numberOfAssets; ++asset)
+        symbols.push_back(symbolOf(asset));
+
+    printRecord(Record { "addVertex", graphName, numberOfAssets, markets.size(), numberOfAssets, 0,
+                         measureSeconds(options.repetitions, newGraph, [&]() {
+                             for (auto& symbol : symbols)
+                                 graph->addVertex(symbol);
+                         }) }, options);
+
+    printRecord(Record { "addEdge", graphName, numberOfAssets, markets.size(), 2 * markets.size(), 0,
+                         measureSeconds(options.repetitions, newGraphWithAssets, [&]() {
+                             for (auto& market : markets) {
+                                 graph->addEdge(symbols[market.base], symbols[market.quote], market.price);
+                                 graph->addEdge(symbols[market.quote], symbols[market.base], 1.0 / market.price);
+                             }
+                         }) }, options);
+
+    GraphType built;
+    buildGraph(built, numberOfAssets, markets);
+
+    std::vector< std::pair<unsigned int, unsigned int> > queries;
+    for (unsigned int query = 0; query < kNumberOfQueries; ++query)
+        queries.emplace_back((unsigned int) (random() % numberOfAssets), (unsigned int) (random() % numberOfAssets));
+
+    unsigned long totalPairs = 0;
+    printRecord(Record { "getShortestPairsBetween", graphName, numberOfAssets, markets.size(), kNumberOfQueries, 0,
+                         measureSeconds(options.repetitions, []() {}, [&]() {
+                             for (auto& query : queries)
+                                 totalPairs += built.getShortestPairsBetween(symbols[query.first], symbols[query.second]).size();
+                         }) }, options);
+
+    if (numberOfAssets <= kMaxAllPairsAssets) {
+        printRecord(Record { "computeShortestDistanceBetweenAllVertices", graphName, numberOfAssets, markets.size(), 1, 0,
+                             measureSeconds(options.repetitions, []() {}, [&]() {
+                                 built.computeShortestDistanceBetweenAllVertices();
+                             }) }, options);
+    }
+}
+
+// parseBuffer on the ticker lines, repeated up to kMinParsedBytes
+static void benchmarkParser(const std::string& tickerLines, const std::vector<Market>& markets, const Options& options)
+{
+    std::string text;
+    size_t numberOfLines = 0;
+    while (text.size() < kMinParsedBytes) {
+        text += tickerLines;
+        numberOfLines += markets.size();
+    }
+
+    const CurrencyPairParser parser;
+    std::vector<ParsedRate> rates;
+    std::vector<ParseError> errors;
+
+    printRecord(Record { "CurrencyPairParser::parseBuffer", "-", options.topology.numberOfAssets, markets.size(),
+                         numberOfLines, text.size(),
+                         measureSeconds(options.repetitions, [&]() {
+                             rates.clear();
+                             errors.clear();
+                         }, [&]() {
+                             parser.parseBuffer(text.data(), text.size(), rates, errors);
+                         }) }, options);
+}
+
+// one tick of every market through updateGraphFromBuffer and updateGraph, after a first update added the currencies
+static void benchmarkManager(const std::string& tickerLines, const std::vector<Market>& markets, const Options& options)
+{
+    GraphManager manager("benchmark", new DirectedSparseGraph<std::string>(), new CurrencyPairParser());
+    manager.updateGraphFromBuffer(tickerLines.data(), tickerLines.size());
+
+    printRecord(Record { "GraphManager::updateGraphFromBuffer", "DirectedSparseGraph", options.topology.numberOfAssets,
+                         markets.size(), markets.size(), tickerLines.size(),
+                         measureSeconds(options.repetitions, []() {}, [&]() {
+                             manager.updateGraphFromBuffer(tickerLines.data(), tickerLines.size());
+                         }) }, options);
+
+    char fileName[] = "/tmp/kryptos_benchmark_XXXXXX";
+    const int descriptor = mkstemp(fileName);
+    if (descriptor < 0) {
+        std::cerr << "GraphManager::updateGraph skipped, no temporary file: " << std::strerror(errno) << "\n";
+        return;
+    }
+    close(descriptor);
+
+    std::ofstream(fileName, std::ios::binary) << tickerLines;
+
+    std::string error;
+
+    printRecord(Record { "GraphManager::updateGraph", "DirectedSparseGraph", options.topology.numberOfAssets,
+                         markets.size(), markets.size(), tickerLines.size(),
+                         measureSeconds(options.repetitions, []() {}, [&]() {
+                             manager.updateGraph(fileName, error);
+                         }) }, options);
+
+    unlink(fileName);
+}
+
+static bool parseOptions(int argc, char* argv[], Options& options)
+{
+    options.json = false;
+    options.perf = false;
+    options.repetitions = 5;
+    options.topology = ExchangeTopology { 0, 4, 2, 1, true };
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (argument == "--json")
+            options.json = true;
+        else if (argument == "--perf")
+            options.perf = true;
+        else if (argument == "--hubs" && hasValue)
+            options.topology.numberOfHubs = (unsigned int) std::atoi(argv[++i]);
+        else if (argument == "--hub-markets" && hasValue)
+            options.topology.hubMarketsPerAsset = (unsigned int) std::atoi(argv[++i]);
+        else if (argument == "--cross-markets" && hasValue)
+            options.topology.crossMarketsPerAsset = (unsigned int) std::atoi(argv[++i]);
+        else if (argument == "--repetitions" && hasValue)
+            options.repetitions = (unsigned int) std::atoi(argv[++i]);
+        else if (!argument.empty() && argument[0] != '-')
+            options.sizes.push_back((unsigned int) std::atoi(argv[i]));
+        else
+            return false;
+    }
+
+    if (options.sizes.empty())
+        options.sizes = { 250, 1000, 4000 };
+
+    return options.repetitions > 0 && options.topology.numberOfHubs > 0;
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " [--json] [--perf] [--hubs N] [--hub-markets N] [--cross-markets N]"
+                  << " [--repetitions N] [numberOfAssets...]\n";
+        return 1;
+    }
+
+    PerfCounters::setEnabled(options.perf);
+    printEnvironment(options);
+
+    for (unsigned int numberOfAssets : options.sizes) {
+        options.topology.numberOfAssets = std::max(numberOfAssets, options.topology.numberOfHubs + 1);
+
+        // prices are consistent, so the log weights of the manager have no negative cycles
+        std::mt19937 random(options.topology.numberOfAssets);
+        const std::vector<Market> markets = generateExchange(options.topology, random);
+        const std::string tickerLines = toTickerLines(markets);
+
+        benchmarkGraph< DirectedMatrixGraph<std::string> >("DirectedMatrixGraph", markets, options, random);
+        benchmarkGraph< DirectedSparseGraph<std::string> >("DirectedSparseGraph", markets, options, random);
+        benchmarkParser(tickerLines, markets, options);
+        benchmarkManager(tickerLines, markets, options);
+    }
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+// ShortestPathBenchmark.cpp
+// Measures the cold-start construction time and the latency of single route queries (getShortestPairsBetween)
+// on the matrix graph. The edges hold log prices, as GraphManager stores them, so the weights are negative in one
+// direction of every market and the queries run the SPFA search of Graph::computeShortestPathTree. Every size is run
+// with consistent prices (no arbitrage) and with independent prices, whose graph is full of negative cycles
+//
+// usage: shortestpath_benchmark [numberOfVertices...]    (default: 500 2000 10000)
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "DirectedMatrixGraph.h"
+#include "CurrencyPair.h"
+#include "ExchangeGenerator.h"
+
+static const unsigned int kNumberOfHubs = 4;
+static const unsigned int kNumberOfQueries = 50;
+
+static void buildExchange(DirectedMatrixGraph<std::string>& graph, unsigned int numberOfVertices, bool consistentPrices,
+                          std::mt19937& random)
+{
+    for (unsigned int i = 0; i < numberOfVertices; ++i)
+        graph.addVertex(symbolOf(i));
+
+    for (auto& market : generateExchange(ExchangeTopology { numberOfVertices, kNumberOfHubs, 2, 1, consistentPrices }, random)) {
+        graph.addEdge(symbolOf(market.base), symbolOf(market.quote), std::log(market.price));
+        graph.addEdge(symbolOf(market.quote), symbolOf(market.base), -std::log(market.price));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<unsigned int> sizes;
+    for (int i = 1; i < argc; ++i)
+        sizes.push_back((unsigned int) std::atoi(argv[i]));
+
+    if (sizes.empty())
+        sizes = { 500, 2000, 10000 };
+
+    for (unsigned int numberOfVertices : sizes) {
+        for (bool consistentPrices : { true, false }) {
+            const char* prices = consistentPrices ? "consistent" : "independent";
+            std::mt19937 random(numberOfVertices);
+
+            DirectedMatrixGraph<std::string> graph;
+            const auto buildStart = std::chrono::steady_clock::now();
+            buildExchange(graph, numberOfVertices, consistentPrices, random);
+            const auto buildElapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart);
+
+            std::cout << "buildExchange vertices=" << numberOfVertices << " prices=" << prices
+                      << " ms=" << buildElapsed.count() << "\n";
+
+            std::vector< std::pair<std::string, std::string> > queries;
+            for (unsigned int q = 0; q < kNumberOfQueries; ++q)
+                queries.emplace_back(symbolOf(random() % numberOfVertices), symbolOf(random() % numberOfVertices));
+
+            unsigned long totalPairs = 0;
+            const auto start = std::chrono::steady_clock::now();
+
+            for (auto& query : queries)
+                totalPairs += graph.getShortestPairsBetween(query.first, query.second).size();
+
+            const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+
+            std::cout << "getShortestPairsBetween vertices=" << numberOfVertices << " prices=" << prices
+                      << " queries=" << kNumberOfQueries
+                      << " mean_us=" << elapsed.count() / kNumberOfQueries
+                      << " pairs=" << totalPairs << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,341 @@
+// TickReplay.cpp
+// Replays a tick log recorded by GraphManager::startRecording through the update and query paths of a new manager,
+// to measure end-to-end behavior on recorded traffic without a feed
+//
+// usage: tick_replay [--json] [--speed X] [--queries N] [--seed N] [--generate ASSETS BATCHES] tickLog
+//
+// Every batch of the log is applied with applyRateBatch, as one published update like when it was recorded, then
+// --queries best routes between random currencies (10 by default) are looked up on the new snapshot. --speed 1 waits
+// for the recorded time of every batch, 10 replays ten times faster, 0 (the default) as fast as possible.
+// --generate first writes a synthetic log of BATCHES price moves on a generated exchange to tickLog, replacing it.
+//
+// The result is one record, a "name key=value" line or a JSON object with --json: updates per second over the whole
+// replay and inside applyRateBatch only, percentiles of the update and query latencies, and how far behind the
+// recorded pace the replay fell
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CurrencyPairParser.h"
+#include "DirectedSparseGraph.h"
+#include "GraphManager.h"
+#include "TickLog.h"
+#include "ExchangeGenerator.h"
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options {
+    bool json;
+    double speed;
+    unsigned int queries;
+    unsigned int seed;
+    unsigned int generatedAssets;  // 0 to replay an existing log
+    unsigned int generatedBatches;
+    std::string fileName;
+};
+
+struct ReplayResult {
+    size_t sessions;
+    size_t symbols;
+    size_t batches;
+    size_t rates;
+    size_t skippedRates;   // with a currency id that no symbol record defined
+    double wallSeconds;
+    double updateSeconds;  // inside applyRateBatch
+    double maxLagSeconds;  // behind the recorded pace, with --speed
+    std::vector<double> updateSecondsPerBatch;
+    std::vector<double> querySeconds;
+};
+
+static double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// value below which a fraction q of the sorted values are
+static double percentile(const std::vector<double>& sorted, double q)
+{
+    if (sorted.empty())
+        return 0;
+    return sorted[std::min(sorted.size() - 1, (size_t) (q * sorted.size()))];
+}
+
+/*! generateLog - record BATCHES moves of the prices of a generated exchange
+ *
+ * The prices stay ratios of asset values: a move changes the value of a few assets and every market they trade in, so
+ * the log has no arbitrage and its shortest paths are well defined. One batch is published per millisecond
+ */
+static bool generateLog(const Options& options)
+{
+    std::remove(options.fileName.c_str());
+
+    std::mt19937 random(options.seed);
+    const ExchangeTopology topology { std::max(options.generatedAssets, 5u), 4, 2, 1, true };
+    const std::vector<Market> markets = generateExchange(topology, random);
+
+    GraphManager manager("generated", new DirectedSparseGraph<std::string>(), new CurrencyPairParser());
+
+    std::string error;
+    if (!manager.startRecording(options.fileName, error)) {
+        std::cerr << error << "\n";
+        return false;
+    }
+
+    const std::string tickerLines = toTickerLines(markets);
+    manager.updateGraphFromBuffer(tickerLines.data(), tickerLines.size());
+
+    std::vector< std::vector<size_t> > marketsOfAsset(topology.numberOfAssets);
+    for (size_t market = 0; market < markets.size(); ++market) {
+        marketsOfAsset[markets[market].base].push_back(market);
+        marketsOfAsset[markets[market].quote].push_back(market);
+    }
+
+    std::vector<uint32_t> currencyOf(topology.numberOfAssets);
+    for (unsigned int asset = 0; asset < topology.numberOfAssets; ++asset)
+        currencyOf[asset] = manager.getCurrencyId(symbolOf(asset));
+
+    std::vector<double> valueFactors(topology.numberOfAssets, 1.0);
+    std::normal_distribution<double> move(0, 1e-3);
+    std::vector<RateRecord> batch;
+
+    for (unsigned int b = 0; b < options.generatedBatches; ++b) {
+        batch.clear();
+
+        const unsigned int movedAssets = 1 + random() % 4;
+        for (unsigned int i = 0; i < movedAssets; ++i) {
+            const unsigned int asset = random() % topology.numberOfAssets;
+            valueFactors[asset] *= std::exp(move(random));
+
+            for (size_t market : marketsOfAsset[asset]) {
+                const Market& m = markets[market];
+                batch.push_back({ currencyOf[m.base], currencyOf[m.quote], m.price * valueFactors[m.base] / valueFactors[m.quote] });
+            }
+        }
+
+        manager.applyRateBatch(batch.data(), batch.size());
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (!manager.stopRecording(error)) {
+        std::cerr << error << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+/*! replay - feed the log through a new manager
+ */
+static bool replay(const Options& options, ReplayResult& result)
+{
+    TickLogReader reader;
+    if (!reader.open(options.fileName)) {
+        std::cerr << reader.getError() << "\n";
+        return false;
+    }
+
+    GraphManager manager("replay", new DirectedSparseGraph<std::string>(), new CurrencyPairParser());
+    std::mt19937 random(options.seed);
+
+    // symbol ids of the log are those of the recording manager, and start over with every session
+    std::vector<uint32_t> currencyOfLogId;
+    std::vector<RateRecord> batch;
+
+    bool paced = false;
+    int64_t firstTimestamp = 0;
+
+    result = ReplayResult();
+    const Clock::time_point start = Clock::now();
+
+    auto applyBatch = [&]() {
+        const Clock::time_point updateStart = Clock::now();
+        manager.applyRateBatch(batch.data(), batch.size());
+        const double updateSeconds = secondsSince(updateStart);
+
+        result.updateSeconds += updateSeconds;
+        result.updateSecondsPerBatch.push_back(updateSeconds);
+        result.rates += batch.size();
+        ++result.batches;
+        batch.clear();
+
+        const uint32_t numberOfCurrencies = manager.getSnapshot()->getSymbols().size();
+        for (unsigned int query = 0; query < options.queries && numberOfCurrencies > 1; ++query) {
+            const uint32_t from = random() % numberOfCurrencies;
+            const uint32_t to = random() % numberOfCurrencies;
+
+            const Clock::time_point queryStart = Clock::now();
+            manager.findBestExchangePath(from, to);
+            result.querySeconds.push_back(secondsSince(queryStart));
+        }
+    };
+
+    TickLog::Record record;
+    while (reader.next(record)) {
+        switch (record.kind) {
+            case TickLog::kSession:
+                currencyOfLogId.clear();
+                ++result.sessions;
+                break;
+
+            case TickLog::kSymbol:
+                if (record.from >= currencyOfLogId.size())
+                    currencyOfLogId.resize(record.from + 1, SymbolTable::kInvalidId);
+                currencyOfLogId[record.from] = manager.internCurrency(std::string(record.symbol, record.symbolLength));
+                ++result.symbols;
+                break;
+
+            case TickLog::kRate:
+                if (record.from < currencyOfLogId.size() && record.to < currencyOfLogId.size() &&
+                    currencyOfLogId[record.from] != SymbolTable::kInvalidId && currencyOfLogId[record.to] != SymbolTable::kInvalidId)
+                    batch.push_back({ currencyOfLogId[record.from], currencyOfLogId[record.to], record.price });
+                else
+                    ++result.skippedRates;
+                break;
+
+            case TickLog::kPublish:
+                if (options.speed > 0) {
+                    if (!paced) {
+                        paced = true;
+                        firstTimestamp = record.timestamp;
+                    }
+
+                    const Clock::time_point due = start + std::chrono::duration_cast<Clock::duration>(
+                            std::chrono::duration<double>((record.timestamp - firstTimestamp) * 1e-9 / options.speed));
+                    const Clock::time_point now = Clock::now();
+                    if (due > now)
+                        std::this_thread::sleep_until(due);
+                    else
+                        result.maxLagSeconds = std::max(result.maxLagSeconds, std::chrono::duration<double>(now - due).count());
+                }
+
+                applyBatch();
+                break;
+        }
+    }
+
+    // rates of a writer that stopped before publishing them
+    if (!batch.empty())
+        applyBatch();
+
+    result.wallSeconds = secondsSince(start);
+
+    if (!reader.getError().empty())
+        std::cerr << reader.getError() << ", replayed up to there\n";
+    else if (reader.isTruncated())
+        std::cerr << "the last record of " << options.fileName << " is incomplete, replayed up to there\n";
+
+    return true;
+}
+
+static void printResult(const ReplayResult& result, const Options& options)
+{
+    std::vector<double> updates(result.updateSecondsPerBatch);
+    std::vector<double> queries(result.querySeconds);
+    std::sort(updates.begin(), updates.end());
+    std::sort(queries.begin(), queries.end());
+
+    const double updatesPerSecond = result.wallSeconds > 0 ? result.rates / result.wallSeconds : 0;
+    const double applyUpdatesPerSecond = result.updateSeconds > 0 ? result.rates / result.updateSeconds : 0;
+
+    std::ostringstream out;
+    out.precision(6);
+
+    if (options.json) {
+        out << "{\"operation\":\"replay\",\"speed\":" << options.speed
+            << ",\"sessions\":" << result.sessions << ",\"symbols\":" << result.symbols
+            << ",\"batches\":" << result.batches << ",\"rates\":" << result.rates
+            << ",\"skipped_rates\":" << result.skippedRates << ",\"wall_s\":" << result.wallSeconds
+            << ",\"updates_per_second\":" << updatesPerSecond
+            << ",\"apply_updates_per_second\":" << applyUpdatesPerSecond
+            << ",\"update_p50_ms\":" << percentile(updates, 0.5) * 1e3
+            << ",\"update_p99_ms\":" << percentile(updates, 0.99) * 1e3
+            << ",\"update_max_ms\":" << (updates.empty() ? 0 : updates.back() * 1e3)
+            << ",\"queries\":" << queries.size()
+            << ",\"query_p50_us\":" << percentile(queries, 0.5) * 1e6
+            << ",\"query_p90_us\":" << percentile(queries, 0.9) * 1e6
+            << ",\"query_p99_us\":" << percentile(queries, 0.99) * 1e6
+            << ",\"query_max_us\":" << (queries.empty() ? 0 : queries.back() * 1e6)
+            << ",\"max_lag_ms\":" << result.maxLagSeconds * 1e3 << "}";
+    } else {
+        out << "replay speed=" << options.speed
+            << " sessions=" << result.sessions << " symbols=" << result.symbols
+            << " batches=" << result.batches << " rates=" << result.rates
+            << " skipped_rates=" << result.skippedRates << " wall_s=" << result.wallSeconds
+            << " updates_per_second=" << updatesPerSecond
+            << " apply_updates_per_second=" << applyUpdatesPerSecond
+            << " update_p50_ms=" << percentile(updates, 0.5) * 1e3
+            << " update_p99_ms=" << percentile(updates, 0.99) * 1e3
+            << " update_max_ms=" << (updates.empty() ? 0 : updates.back() * 1e3)
+            << " queries=" << queries.size()
+            << " query_p50_us=" << percentile(queries, 0.5) * 1e6
+            << " query_p90_us=" << percentile(queries, 0.9) * 1e6
+            << " query_p99_us=" << percentile(queries, 0.99) * 1e6
+            << " query_max_us=" << (queries.empty() ? 0 : queries.back() * 1e6)
+            << " max_lag_ms=" << result.maxLagSeconds * 1e3;
+    }
+
+    std::cout << out.str() << std::endl;
+}
+
+static bool parseOptions(int argc, char* argv[], Options& options)
+{
+    options.json = false;
+    options.speed = 0;
+    options.queries = 10;
+    options.seed = 1;
+    options.generatedAssets = 0;
+    options.generatedBatches = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (argument == "--json")
+            options.json = true;
+        else if (argument == "--speed" && hasValue)
+            options.speed = std::atof(argv[++i]);
+        else if (argument == "--queries" && hasValue)
+            options.queries = (unsigned int) std::atoi(argv[++i]);
+        else if (argument == "--seed" && hasValue)
+            options.seed = (unsigned int) std::atoi(argv[++i]);
+        else if (argument == "--generate" && i + 2 < argc) {
+            options.generatedAssets = (unsigned int) std::atoi(argv[++i]);
+            options.generatedBatches = (unsigned int) std::atoi(argv[++i]);
+        }
+        else if (!argument.empty() && argument[0] != '-' && options.fileName.empty())
+            options.fileName = argument;
+        else
+            return false;
+    }
+
+    return !options.fileName.empty() && options.speed >= 0;
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " [--json] [--speed X] [--queries N] [--seed N]"
+                  << " [--generate ASSETS BATCHES] tickLog\n";
+        return 1;
+    }
+
+    if (options.generatedAssets > 0 && !generateLog(options))
+        return 1;
+
+    ReplayResult result;
+    if (!replay(options, result))
+        return 1;
+
+    printResult(result, options);
+    return 0;
+}
@@ -0,0 +1,226 @@
+// AllPairsShortestPaths.h
+// AllPairsShortestPaths Class Specification
+
+#ifndef KRYPTOS_ALLPAIRSSHORTESTPATHS_H
+#define KRYPTOS_ALLPAIRSSHORTESTPATHS_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <utility>
+
+#include "Graph.h"
+#include "PerfCounters.h"
+#include "ThreadPool.h"
+
+// All-pairs shortest path engine.
+//
+// Distances live in one contiguous, 64 byte aligned, row-major matrix whose rows are padded to a multiple of
+// kBlockSize. compute() runs a blocked (tiled) Floyd-Warshall so that the three tiles being combined stay in cache,
+// and the innermost min-plus loop runs on the widest SIMD instruction set the CPU supports (chosen at runtime).
+//
+// Constructed with routes, it also keeps a next hop matrix of the same layout: nextHop(i, j) is the vertex after i on
+// the shortest route from i to j. After one compute(), any route is read back in O(route length) by getRoute.
+class AllPairsShortestPaths {
+public:
+    // side of the square tiles, in elements. 3 tiles of 32 x 32 doubles fit in a 32KB L1 cache
+    static const unsigned int kBlockSize = 32;
+
+    // next hop of the pairs without a route
+    static const uint32_t kNoRoute;
+
+    // new weight of an edge of the graph, INF for a missing edge
+    struct EdgeChange {
+        unsigned int from;
+        unsigned int to;
+        double oldWeight;
+        double newWeight;
+    };
+
+private:
+    unsigned int numberOfVertices;
+    unsigned int stride; // length of a row in the matrix, multiple of kBlockSize
+    bool withRoutes;
+    double* distances;   // stride x stride, missing edges are +infinity
+    uint32_t* nextHops;  // stride x stride, nullptr without routes
+
+    // set when the matrices are borrowed: they are read-only then, and owned by someone else
+    std::shared_ptr<const void> borrowedMemory;
+
+    // drop borrowed matrices without freeing them, the next allocate() allocates its own
+    void forgetBorrowedMemory();
+
+    void allocate(unsigned int numberOfVertices);
+
+    // merge the changes of the same edge into one, from the first old weight to the last new weight
+    static std::vector<EdgeChange> coalesce(const std::vector<EdgeChange>& changes);
+
+    // for every source, the targets that had a shortest route through one of the edges that got more expensive.
+    // Found with the old distances, so it has to run before any distance changes. Returns the number of pairs
+    unsigned long markPairsUsingEdges(const std::vector<EdgeChange>& increases,
+                                      std::vector< std::vector<unsigned int> >& affectedTargets, ThreadPool* pool) const;
+
+    // edges of the graph in compressed rows, read once so the searches do not go through the virtual getters
+    struct Adjacency {
+        std::vector<unsigned int> offsets;
+        std::vector<unsigned int> targets;
+        std::vector<double> weights;
+    };
+
+    // search the marked pairs of every source again, starting from the distances that stay valid. The edges that got
+    // cheaper are searched with their old weights, so the result is exact for the increases alone and the decreases
+    // can be applied to it one by one
+    void repairPairs(const std::vector< std::vector<unsigned int> >& affectedTargets,
+                     const std::vector<EdgeChange>& decreases, Adjacency& outgoingEdges, ThreadPool* pool);
+
+    // propagate an edge that got cheaper (or was added) to every pair, O(V^2)
+    void decreaseEdge(unsigned int from, unsigned int to, double weight, ThreadPool* pool);
+
+public:
+    // Constructor: numberOfVertices vertices without edges. withRoutes keeps the next hop matrix
+    explicit AllPairsShortestPaths(unsigned int numberOfVertices = 0, bool withRoutes = false);
+
+    AllPairsShortestPaths(const AllPairsShortestPaths&);
+    AllPairsShortestPaths& operator=(const AllPairsShortestPaths&);
+
+    ~AllPairsShortestPaths();
+
+    /*! borrow - distances that were computed before, read in place instead of copied (from a mapped file)
+     *
+     * The matrices have the layout of getDistanceMatrix and getNextHopMatrix and must be 64 byte aligned. They are
+     * only read: copies of the result own their matrices and can be updated
+     *
+     * @param nextHops - nullptr for distances without routes
+     * @param owner - keeps the matrices alive for as long as the result is
+     */
+    static std::shared_ptr<const AllPairsShortestPaths> borrow(unsigned int numberOfVertices, const double* distances,
+                                                              const uint32_t* nextHops, std::shared_ptr<const void> owner);
+
+    /*! reset - resize to numberOfVertices vertices without edges (distance 0 to itself, INF otherwise)
+     */
+    void reset(unsigned int numberOfVertices);
+
+    /*! setWeight - set the weight of the edge between two vertices. INF removes the edge
+     */
+    void setWeight(unsigned int from, unsigned int to, double weight);
+
+    /*! load - reset to the vertices and edges of the graph
+     */
+    template <class T>
+    void load(const Graph<T>& graph)
+    {
+        reset(graph.getNumberOfVertexIds());
+
+        std::vector< std::pair<unsigned int, double> > edges;
+        for (unsigned int from = 0; from < numberOfVertices; ++from) {
+            graph.getOutgoingEdges(from, edges);
+            for (auto& edge : edges)
+                setWeight(from, edge.first, edge.second);
+        }
+    }
+
+    /*! applyEdgeChanges - update the distances (and next hops) after edges of the graph changed
+     *
+     * This must hold the result of compute() for the old weights, and the graph the new weights, with the same vertices.
+     * For edges that got more expensive (or were removed), only the pairs whose route went through them are searched
+     * again. Edges that got cheaper (or were added) are then propagated to all pairs in O(V^2) each.
+     * When more than a quarter of the pairs would be searched again, everything is computed again instead
+     *
+     * @param pool - threads to spread the rows over, nullptr to run on the calling thread only
+     * @return - number of pairs searched again
+     */
+    template <class T>
+    unsigned long applyEdgeChanges(const Graph<T>& graph, const std::vector<EdgeChange>& changes, ThreadPool* pool = nullptr)
+    {
+        PerfCounters::Scope perfScope("applyEdgeChanges");
+        const std::vector<EdgeChange> merged = coalesce(changes);
+
+        std::vector<EdgeChange> increases;
+        std::vector<EdgeChange> decreases;
+        for (auto& change : merged) {
+            if (change.newWeight > change.oldWeight)
+                increases.push_back(change);
+            else if (change.newWeight < change.oldWeight)
+                decreases.push_back(change);
+        }
+
+        std::vector< std::vector<unsigned int> > affectedTargets;
+        const unsigned long affectedPairs = markPairsUsingEdges(increases, affectedTargets, pool);
+
+        if (affectedPairs > (unsigned long) numberOfVertices * numberOfVertices / 4) {
+            load(graph);
+            compute(pool);
+            return (unsigned long) numberOfVertices * numberOfVertices;
+        }
+
+        if (affectedPairs > 0) {
+            Adjacency outgoingEdges;
+            std::vector< std::pair<unsigned int, double> > edges;
+
+            outgoingEdges.offsets.push_back(0);
+            for (unsigned int from = 0; from < numberOfVertices; ++from) {
+                graph.getOutgoingEdges(from, edges);
+                for (auto& edge : edges) {
+                    outgoingEdges.targets.push_back(edge.first);
+                    outgoingEdges.weights.push_back(edge.second);
+                }
+                outgoingEdges.offsets.push_back((unsigned int) outgoingEdges.targets.size());
+            }
+
+            repairPairs(affectedTargets, decreases, outgoingEdges, pool);
+        }
+
+        // the distances are exact for the graph without the decreases now, which then only shorten routes
+        for (auto& change : decreases)
+            decreaseEdge(change.from, change.to, change.newWeight, pool);
+
+        return affectedPairs;
+    }
+
+    /*! compute - replace the edge weights by the shortest distances between all vertices
+     *
+     * Blocked Floyd-Warshall, O(V^3). Negative weights are allowed, negative cycles show up as
+     * negative distances from a vertex to itself
+     *
+     * @param pool - threads to spread the tiles over, nullptr to run on the calling thread only
+     */
+    void compute(ThreadPool* pool = nullptr);
+
+    // Getters
+    unsigned int getNumberOfVertices() const;
+
+    /*! getDistance - distance between two vertices, INF if 'to' is not reachable from 'from'
+     */
+    double getDistance(unsigned int from, unsigned int to) const;
+
+    bool hasRoutes() const;
+
+    // length of the rows of the matrices below, numberOfVertices rounded up to a multiple of kBlockSize
+    unsigned int getStride() const;
+
+    // getStride() x getStride() distances, row-major, +infinity between vertices without a route and in the padding
+    const double* getDistanceMatrix() const;
+
+    // same layout as the distances, kNoRoute between vertices without a route and in the padding. nullptr without routes
+    const uint32_t* getNextHopMatrix() const;
+
+    /*! getNextHop - vertex after 'from' on the shortest route to 'to', kNoRoute if there is none. Requires routes
+     */
+    uint32_t getNextHop(unsigned int from, unsigned int to) const;
+
+    /*! getRoute - vertices on the shortest route, starting with 'from' and ending with 'to'. Requires routes
+     *
+     * @return - false, with an empty route, if 'to' is not reachable or the route runs into a negative cycle
+     */
+    bool getRoute(unsigned int from, unsigned int to, std::vector<unsigned int>& route) const;
+
+    /*! toMatrix - copy the distances to a 2D vector, the format of Graph::computeShortestDistanceBetweenAllVertices
+     */
+    std::vector< std::vector<double> > toMatrix() const;
+
+    /*! getKernelName - name of the min-plus kernel selected for this CPU: "avx2", "sse2" or "scalar"
+     */
+    static const char* getKernelName();
+};
+
+#endif //KRYPTOS_ALLPAIRSSHORTESTPATHS_H
@@ -0,0 +1,206 @@
+// ArbitrageDetector.h
+// ArbitrageDetector Class Specification
+
+#ifndef KRYPTOS_ARBITRAGEDETECTOR_H
+#define KRYPTOS_ARBITRAGEDETECTOR_H
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "Graph.h"
+#include "AllPairsShortestPaths.h"
+
+// Finds negative cycles, i.e. arbitrage, in a graph whose edges change over time, looking only around the edges that
+// changed.
+//
+// The detector keeps a potential for every vertex, the distances of a Bellman-Ford search from a virtual source with
+// an edge of weight 0 to every vertex. Potentials satisfy p[to] <= p[from] + weight for every edge. An edge that got
+// more expensive cannot break that, so after an update the search only continues from the tails of the edges that got
+// cheaper. If that brings in a negative cycle, the search runs around it and the cycle shows up in the parent
+// pointers. Short cycles are caught on the edge that closes them by looking a few parents up, longer ones when the
+// search relaxed as many edges as it has touched vertices and all parent pointers are checked. The edges of a cycle
+// found are then left out for the rest of the update, and of the next ones as long as the cycle stays negative, so the
+// search does not run around it again and goes on until the queue is empty: every cycle that does not share an edge
+// with one found before is reported in the same update. Apart from sizing, an update costs time in the number of
+// vertices it reaches, not in the size of the graph.
+class ArbitrageDetector {
+public:
+    // vertices[0] -> vertices[1] -> ... -> vertices[0], starting with the smallest id
+    struct Cycle {
+        std::vector<unsigned int> vertices;
+        double weight;
+    };
+
+private:
+    // cycles of up to this many edges are found as soon as they close, arbitrage rarely takes more
+    static const unsigned int kShortCycleLength = 6;
+
+    std::vector<double> potentials;
+
+    // vertex that last lowered the potential of each vertex during the current update, -1 if none
+    std::vector<int> parents;
+
+    // vertices that got a parent in the current update. A vertex on a cycle found loses its parent but stays touched
+    std::vector<unsigned int> touched;
+    std::vector<bool> isTouched;
+
+    // edges of the cycles found, left out of the search until the end of the update: neutralizedTargets[v] are the
+    // targets of the ones leaving v, for the vertices in neutralizedSources
+    std::vector< std::vector<unsigned int> > neutralizedTargets;
+    std::vector<unsigned int> neutralizedSources;
+
+    // scratch space of findParentCycles, -1 outside of it
+    mutable std::vector<int> walkOf;
+
+    // vertices whose outgoing edges may not satisfy the potentials
+    std::deque<unsigned int> queue;
+    std::vector<bool> inQueue;
+
+    // negative cycles of the graph as of the last update
+    std::vector<Cycle> cycles;
+
+    void enqueue(unsigned int vertex);
+
+    // new vertices start with potential 0 and are queued, their edges are all new
+    void resize(unsigned int numberOfVertices);
+
+    // the cycle of parent pointers through vertex, as a vertex list starting with the smallest id
+    std::vector<unsigned int> traceCycle(unsigned int vertex) const;
+
+    // true if vertex is among the first kShortCycleLength parents of descendant
+    bool isCloseAncestor(unsigned int vertex, unsigned int descendant) const;
+
+    // append the cycles formed by the parent pointers of the touched vertices to 'found', as vertex lists starting with
+    // their smallest id
+    bool findParentCycles(std::vector< std::vector<unsigned int> >& found) const;
+
+    // leave the edges of the cycle out of the search and cut its parent pointers, its vertices stay queued
+    void neutralize(const std::vector<unsigned int>& cycle);
+
+    bool isNeutralized(unsigned int from, unsigned int to) const;
+
+    // forget the neutralized edges and the parents of the current update
+    void resetSearch();
+
+    void touch(unsigned int vertex, unsigned int parent);
+
+    // add the cycle to newCycles if it is negative and not in there yet
+    template <class T>
+    void keepIfNegative(const Graph<T>& graph, const std::vector<unsigned int>& vertices, std::vector<Cycle>& newCycles) const
+    {
+        double weight = 0;
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            const double edgeWeight = graph.getWeightById(vertices[i], vertices[(i + 1) % vertices.size()]);
+            if (edgeWeight == INF)
+                return;
+            weight += edgeWeight;
+        }
+
+        if (!(weight < -kRelaxationEpsilon))
+            return;
+
+        for (auto& cycle : newCycles) {
+            if (cycle.vertices == vertices)
+                return;
+        }
+
+        newCycles.push_back({vertices, weight});
+    }
+
+public:
+    // Constructor: no vertices yet
+    ArbitrageDetector() = default;
+
+    /*! update - bring the negative cycles up to date after edges of the graph changed
+     *
+     * @param graph - the graph with the new weights
+     * @param changes - every edge changed since the last update, with its old weight (INF for new edges)
+     * @param allEdgesChanged - true if the changes are not known, the search then starts from every vertex
+     * @return - the negative cycles found, most negative first
+     */
+    template <class T>
+    const std::vector<Cycle>& update(const Graph<T>& graph, const std::vector<AllPairsShortestPaths::EdgeChange>& changes,
+                                     bool allEdgesChanged)
+    {
+        const unsigned int numberOfVertices = graph.getNumberOfVertexIds();
+        resize(numberOfVertices);
+
+        if (allEdgesChanged) {
+            for (unsigned int vertex = 0; vertex < numberOfVertices; ++vertex)
+                enqueue(vertex);
+        } else {
+            for (auto& change : changes) {
+                if (change.newWeight < change.oldWeight)
+                    enqueue(change.from);
+            }
+        }
+
+        // cycles found before stay as long as they are negative, their edges are left out so the search below does not run
+        // around them again. The edges of a cycle that is no longer negative may not satisfy the potentials, its
+        // vertices are queued
+        std::vector<Cycle> newCycles;
+        for (auto& cycle : cycles) {
+            const size_t numberOfKept = newCycles.size();
+            keepIfNegative(graph, cycle.vertices, newCycles);
+            if (newCycles.size() == numberOfKept) {
+                for (unsigned int vertex : cycle.vertices)
+                    enqueue(vertex);
+            }
+        }
+
+        for (auto& cycle : newCycles)
+            neutralize(cycle.vertices);
+
+        std::vector< std::pair<unsigned int, double> > edges;
+        std::vector< std::vector<unsigned int> > parentCycles;
+        size_t relaxationsSinceCheck = 0;
+
+        while (!queue.empty()) {
+            const unsigned int from = queue.front();
+            queue.pop_front();
+            inQueue[from] = false;
+
+            graph.getOutgoingEdges(from, edges);
+            for (auto& edge : edges) {
+                const double viaFrom = potentials[from] + edge.second;
+                if (!(viaFrom < potentials[edge.first] - kRelaxationEpsilon))
+                    continue;
+
+                if (!neutralizedTargets[from].empty() && isNeutralized(from, edge.first))
+                    continue;
+
+                potentials[edge.first] = viaFrom;
+                touch(edge.first, from);
+                enqueue(edge.first);
+
+                if (isCloseAncestor(edge.first, from))
+                    parentCycles.push_back(traceCycle(edge.first));
+                // looking for long cycles costs O(touched), often enough to stop soon after one closed
+                else if (++relaxationsSinceCheck >= touched.size())
+                    relaxationsSinceCheck = 0, findParentCycles(parentCycles);
+
+                for (auto& vertices : parentCycles) {
+                    keepIfNegative(graph, vertices, newCycles);
+                    neutralize(vertices);
+                }
+                parentCycles.clear();
+            }
+        }
+
+        resetSearch();
+
+        sortByWeight(newCycles);
+        cycles.swap(newCycles);
+
+        return cycles;
+    }
+
+    const std::vector<Cycle>& getCycles() const;
+
+    /*! sortByWeight - most negative cycle first, ties by vertices
+     */
+    static void sortByWeight(std::vector<Cycle>& cycles);
+};
+
+#endif //KRYPTOS_ARBITRAGEDETECTOR_H
@@ -0,0 +1,50 @@
+// ChunkedFileReader.h
+// ChunkedFileReader Class Specification
+
+#ifndef KRYPTOS_CHUNKEDFILEREADER_H
+#define KRYPTOS_CHUNKEDFILEREADER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Reads a text file in chunks of whole lines through one fixed buffer, so memory stays the same whatever the size
+// of the file. The part of a line cut off at the end of a chunk is carried over to the front of the next one
+class ChunkedFileReader {
+private:
+    int fd;
+    std::vector<char> buffer;
+
+    // bytes in the buffer, and the first one that was not handed out yet
+    size_t filled;
+    size_t consumed;
+    bool endOfFile;
+    std::string error;
+
+public:
+    // default chunk size, lines longer than the chunk grow the buffer
+    static const size_t kDefaultChunkSize;
+
+    // Constructor: opens the file, check isOpen() for the result
+    explicit ChunkedFileReader(const std::string& fileName, size_t chunkSize = kDefaultChunkSize);
+
+    ChunkedFileReader(const ChunkedFileReader&) = delete;
+    ChunkedFileReader& operator=(const ChunkedFileReader&) = delete;
+
+    ~ChunkedFileReader();
+
+    /*! nextLines - read the next chunk of whole lines
+     *
+     * @param data, length - set to the lines, valid until the next call. The last chunk of a file that does not end
+     *                       with a newline ends with the unterminated line
+     * @return - false at the end of the file or on a read error, see getError()
+     */
+    bool nextLines(const char*& data, size_t& length);
+
+    // Getters
+    bool isOpen() const;
+
+    const std::string& getError() const;
+};
+
+#endif //KRYPTOS_CHUNKEDFILEREADER_H
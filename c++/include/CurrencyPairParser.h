@@ -2,22 +2,50 @@
 // CurrencyPairParser Class Specification
 // Author: Antonio G. Bares Jr.
 
+#include <cstring>
 #include <string>
 #include <fstream>
 #include <iostream>
 #include <list>
 #include <sstream>
+#include <vector>
 
 #include "CurrencyPair.h"
+#include "MappedFile.h"
+#include "ChunkedFileReader.h"
 
 #ifndef CURRENCYPAIRPARSER_H
 #define CURRENCYPAIRPARSER_H
 
+// characters of a field inside the parsed buffer, valid as long as the buffer is
+struct TextSlice {
+    const char* data;
+    size_t length;
+
+    std::string toString() const { return std::string(data, length); }
+};
+
+// one "from,to,price" line, the symbols point into the parsed buffer
+struct ParsedRate {
+    TextSlice from;
+    TextSlice to;
+    double price;
+};
+
+// line that could not be parsed, lines are numbered from 1
+struct ParseError {
+    size_t lineNumber;
+    std::string message;
+};
+
 class CurrencyPairParser {
 private:
     // Utilities
     CurrencyPair parseLine(const std::string&);
 
+    // split one line without its newline, false with the reason if it is malformed
+    static bool parseLine(const char* line, const char* lineEnd, ParsedRate& rate, std::string& error);
+
 public:
     // Default Constructor (nothing to initialize)
     CurrencyPairParser() = default;
@@ -27,6 +55,107 @@ public:
 
     std::list<CurrencyPair> parseFileAndGetListOfCurrencies(const std::string&);
 
+
+    // Zero-copy mode
+    //
+    // Buffers are scanned in place: lines and fields are found with memchr, symbols are slices of the
+    // buffer and prices are converted without copying them. Malformed lines are reported and skipped, not thrown
+
+    /*! parseMappedFile - map the file and parse every line of it
+     *
+     * @param file - keeps the mapping the symbols point into, it has to outlive the parsed rates
+     * @param rates - parsed lines are appended here
+     * @param errors - malformed lines are appended here, and a line 0 error if the file could not be mapped
+     * @return - false if the file could not be mapped
+     */
+    bool parseMappedFile(const std::string& fileName, MappedFile& file, std::vector<ParsedRate>& rates,
+                         std::vector<ParseError>& errors) const;
+
+    /*! parseBuffer - parse "from,to,price" lines from memory, "\n" or "\r\n" terminated. Empty lines are skipped
+     *
+     * @return - number of rates appended
+     */
+    size_t parseBuffer(const char* data, size_t length, std::vector<ParsedRate>& rates,
+                       std::vector<ParseError>& errors) const;
+
+    /*! forEachRate - parse "from,to,price" lines from memory and hand every line to the sinks as it is parsed
+     *
+     * Nothing is collected, so memory does not grow with the number of lines
+     *
+     * @param onRate - called with every parsed line, the symbols are valid as long as the buffer is
+     * @param onError - called with every malformed line
+     * @param lineNumber - number of the line before the buffer, to continue the numbering over chunks
+     * @return - number of the last line of the buffer
+     */
+    template <class RateSink, class ErrorSink>
+    size_t forEachRate(const char* data, size_t length, RateSink&& onRate, ErrorSink&& onError,
+                       size_t lineNumber = 0) const
+    {
+        const char* const end = data + length;
+        ParsedRate rate;
+        std::string error;
+
+        for (const char* line = data; line < end; ) {
+            ++lineNumber;
+
+            // memchr is vectorized by the C library, it skips whole lines at a time
+            const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', (size_t) (end - line)));
+            if (lineEnd == nullptr)
+                lineEnd = end;
+
+            const char* next = (lineEnd == end) ? end : lineEnd + 1;
+            if (lineEnd > line && lineEnd[-1] == '\r')
+                --lineEnd;
+
+            if (lineEnd != line) {
+                if (parseLine(line, lineEnd, rate, error))
+                    onRate(static_cast<const ParsedRate&>(rate));
+                else
+                    onError(ParseError{lineNumber, error});
+            }
+
+            line = next;
+        }
+
+        return lineNumber;
+    }
+
+    /*! forEachRateInFile - stream the file through a fixed size buffer into the sinks, see forEachRate
+     *
+     * The first lines reach the sinks before the rest of the file is read, and memory stays the same whatever
+     * the size of the file. The symbols passed to onRate are only valid during the call
+     *
+     * @return - false if the file could not be opened or read, the reason is passed to onError as line 0
+     */
+    template <class RateSink, class ErrorSink>
+    bool forEachRateInFile(const std::string& fileName, RateSink&& onRate, ErrorSink&& onError) const
+    {
+        ChunkedFileReader reader(fileName);
+        const char* data;
+        size_t length;
+        size_t lineNumber = 0;
+
+        while (reader.nextLines(data, length))
+            lineNumber = forEachRate(data, length, onRate, onError, lineNumber);
+
+        if (!reader.getError().empty()) {
+            onError(ParseError{0, reader.getError()});
+            return false;
+        }
+
+        return true;
+    }
+
+    /*! parseNumber - convert the whole of [begin, end) to a double, as strtod would
+     *
+     * Decimal numbers with up to 19 digits and small exponents are converted exactly without strtod,
+     * anything longer falls back to it. Blanks around the number are skipped. Hexadecimal, inf, nan, numbers too large
+     * for a double and trailing characters are rejected
+     *
+     * @return - false if the text is not a number
+     */
+    static bool parseNumber(const char* begin, const char* end, double& value);
+
 };
 
-#endif
\ No newline at end of file
+#endif
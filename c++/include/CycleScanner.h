@@ -0,0 +1,106 @@
+// CycleScanner.h
+// CycleScanner Class Specification
+
+#ifndef KRYPTOS_CYCLESCANNER_H
+#define KRYPTOS_CYCLESCANNER_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Graph.h"
+#include "AllPairsShortestPaths.h"
+#include "ThreadPool.h"
+
+// Exhaustive scan of the short cycles of exchanges (2, 3 or 4 pairs), ranked by their profit after fees.
+//
+// The rates of the graph, exp(-weight), are copied once into a dense row-major matrix and its transpose, with 0 for
+// the missing pairs so that a product through a missing pair is 0 and needs no check. Every cycle is found from its
+// anchor, the vertex of the cycle with the fewest pairs, and the last vertex but one runs along a row of both matrices
+// in the innermost loop: rate(a, b) * rate(b, c) * rate(c, a) for all c at once, one SIMD product per lane. Anchoring
+// at the least connected vertex keeps the hubs (BTC, ETH, USDT...) out of the outer loops. Anchors are spread over the
+// threads of the pool, each keeping its own top N, and the kernel only reports the lanes that beat the current N-th.
+//
+// The matrices take O(V^2) memory, the scanner is meant for venues of a few thousand currencies. They are held one row
+// per allocation so that a copy of the scanner shares them: a tick only copies the rows of the pairs it changed
+class CycleScanner {
+public:
+    // vertices[0] -> vertices[1] -> ... -> vertices[0], starting with the smallest id
+    struct Opportunity {
+        std::vector<unsigned int> vertices;
+        double profit; // relative gain of going around once, after the fees of every exchange
+    };
+
+private:
+    unsigned int numberOfVertices;
+    unsigned int stride; // length of a row of the matrices, multiple of the widest SIMD vector
+
+    // Only depends on which pairs exist, so copies of the scanner share it until pairs are added or removed
+    struct Ranking {
+        // vertices are renumbered by their number of pairs, fewest first, so that the anchor of a cycle is its
+        // smallest rank
+        std::vector<unsigned int> vertexOfRank;
+        std::vector<unsigned int> rankOfVertex;
+
+        // ranks above i that i trades to, and that trade to i: the candidates for the second and last vertex of a cycle
+        std::vector< std::vector<unsigned int> > higherSuccessors;
+        std::vector< std::vector<unsigned int> > higherPredecessors;
+    };
+
+    std::shared_ptr<const Ranking> ranking;
+
+    // rates(i, j) = exp(-weight(i, j)) between ranks, 0 without a pair, row i at rateRows[i]. transposedRates(i, j) =
+    // rates(j, i). A row may be shared with other copies of the scanner and is copied before it is written
+    std::vector< std::shared_ptr< std::vector<double> > > rateRows;
+    std::vector< std::shared_ptr< std::vector<double> > > transposedRateRows;
+
+    struct Scan;
+
+    void build(const std::vector< std::vector< std::pair<unsigned int, double> > >& edges);
+
+    // every cycle anchored at the given rank
+    void scanAnchor(unsigned int anchor, Scan& scan) const;
+
+public:
+    // Constructor: snapshot of the rates of the graph
+    template <class T>
+    explicit CycleScanner(const Graph<T>& graph) : numberOfVertices(graph.getNumberOfVertexIds()), stride(0)
+    {
+        std::vector< std::vector< std::pair<unsigned int, double> > > edges(numberOfVertices);
+        for (unsigned int from = 0; from < numberOfVertices; ++from)
+            graph.getOutgoingEdges(from, edges[from]);
+
+        build(edges);
+    }
+
+    unsigned int getNumberOfVertices() const;
+
+    /*! applyEdgeChanges - update the rates after the weights of existing pairs changed
+     *
+     * Meant for a copy of the scanner of the previous version: the rows of the pairs that changed are copied and
+     * written, every other row stays shared. Pairs that were added or removed change the ranks, which takes a new
+     * scanner
+     *
+     * @param changes - edges changed since the rates were taken, in the order they were made
+     * @return - false if a change adds or removes a pair, the scanner is then left unchanged
+     */
+    bool applyEdgeChanges(const std::vector<AllPairsShortestPaths::EdgeChange>& changes);
+
+    /*! scan - the most profitable cycles of up to maxLength exchanges
+     *
+     * @param maxLength - longest cycle looked at, 2 to 4
+     * @param topN - maximum number of cycles returned
+     * @param feeRate - fraction of the amount paid on every exchange, e.g. 0.001 for 0.1%
+     * @param minProfit - only cycles whose profit after fees is above this by more than kRelaxationEpsilon are returned
+     * @param pool - threads to spread the anchors over, nullptr to run on the calling thread only
+     * @return - up to topN cycles, most profitable first
+     */
+    std::vector<Opportunity> scan(unsigned int maxLength, unsigned int topN, double feeRate, double minProfit = 0,
+                                  ThreadPool* pool = nullptr) const;
+
+    /*! getKernelName - name of the product kernel selected for this CPU: "avx2" or "scalar"
+     */
+    static const char* getKernelName();
+};
+
+#endif //KRYPTOS_CYCLESCANNER_H
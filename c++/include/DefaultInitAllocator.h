@@ -0,0 +1,39 @@
+// DefaultInitAllocator.h
+// Allocator that leaves new elements of trivial types uninitialized
+
+#ifndef KRYPTOS_DEFAULTINITALLOCATOR_H
+#define KRYPTOS_DEFAULTINITALLOCATOR_H
+
+#include <memory>
+#include <new>
+#include <utility>
+
+// std::vector<T, DefaultInitAllocator<T> >(n) and resize(n) default-initialize the new elements instead of
+// value-initializing them, so large buffers of doubles are not zeroed and their pages are only touched when written
+template <class T, class Base = std::allocator<T> >
+class DefaultInitAllocator : public Base {
+public:
+    template <class U>
+    struct rebind {
+        typedef DefaultInitAllocator<U, typename std::allocator_traits<Base>::template rebind_alloc<U> > other;
+    };
+
+    DefaultInitAllocator() = default;
+
+    template <class U, class OtherBase>
+    DefaultInitAllocator(const DefaultInitAllocator<U, OtherBase>& other) : Base(other) {}
+
+    template <class U>
+    void construct(U* pointer)
+    {
+        ::new (static_cast<void*>(pointer)) U;
+    }
+
+    template <class U, class... Arguments>
+    void construct(U* pointer, Arguments&&... arguments)
+    {
+        std::allocator_traits<Base>::construct(static_cast<Base&>(*this), pointer, std::forward<Arguments>(arguments)...);
+    }
+};
+
+#endif //KRYPTOS_DEFAULTINITALLOCATOR_H
@@ -14,7 +14,7 @@ class DirectedMatrixGraph: public UndirectedMatrixGraph<T>
 {
 private:
     using UndirectedMatrixGraph<T>::verticesMap;
-    using UndirectedMatrixGraph<T>::adjMatrix;// vector of vectors to create a 2d matrix
+    using UndirectedMatrixGraph<T>::adjMatrix;// row-major buffer of the 2d matrix
     using UndirectedMatrixGraph<T>::vertexList; // vector list of our vertices
 
     using Graph<T>::totalNumberOfVertices;
@@ -54,6 +54,12 @@ public:
     //4. remove edge between the vertices. Since this is Directed, only one edge is removed
     virtual void removeEdge(const T& fromValue, const T& toValue);
 
+    //Same as addEdge, with the vertices given by their ids. Only one edge is added
+    virtual void addEdgeById(unsigned int fromId, unsigned int toId, double cost);
+
+    // copy of the graph, see Graph.h
+    virtual Graph<T>* clone() const;
+
     //This function checks to see if a vertex exists or not
     // @param: Vertex * V
 
@@ -69,7 +75,7 @@ public:
     //1. safe check if the passed vertices are valid, and gets the indices of the vertex
     //2. returns the weight or index of the adjgraph at the two vertex indices
     //3. otherwise return -1 if function fails
-    virtual double getWeight(const T& fromValue, const T& toValue);
+    virtual double getWeight(const T& fromValue, const T& toValue) const;
 
     //This function returns the neighbors of a specified vertex
     // @param: const T& targetCoin
@@ -0,0 +1,162 @@
+// DirectedSparseGraph.h
+// DirectedSparseGraph Class Specification
+
+#ifndef CMPE130PROJECT_DIRECTEDSPARSEGRAPH_H
+#define CMPE130PROJECT_DIRECTEDSPARSEGRAPH_H
+
+#include "Graph.h"
+#include <vector>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+class CurrencyPair;
+
+//src/DirectedSparseGraph.cpp
+//Directed graph stored as compressed sparse rows (CSR).
+//Memory and query cost grow with the number of edges (markets) instead of the square of the vertices (assets).
+template <class T>
+class DirectedSparseGraph : public Graph<T>
+{
+    using Graph<T>::totalNumberOfVertices;
+
+protected:
+    // values of the vertices by id, and the id of every value. Only adding or removing vertices changes them, so a
+    // clone shares them with the graph it was cloned from until one of the two does
+    struct Vertices {
+        std::vector<Vertex<T> > vertexList;
+        std::unordered_map<T, unsigned int> verticesMap;
+    };
+
+    std::shared_ptr<Vertices> vertices;
+
+    // removed vertices keep their slot so that indices of the other vertices stay valid
+    std::vector<bool> removedVertices;
+
+    // CSR adjacency: edges of vertex i are stored in [rowOffsets[i], rowOffsets[i + 1]) of
+    // columnIndices/edgeWeights, sorted by column. Removed edges are marked with INF until the next compaction
+    std::vector<unsigned int> rowOffsets;
+    std::vector<unsigned int> columnIndices;
+    std::vector<double> edgeWeights;
+
+    // edges inserted since the last compaction, kept per vertex until they are merged into the CSR arrays
+    std::vector< std::vector< std::pair<unsigned int, double> > > pendingEdges;
+    unsigned long numberOfPendingEdges;
+    unsigned long numberOfRemovedEdges;
+
+    // the vertices, copied first if a clone still shares them
+    Vertices& getWritableVertices();
+
+    // returns a pointer to the stored weight of the edge, nullptr if the edge does not exist
+    double* findEdge(unsigned int fromIndex, unsigned int toIndex);
+    const double* findEdge(unsigned int fromIndex, unsigned int toIndex) const;
+
+    // merge pending edges into the CSR arrays and drop removed edges
+    void compact();
+
+    // convert a path of ids to the list of currency pairs
+    std::list<CurrencyPair> constructPairs(const std::vector<unsigned int>& path) const;
+
+public:
+    // Default Constructor
+    DirectedSparseGraph();
+
+    //This function adds a vertex to our vertex list
+    // @param: const T& value
+
+    //1. checks if the vertex already exists, if yes, then return
+    //2. appends the vertex and an empty adjacency row
+    //3. increments the number of vertices
+    virtual void addVertex(const T& value);
+
+    //This function removes a vertex from our vertex list
+    // @param: const T& value
+
+    //1. Checks for whether the vertex exists
+    //2. marks the slot as removed and drops all edges to and from the vertex
+    //3. decrements the number of vertices
+    virtual void removeVertex(const T& value);
+
+    //This function adds an edge between two given vertices and sets an associated cost to the edge
+    // @param: const T& fromValue, const T& toValue, double cost
+
+    //1. look up in our vertex list if these vertices exist. Return index of both vertices
+    //2. if edge already exists between them, update its cost in place
+    //3. otherwise queue the edge, it is merged into the CSR arrays on the next compaction
+    virtual void addEdge(const T& fromValue, const T& toValue, double cost);
+
+    //This function removes an edge between two given vertices
+    // @param: const T& fromValue, const T& toValue
+
+    //1. look up in our vertex list if these vertices exist. Return index of both vertices
+    //2. check if edge exists between them, if not, then nothing to delete. We exit then
+    //3. remove edge between the vertices. Since this is Directed, only one edge is removed
+    virtual void removeEdge(const T& fromValue, const T& toValue);
+
+    //This function checks to see if a vertex exists or not
+    // @param: const T& value
+
+    //1. check if unordered_map contains specified value. if yes, return the associated value (index).
+    //2. otherwise return -1 to indicate "not found"
+    virtual int lookUpVertex(const T& value) const;
+
+    //This function returns the weight between two vertices
+    // @param: const T& fromValue, const T& toValue
+
+    //1. gets the indices of the vertices
+    //2. binary searches the row of fromValue for toValue
+    //3. returns INF if there is no edge, -1 if a vertex does not exist
+    virtual double getWeight(const T& fromValue, const T& toValue) const;
+
+    /*
+     * This function returns the neighbors of a specified vertex
+     * @param: const T& targetCoin
+     *
+     * 1. gets index of the targetCoin
+     * 2. walks the row of the targetCoin and pushes every vertex that it has an edge to
+     * 3. return the list of neighbors
+     */
+    virtual std::vector< Vertex<T> > getNeighbors(const T& targetCoin) const;
+
+    //This function gives us an idea of what vertices have an edge between them. -> for testing purposes
+    // @param: none
+    virtual std::string toString();
+
+    // function to remove all vertices in the graph
+    virtual void reset();
+
+    // copy of the graph that shares the vertices with this one, see Graph.h
+    virtual Graph<T>* clone() const;
+
+    /*! getNumberOfEdges - number of edges currently stored in the graph
+     */
+    unsigned long getNumberOfEdges() const;
+
+
+    /*! computeShortestDistanceBetweenAllVertices - Calculate shortest paths between all vertices using Floyd-Warshall Algorithm
+     *
+     * @return 2D vector with shortest paths between all vertices
+     */
+    virtual std::vector< std::vector<double> > computeShortestDistanceBetweenAllVertices() const;
+
+    virtual std::list<CurrencyPair> computeShortestDistanceBetweenVertices(const T& from, const T& to) const;
+
+    virtual std::list<CurrencyPair> getShortestPairsBetween(const T& from, const T& to) const;
+
+
+    // Id based interface, see Graph.h
+    virtual unsigned int getNumberOfVertexIds() const;
+
+    virtual T getVertexValue(unsigned int id) const;
+
+    virtual void addEdgeById(unsigned int fromId, unsigned int toId, double cost);
+
+    virtual double getWeightById(unsigned int fromId, unsigned int toId) const;
+
+    virtual void getOutgoingEdges(unsigned int fromId, std::vector< std::pair<unsigned int, double> >& edges) const;
+};
+
+#include "DirectedSparseGraph.cpp"
+
+#endif //CMPE130PROJECT_DIRECTEDSPARSEGRAPH_H
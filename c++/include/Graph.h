@@ -10,9 +10,22 @@
 #include <ostream>
 #include <list>
 #include <vector>
+#include <limits> // double max value
+#include <deque>
+#include <utility>
+
+#include "PerfCounters.h"
+#include "ShortestPathTree.h"
 
 class CurrencyPair;
 
+// INF represents no-edge
+static const double INF = std::numeric_limits<double>::max();
+
+// improvements smaller than this are treated as rounding noise by the shortest path searches,
+// so cycles that multiply out to 1 (A -> B -> A) do not make them relax forever
+static const double kRelaxationEpsilon = 1e-12;
+
 
 //Vertex class which defines a vertex which holds an ID and a Value (which is a template)
 template <class T>
@@ -110,6 +123,8 @@ public:
     {
     }
 
+    virtual ~Graph() = default;
+
     //getter to return the number of nodes in graph
     unsigned int getNumberOfVertices() const
     {
@@ -123,11 +138,15 @@ public:
     virtual void addEdge(const T& fromValue, const T& toValue, double cost) = 0;
     virtual void removeEdge(const T& fromValue, const T& toValue) = 0;
 
-    virtual double getWeight (const T& fromValue, const T& toValue) = 0;
+    virtual double getWeight (const T& fromValue, const T& toValue) const = 0;
 
     // function to remove all vertices in the graph
     virtual void reset() = 0;
 
+    /*! clone - return a new graph with the same vertices, ids and edges, owned by the caller
+     */
+    virtual Graph<T>* clone() const = 0;
+
     virtual bool isEmpty() const {
         return totalNumberOfVertices == 0;
     }
@@ -148,6 +167,140 @@ public:
 
     virtual std::list<CurrencyPair> getShortestPairsBetween(const T& from, const T& to) const = 0;
 
+
+
+    // Id based interface
+    //
+    // Every vertex has a dense integer id: its index in the order the vertices were added.
+    // Ids let hot loops skip hashing and copying the vertex values. They stay valid until a vertex is removed.
+
+    /*! getVertexId - return the id of given value, -1 if the value is not in the graph
+     */
+    int getVertexId(const T& value) const
+    {
+        return lookUpVertex(value);
+    }
+
+    /*! getNumberOfVertexIds - upper bound (exclusive) of the vertex ids currently in use
+     */
+    virtual unsigned int getNumberOfVertexIds() const = 0;
+
+    virtual T getVertexValue(unsigned int id) const = 0;
+
+    virtual void addEdgeById(unsigned int fromId, unsigned int toId, double cost) = 0;
+
+    virtual double getWeightById(unsigned int fromId, unsigned int toId) const = 0;
+
+    /*! getShortestPathBetweenIds - same route as getShortestPairsBetween, as a list of vertex ids
+     *
+     * The route is read from computeShortestPathTree, so the weights along it are added and may be negative or 0, like
+     * the log prices GraphManager stores. When the tree left the direct edge out to break a negative cycle and it is
+     * cheaper than the route, the direct edge is taken instead
+     *
+     * @return ids of the vertices on the route, starting with fromId and ending with toId.
+     *         Empty if there is no route
+     */
+    virtual std::vector<unsigned int> getShortestPathBetweenIds(unsigned int fromId, unsigned int toId) const
+    {
+        std::vector<unsigned int> path = computeShortestPathTree(fromId).getPath(toId);
+
+        double routeWeight = 0;
+        for (unsigned int i = 1; i < path.size(); ++i)
+            routeWeight += getWeightById(path[i - 1], path[i]);
+
+        const double directWeight = getWeightById(fromId, toId);
+        if (fromId != toId && directWeight != INF && (path.empty() || directWeight < routeWeight - kRelaxationEpsilon)) {
+            path.clear();
+            path.push_back(fromId);
+            path.push_back(toId);
+        }
+
+        return path;
+    }
+
+    /*! getOutgoingEdges - replace the content of 'edges' with the (target id, weight) of every edge leaving fromId
+     */
+    virtual void getOutgoingEdges(unsigned int fromId, std::vector< std::pair<unsigned int, double> >& edges) const = 0;
+
+
+    /*! computeShortestPathTree - shortest paths from one vertex to all the others
+     *
+     * Uses the queue based Bellman-Ford algorithm (SPFA), so negative weights are allowed.
+     *
+     * A relaxation that would make a vertex the parent of one of its own ancestors closes a cycle of parents, which
+     * only a negative cycle (arbitrage) can do. Such relaxations are skipped and the tree is marked: the parents then
+     * always lead back to the source, every reachable vertex keeps a simple route, and the search ends instead of
+     * going around the cycle until some vertex was queued V times
+     *
+     * @param sourceId - id of the source vertex
+     * @return tree with the distance to and the path to every vertex
+     */
+    ShortestPathTree computeShortestPathTree(unsigned int sourceId) const
+    {
+        PerfCounters::Scope perfScope("shortestPathTree");
+        const unsigned int V = getNumberOfVertexIds();
+        ShortestPathTree tree(sourceId, V);
+
+        // vertices whose distance improved and whose edges need to be relaxed again
+        std::deque<unsigned int> queue;
+        std::vector<bool> inQueue(V, false);
+
+        // a vertex queued V times means the search goes around something the parent check did not stop
+        std::vector<unsigned int> timesQueued(V, 0);
+
+        std::vector< std::pair<unsigned int, double> > edges;
+
+        queue.push_back(sourceId);
+        inQueue[sourceId] = true;
+
+        while (!queue.empty()) {
+            const unsigned int u = queue.front();
+            queue.pop_front();
+            inQueue[u] = false;
+
+            const double distance = tree.getDistance(u);
+            getOutgoingEdges(u, edges);
+
+            for (auto& edge : edges) {
+                const unsigned int v = edge.first;
+
+                if (!(distance + edge.second < tree.getDistance(v) - kRelaxationEpsilon))
+                    continue;
+
+                if (isAncestorInTree(tree, v, u)) {
+                    tree.setNegativeCycle(true);
+                    continue;
+                }
+
+                tree.setDistance(v, distance + edge.second, (int) u);
+
+                if (!inQueue[v]) {
+                    if (++timesQueued[v] >= V) {
+                        tree.setNegativeCycle(true);
+                        return tree;
+                    }
+
+                    queue.push_back(v);
+                    inQueue[v] = true;
+                }
+            }
+        }
+
+        return tree;
+    }
+
+private:
+    // true if ancestor is vertex or one of its parents in the tree. Parents never form a cycle, the walk ends
+    static bool isAncestorInTree(const ShortestPathTree& tree, unsigned int ancestor, unsigned int vertex)
+    {
+        for (int v = (int) vertex; v != -1; v = tree.getParent((unsigned int) v)) {
+            if (v == (int) ancestor)
+                return true;
+        }
+
+        return false;
+    }
+
 };
 
 
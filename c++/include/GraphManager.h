@@ -8,18 +8,150 @@
 #include <string>
 #include <list>
 #include <iostream>
+#include <memory>
+#include <mutex>
+
+#include <vector>
+#include <utility>
+#include <cstdint>
 
 #include "../include/Graph.h"
 #include "../include/CurrencyPair.h"
+#include "../include/SymbolTable.h"
+#include "../include/AllPairsShortestPaths.h"
+#include "../include/ThreadPool.h"
+#include "../include/GraphSnapshot.h"
+#include "../include/ArbitrageDetector.h"
+#include "../include/TickLog.h"
+#include "../include/LatencyHistogram.h"
 
 class CurrencyPairParser;
 
+// one price update by currency ids, as laid out in packed buffers: 4 bytes from, 4 bytes to, 8 bytes rate
+struct RateRecord {
+    uint32_t fromCurrency;
+    uint32_t toCurrency;
+    double rate;
+};
+
+static_assert(sizeof(RateRecord) == 16, "RateRecord is read from packed buffers");
+
+// what GraphManager::stats() reports
+struct GraphManagerStats {
+    struct Operation {
+        std::string name; // name of the GraphManager method
+        LatencyHistogram::Summary latency;
+    };
+
+    // every timed operation, called or not, in a fixed order
+    std::vector<Operation> operations;
+
+    // snapshots published since the manager was created, and the latest one
+    uint64_t numberOfRefreshes;
+    unsigned long version;
+    uint32_t numberOfVertices;
+    uint64_t numberOfEdges;
+    uint64_t numberOfChangedEdges; // by the update that published it, every edge after updates too large to track
+};
+
 class GraphManager {
 private:
     const std::string nameOfExchange;
-    std::unique_ptr<Graph<std::string>> graph;
     std::unique_ptr<CurrencyPairParser> parser;
 
+    // Readers and writers never share mutable state: writers change the working copy below and then publish an
+    // immutable copy of it as the next snapshot. Queries pin the current snapshot and run without locks
+
+    // one writer at a time, held while the working copy changes and while it is published
+    mutable std::mutex writerMutex;
+
+    // working copy, only used with writerMutex held
+    std::unique_ptr<Graph<std::string>> graph;
+
+    // currency ids, always the same as the vertex ids of the graph
+    SymbolTable symbols;
+
+    // copy of symbols shared by the snapshots, nullptr after a currency was added
+    std::shared_ptr<const SymbolTable> publishedSymbols;
+
+    // edges changed since the current snapshot, so the next one can patch its all-pairs distances
+    std::vector<AllPairsShortestPaths::EdgeChange> pendingEdgeChanges;
+
+    // true once more edges changed than are worth patching, the next snapshot computes its distances on demand
+    bool tooManyEdgeChanges;
+
+    // above this many changed edges per currency, the all-pairs distances are computed again instead of updated
+    static const double kMaxChangedEdgesPerVertex;
+
+    // negative cycles of the working copy, updated from the changed edges on every publish
+    ArbitrageDetector arbitrageDetector;
+
+    // latest published version, read and written with std::atomic_load/std::atomic_store only
+    std::shared_ptr<const GraphSnapshot> snapshot;
+
+    // threads used by the all-pairs computation, nullptr when running single threaded
+    std::shared_ptr<ThreadPool> threadPool;
+
+    // every applied rate and new symbol is appended to it while recording, only used with writerMutex held
+    TickLogWriter tickLog;
+
+    // operations timed by stats(), named as the methods in kOperationNames
+    enum Operation {
+        kUpdateGraph,
+        kUpdateGraphFromBuffer,
+        kUpdateRate,
+        kApplyRateBatch,
+        kPublish,
+        kFindBestExchangeRoute,
+        kFindBestExchangeRoutes,
+        kFindBestExchangePath,
+        kFindBestExchangePaths,
+        kFindAlternativeRoutes,
+        kFindAlternativePaths,
+        kFindShortArbitrageCycles,
+        kGetCostForExchange,
+        kNumberOfOperations
+    };
+
+    static const char* const kOperationNames[kNumberOfOperations];
+
+    // recorded by any thread without locks
+    mutable LatencyHistogram latencies[kNumberOfOperations];
+
+    // lookups that take well under a microsecond are timed once every this many calls, and counted every call
+    static const unsigned int kLookupSamplingPeriod = 16;
+
+    // edges of the working copy, counted as they are added
+    uint64_t numberOfEdges;
+
+    // sizes of the latest published snapshot, written by publish and read by stats() with statsMutex held
+    mutable std::mutex statsMutex;
+    uint64_t numberOfRefreshes;
+    unsigned long publishedVersion;
+    uint32_t publishedVertices;
+    uint64_t publishedEdges;
+    uint64_t publishedChangedEdges;
+
+    // Sink for the parser, feeds the working copy while a file or buffer is read
+    class RateIngestor;
+
+    // same as internCurrency, with writerMutex held
+    uint32_t addCurrency(const std::string& symbol);
+
+    // same as applyRateBatch, with writerMutex held and without publishing
+    size_t applyRates(const RateRecord* records, size_t numberOfRecords);
+
+    // write both edges of the pair and remember them for the all-pairs distances
+    bool setRate(uint32_t fromCurrency, uint32_t toCurrency, double price);
+
+    // true if setRate takes the price: positive and finite, log is only defined for positive prices and an infinite
+    // one would give the reverse edge a weight of -infinity
+    static bool isValidPrice(double price);
+
+    // make the working copy the current snapshot, with writerMutex held. knownAllPairs, if given, must hold the
+    // distances of the working copy
+    void publish(std::shared_ptr<const AllPairsShortestPaths> knownAllPairs = nullptr);
+
 public:
     // Constructor
     GraphManager(std::string nameOfExchange, Graph<std::string>* graph, CurrencyPairParser* pairParser);
@@ -27,12 +159,70 @@ public:
     // Getters
     std::string getNameOfExchange() const;
 
+    /*! getSnapshot - the current version of the graph
+     *
+     * The snapshot stays valid and unchanged for as long as it is held, whatever is updated in the meantime.
+     * Every query of GraphManager pins the current snapshot for its own duration; callers that need several
+     * queries to see the same version hold a snapshot and query it directly
+     */
+    std::shared_ptr<const GraphSnapshot> getSnapshot() const;
+
 
     /*! updateGraph - populate graph with data from given data
+     *
+     * The file is streamed into the graph while it is read, with memory that does not grow with its size.
+     * Malformed lines are skipped and reported as Trace warnings. Queries see the whole file at once, when it is done
      *
      * @param fileName - file with data in format "from,to,price"
+     * @return - number of lines applied. Rows with a price that is not positive and finite, or a currency with itself,
+     *           are not. 0 if the file could not be opened or read, or no row could be applied: error tells why
+     */
+    size_t updateGraph(const std::string& fileName, std::string& error);
+
+    /*! updateGraphFromBuffer - same as updateGraph, from lines that are already in memory
+     *
+     * The buffer is parsed in place and does not need to be terminated, so feeds can hand over their data without
+     * going through a file
+     *
+     * @param data, length - lines in format "from,to,price"
+     * @return - number of lines applied, malformed lines are skipped and reported as Trace warnings
+     */
+    size_t updateGraphFromBuffer(const char* data, size_t length);
+
+    /*! saveSnapshot - write the current graph and symbols to a binary file that loadSnapshot maps, see SnapshotFile
+     *
+     * @param withAllPairs - also write the all-pairs distances and next hops, computing them if no query did yet
+     * @param error - why the file could not be written
+     * @return - false if the file could not be written
+     */
+    bool saveSnapshot(const std::string& fileName, bool withAllPairs, std::string& error) const;
+
+    /*! loadSnapshot - start from a file written by saveSnapshot instead of parsing the rates again
+     *
+     * Only a manager without currencies can load a snapshot. Saved all-pairs distances are read from the mapped file
+     * in place, so the first all-pairs query after a restart costs nothing
+     *
+     * @param error - why the file could not be loaded, the manager is unchanged then
+     * @return - false if the file could not be loaded
+     */
+    bool loadSnapshot(const std::string& fileName, std::string& error);
+
+    /*! startRecording - append every rate applied from now on to a tick log, to replay it later (see bench/TickReplay)
+     *
+     * The log starts with the symbols and rates the graph already holds, so it replays into an empty manager. Rates
+     * are logged as they are applied, whichever way they came in (files, buffers or ids), and every published update
+     * ends a batch with its time
+     *
+     * @param error - why the log could not be opened
+     * @return - false if the log could not be opened
+     */
+    bool startRecording(const std::string& fileName, std::string& error);
+
+    /*! stopRecording - close the tick log
+     *
+     * @return - false if some records could not be written, error tells why
      */
-    void updateGraph(std::string fileName);
+    bool stopRecording(std::string& error);
 
 
 
@@ -55,6 +245,167 @@ public:
      */
     double getCostForExchange(std::string fromCurrency, std::string toCurrency) const;
 
+
+
+    /*! getArbitrageCycles - profitable cycles of exchanges in the current graph, most profitable first
+     *
+     * A cycle whose prices multiply to less than 1 is a negative cycle of the log weights. Cycles are looked for on
+     * every update, starting only from the pairs whose price went down; a cycle stays listed as long as it is
+     * profitable. Every cycle is returned once, starting with its currency of smallest id
+     */
+    std::vector<ArbitrageCycle> getArbitrageCycles() const;
+
+
+
+    /*! findBestExchangeRoutes - best routes between many pairs of currencies at once
+     *
+     * All routes are answered from the same snapshot. Routes from the same source share one shortest path tree, and
+     * the trees of different sources are computed in parallel on the threads set with setNumberOfThreads
+     *
+     * @param routes - (fromCurrency, toCurrency) pairs of symbols
+     * @return - the pairs of every route, in the order of routes. Empty for unknown currencies or when there is no route
+     */
+    std::vector< std::list<CurrencyPair> > findBestExchangeRoutes(const std::vector< std::pair<std::string, std::string> >& routes) const;
+
+
+
+    /*! findAlternativeRoutes - the k best routes from 'fromCurrency' to 'toCurrency', best first
+     *
+     * Routes are simple (no currency twice) and distinct, so when the best route cannot be used the next ones are
+     * ready without changing the graph. The graph is not modified to exclude edges, queries stay on their snapshot
+     *
+     * @param k - maximum number of routes
+     * @param maxHops - maximum number of pairs per route, 0 for no limit
+     * @return - the pairs of every route, empty if either currency is unknown or there is no route
+     */
+    std::vector< std::list<CurrencyPair> > findAlternativeRoutes(const std::string& fromCurrency, const std::string& toCurrency,
+                                                               unsigned int k, unsigned int maxHops = 0) const;
+
+
+
+    /*! findShortArbitrageCycles - the most profitable cycles of 2 to maxLength pairs, after paying feeRate on each
+     *
+     * Unlike getArbitrageCycles, every cycle of up to 4 pairs is scanned, so the list is complete and ranked by the
+     * profit left after fees. The scan runs over a dense matrix of the rates on the configured number of threads
+     *
+     * @param maxLength - longest cycle, 2 to 4 pairs
+     * @param topN - maximum number of cycles
+     * @param feeRate - fraction of the amount paid on every exchange, e.g. 0.001 for 0.1%
+     * @return - the cycles with a gain after fees above 0, most profitable first
+     */
+    std::vector<ArbitrageCycle> findShortArbitrageCycles(unsigned int maxLength, unsigned int topN, double feeRate) const;
+
+
+
+    // Id based interface
+    //
+    // Symbols are resolved to ids once (internCurrency/getCurrencyId), after that updates and queries
+    // do not hash or copy any strings.
+    //
+    // Every update publishes a new snapshot, which copies the graph: prefer applyRateBatch over many updateRate calls
+
+    /*! internCurrency - return the id of the currency, adding it to the graph if it is new
+     *
+     * New currencies are visible to queries from the next published update on
+     */
+    uint32_t internCurrency(const std::string& symbol);
+
+    /*! getCurrencyId - return the id of the currency, SymbolTable::kInvalidId if the currency is not in the graph
+     */
+    uint32_t getCurrencyId(const std::string& symbol) const;
+
+    /*! getCurrencySymbol - return the symbol of the currency, empty if the id is not a currency of the current snapshot
+     *
+     * Currencies interned since the last published update are not in the snapshot yet and also give an empty string
+     */
+    std::string getCurrencySymbol(uint32_t currencyId) const;
+
+    /*! updateRate - set the price of a currency pair, in both directions
+     *
+     * The graph stores log(price) as the weight of 'from' -> 'to', and -log(price) for the way back, i.e. -log of the
+     * conversion rate. Summing weights along a route then gives the log of its total price.
+     *
+     * @param fromCurrency, toCurrency - ids of the currencies, from internCurrency. Unknown ids and a currency with
+     *                                   itself are ignored
+     * @param price - price as in the data files: "from,to,price". Prices that are not positive and finite are ignored
+     */
+    void updateRate(uint32_t fromCurrency, uint32_t toCurrency, double price);
+
+    /*! applyRateBatch - set the prices of many currency pairs at once
+     *
+     * Same as calling updateRate for every record, without files or symbols, and published as one snapshot.
+     * Records with unknown currency ids or prices that are not positive and finite are skipped
+     *
+     * @param records - contiguous array of numberOfRecords records
+     * @return - number of records applied
+     */
+    size_t applyRateBatch(const RateRecord* records, size_t numberOfRecords);
+
+    /*! applyRateBatch - same, from a packed buffer of RateRecords in host byte order, which does not need to be aligned
+     *
+     * @param sizeInBytes - size of the buffer, a trailing partial record is ignored
+     */
+    size_t applyRateBatch(const void* buffer, size_t sizeInBytes);
+
+    /*! getShortestPathTree - best routes from given currency to every other currency
+     *
+     * The tree is computed once per source currency and reused by every query until the next update
+     */
+    std::shared_ptr<const ShortestPathTree> getShortestPathTree(uint32_t fromCurrency) const;
+
+    /*! findBestExchangePath - same route as findBestExchangeRoute, as the ids of the currencies to go through
+     *
+     * Routes are read from the all-pairs next hops once they were computed (see refreshAllPairs),
+     * from the shortest path tree of fromCurrency otherwise
+     *
+     * @return - ids of the currencies on the route, starting with fromCurrency. If no route found, return empty vector
+     */
+    std::vector<uint32_t> findBestExchangePath(uint32_t fromCurrency, uint32_t toCurrency) const;
+
+    /*! findBestExchangePaths - same routes as findBestExchangeRoutes, by currency ids
+     */
+    std::vector< std::vector<uint32_t> > findBestExchangePaths(const std::vector< std::pair<uint32_t, uint32_t> >& routes) const;
+
+    /*! findAlternativePaths - same routes as findAlternativeRoutes, by currency ids
+     */
+    std::vector< std::vector<uint32_t> > findAlternativePaths(uint32_t fromCurrency, uint32_t toCurrency, unsigned int k,
+                                                            unsigned int maxHops = 0) const;
+
+    double getCostForExchange(uint32_t fromCurrency, uint32_t toCurrency) const;
+
+
+
+    /*! setNumberOfThreads - number of threads used to compute the distances between all currencies
+     *
+     * @param numberOfThreads - 1 (the default) runs on the calling thread, 0 uses one thread per hardware thread
+     */
+    void setNumberOfThreads(unsigned int numberOfThreads);
+
+    unsigned int getNumberOfThreads() const;
+
+    /*! getAllPairsShortestPaths - distances and next hops between all currencies, indexed by currency id
+     *
+     * Computed with blocked Floyd-Warshall on the configured number of threads the first time. After that, the rates
+     * updated in between are applied incrementally when they are published: cost grows with the number of changed
+     * edges, not with V^3
+     */
+    std::shared_ptr<const AllPairsShortestPaths> getAllPairsShortestPaths() const;
+
+    /*! stats - call counts and latency percentiles of every operation, and the size of the latest snapshot
+     *
+     * Operations are timed from their call to their return, on the calling thread, including the wait for other
+     * updates. Overloads share the name of their method. getCostForExchange and findBestExchangePath are counted on
+     * every call and timed on one call in 16, see LatencyHistogram. Cheap enough to scrape every second
+     */
+    GraphManagerStats stats() const;
+
+    /*! refreshAllPairs - compute the distances and next hops between all currencies now
+     *
+     * Call after a batch of updates: every route lookup until the next update is then O(route length).
+     * Once computed, later updates only patch the distances that changed
+     */
+    void refreshAllPairs();
+
 };
 
 
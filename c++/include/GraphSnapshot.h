@@ -0,0 +1,161 @@
+// GraphSnapshot.h
+// GraphSnapshot Class Specification
+
+#ifndef KRYPTOS_GRAPHSNAPSHOT_H
+#define KRYPTOS_GRAPHSNAPSHOT_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Graph.h"
+#include "CurrencyPair.h"
+#include "SymbolTable.h"
+#include "ShortestPathTree.h"
+#include "AllPairsShortestPaths.h"
+#include "ThreadPool.h"
+#include "KShortestPaths.h"
+#include "CycleScanner.h"
+
+// A profitable cycle of exchanges: trading along the pairs ends in the first currency with (1 + gain) times the amount
+struct ArbitrageCycle {
+    std::list<CurrencyPair> pairs;
+    double gain;
+};
+
+// One published version of the graph of a GraphManager, together with its currency ids.
+// The graph and the symbols never change once published, so any number of threads can query a snapshot at the same
+// time without locks, while the manager builds the next version. Results computed on demand (shortest path trees,
+// all-pairs distances) are cached in the snapshot and shared by every thread that holds it.
+class GraphSnapshot {
+private:
+    unsigned long version;
+    std::shared_ptr<const Graph<std::string> > graph;
+    std::shared_ptr<const SymbolTable> symbols;
+
+    // threads for the all-pairs computation, nullptr to run on the calling thread
+    std::shared_ptr<ThreadPool> threadPool;
+
+    // found by the manager while publishing, most profitable first
+    std::vector<ArbitrageCycle> arbitrageCycles;
+
+    // one slot per currency id, filled with std::atomic_store by the first query from that currency.
+    // Two threads may compute the same tree, the trees are equal and either one is kept
+    mutable std::vector< std::shared_ptr<const ShortestPathTree> > shortestPathTrees;
+
+    // computed once, by the first thread asking for it. Read and written with std::atomic_load/std::atomic_store
+    mutable std::shared_ptr<const AllPairsShortestPaths> allPairs;
+    mutable std::once_flag allPairsComputed;
+
+    // edges of the graph in the layout of the k shortest paths search, built by the first query for alternatives unless
+    // the manager patched the one of the previous version. Read and written with std::atomic_load/std::atomic_store
+    mutable std::shared_ptr<const KShortestPaths> alternativeRoutes;
+    mutable std::once_flag alternativeRoutesBuilt;
+
+    // rates of the graph in the dense layout of the short cycle scan, built by the first scan, same as alternativeRoutes
+    mutable std::shared_ptr<const CycleScanner> cycleScanner;
+    mutable std::once_flag cycleScannerBuilt;
+
+    // currency pairs along a path of ids, with their prices
+    std::list<CurrencyPair> constructRoute(const std::vector<uint32_t>& path) const;
+
+    // true if the id is the one of a currency of this version
+    bool isCurrency(uint32_t currencyId) const;
+
+public:
+    // Constructor: allPairs, alternativeRoutes and cycleScanner, if given, must have been taken from this graph
+    GraphSnapshot(unsigned long version, std::shared_ptr<const Graph<std::string> > graph,
+                  std::shared_ptr<const SymbolTable> symbols, std::shared_ptr<ThreadPool> threadPool,
+                  std::shared_ptr<const AllPairsShortestPaths> allPairs = nullptr,
+                  std::vector<ArbitrageCycle> arbitrageCycles = std::vector<ArbitrageCycle>(),
+                  std::shared_ptr<const KShortestPaths> alternativeRoutes = nullptr,
+                  std::shared_ptr<const CycleScanner> cycleScanner = nullptr);
+
+    GraphSnapshot(const GraphSnapshot&) = delete;
+    GraphSnapshot& operator=(const GraphSnapshot&) = delete;
+
+    // Getters
+    unsigned long getVersion() const;
+    const Graph<std::string>& getGraph() const;
+    const SymbolTable& getSymbols() const;
+
+    /*! getArbitrageCycles - the profitable cycles of this version, most profitable first
+     */
+    const std::vector<ArbitrageCycle>& getArbitrageCycles() const;
+
+    /*! getCurrencyId - return the id of the currency, SymbolTable::kInvalidId if the currency is not in this version
+     */
+    uint32_t getCurrencyId(const std::string& symbol) const;
+
+    /*! getShortestPathTree - best routes from given currency to every other currency, computed once per snapshot
+     *
+     * @return - nullptr if fromCurrency is not a currency of this version
+     */
+    std::shared_ptr<const ShortestPathTree> getShortestPathTree(uint32_t fromCurrency) const;
+
+    /*! getAllPairsShortestPaths - distances and next hops between all currencies, computed on the first call
+     */
+    std::shared_ptr<const AllPairsShortestPaths> getAllPairsShortestPaths() const;
+
+    /*! getComputedAllPairs - the all-pairs distances if some thread already asked for them, nullptr otherwise
+     */
+    std::shared_ptr<const AllPairsShortestPaths> getComputedAllPairs() const;
+
+    /*! getBuiltAlternativeRoutes, getBuiltCycleScanner - the layouts of the searches if a query already built them,
+     *  nullptr otherwise
+     */
+    std::shared_ptr<const KShortestPaths> getBuiltAlternativeRoutes() const;
+    std::shared_ptr<const CycleScanner> getBuiltCycleScanner() const;
+
+    /*! findBestExchangePath - ids of the currencies on the best route, see GraphManager::findBestExchangePath
+     */
+    std::vector<uint32_t> findBestExchangePath(uint32_t fromCurrency, uint32_t toCurrency) const;
+
+    /*! findBestExchangeRoute - currency pairs on the best route, empty if there is none
+     */
+    std::list<CurrencyPair> findBestExchangeRoute(const std::string& fromCurrency, const std::string& toCurrency) const;
+
+    /*! findBestExchangePaths - best routes between many pairs of currencies, as ids
+     *
+     * The shortest path tree of every distinct source is computed once, in parallel across sources on the thread pool
+     *
+     * @param routes - (from id, to id) pairs
+     * @return - one path per entry of routes, in the same order. Empty where there is no route
+     */
+    std::vector< std::vector<uint32_t> > findBestExchangePaths(const std::vector< std::pair<uint32_t, uint32_t> >& routes) const;
+
+    /*! findBestExchangeRoutes - same as findBestExchangePaths, by symbol. Empty where either currency is unknown
+     */
+    std::vector< std::list<CurrencyPair> > findBestExchangeRoutes(const std::vector< std::pair<std::string, std::string> >& routes) const;
+
+    /*! findAlternativePaths - the k best routes between two currencies with at most maxHops pairs, best first
+     *
+     * @param maxHops - 0 for no limit
+     * @return - ids of the currencies on every route, as in findBestExchangePath. Empty if there is no route
+     */
+    std::vector< std::vector<uint32_t> > findAlternativePaths(uint32_t fromCurrency, uint32_t toCurrency, unsigned int k,
+                                                            unsigned int maxHops = 0) const;
+
+    /*! findAlternativeRoutes - same as findAlternativePaths, by symbol. Empty if either currency is unknown
+     */
+    std::vector< std::list<CurrencyPair> > findAlternativeRoutes(const std::string& fromCurrency, const std::string& toCurrency,
+                                                               unsigned int k, unsigned int maxHops = 0) const;
+
+    /*! findShortArbitrageCycles - the most profitable cycles of up to maxLength pairs after fees, see CycleScanner
+     *
+     * @param maxLength - 2 to 4 pairs
+     * @param feeRate - fraction of the amount paid on every exchange
+     * @return - up to topN cycles, most profitable first, with gain after fees
+     */
+    std::vector<ArbitrageCycle> findShortArbitrageCycles(unsigned int maxLength, unsigned int topN, double feeRate) const;
+
+    /*! getCostForExchange - price of exchanging 2 currencies directly, 0 if they do not trade directly
+     */
+    double getCostForExchange(uint32_t fromCurrency, uint32_t toCurrency) const;
+};
+
+#endif //KRYPTOS_GRAPHSNAPSHOT_H
@@ -0,0 +1,97 @@
+// KShortestPaths.h
+// KShortestPaths Class Specification
+
+#ifndef KRYPTOS_KSHORTESTPATHS_H
+#define KRYPTOS_KSHORTESTPATHS_H
+
+#include <utility>
+#include <vector>
+
+#include "Graph.h"
+#include "AllPairsShortestPaths.h"
+
+// Ranked alternative routes between two vertices: the k shortest simple paths (Yen's algorithm), optionally limited to
+// a number of edges. The edges are copied once into compressed rows, so the graph itself is never changed to
+// exclude edges, and one instance answers any number of queries.
+//
+// Weights may be negative, so paths are searched with Bellman-Ford rounds, one round per edge of the path. All the
+// spur searches of a query share their buffers and one table of lower bounds on the distance to the destination,
+// which skips the spur searches that cannot produce one of the k routes. When the graph has negative cycles the searches
+// leave out the edges that would close them, so they still end quickly and return valid simple routes, which are then
+// not necessarily the best
+class KShortestPaths {
+public:
+    struct Route {
+        std::vector<unsigned int> path; // ids of the vertices, starting with the source
+        double weight;                  // sum of the weights of the edges along path
+    };
+
+private:
+    unsigned int numberOfVertices;
+
+    // edges leaving vertex i are [outgoingOffsets[i], outgoingOffsets[i + 1]) of outgoingTargets/outgoingWeights
+    std::vector<unsigned int> outgoingOffsets;
+    std::vector<unsigned int> outgoingTargets;
+    std::vector<double> outgoingWeights;
+
+    // same for the edges entering vertex i, used for the lower bounds
+    std::vector<unsigned int> incomingOffsets;
+    std::vector<unsigned int> incomingSources;
+    std::vector<double> incomingWeights;
+
+    // search state shared by the spur searches of one query, see KShortestPaths.cpp
+    struct Search;
+
+    // build both compressed row arrays from the out-edges of every vertex
+    void buildRows(const std::vector< std::vector< std::pair<unsigned int, double> > >& edges);
+
+    // weight of the edge, INF if there is none
+    double getWeight(unsigned int from, unsigned int to) const;
+
+    // sum of the edge weights along the path
+    double getPathWeight(const std::vector<unsigned int>& path) const;
+
+    // lower bound on the weight of the routes of at most maxHops edges from every vertex to 'to', in the graph
+    // without exclusions
+    void computeDistancesToTarget(unsigned int to, unsigned int maxHops, Search& search) const;
+
+    // shortest route of at most maxHops edges from spur to 'to' that avoids the blocked vertices and edges, searching
+    // only vertices that can still reach 'to' below budget. Returns false if there is none
+    bool searchSpur(unsigned int spur, unsigned int to, unsigned int maxHops, double budget, Search& search,
+                    std::vector<unsigned int>& path) const;
+
+public:
+    // Constructor: snapshot of the vertices and edges of the graph
+    template <class T>
+    explicit KShortestPaths(const Graph<T>& graph) : numberOfVertices(graph.getNumberOfVertexIds())
+    {
+        std::vector< std::vector< std::pair<unsigned int, double> > > edges(numberOfVertices);
+        for (unsigned int from = 0; from < numberOfVertices; ++from)
+            graph.getOutgoingEdges(from, edges[from]);
+
+        buildRows(edges);
+    }
+
+    unsigned int getNumberOfVertices() const;
+
+    /*! applyEdgeChanges - update the weights after the weights of existing edges changed
+     *
+     * Meant for a copy of the search of the previous version: the rows are copied as they are and the changed weights
+     * written in place, instead of laying out the edges of the graph again. Edges that were added or removed change the
+     * rows, which takes a new search
+     *
+     * @param changes - edges changed since the edges were taken, in the order they were made
+     * @return - false if a change adds or removes an edge, the search is then left unchanged
+     */
+    bool applyEdgeChanges(const std::vector<AllPairsShortestPaths::EdgeChange>& changes);
+
+    /*! find - the k shortest simple paths from 'from' to 'to', shortest first
+     *
+     * @param k - maximum number of routes returned
+     * @param maxHops - maximum number of edges of a route, 0 for no limit
+     * @return - up to k routes with distinct paths, fewer if there are no more. Empty if from == to
+     */
+    std::vector<Route> find(unsigned int from, unsigned int to, unsigned int k, unsigned int maxHops = 0) const;
+};
+
+#endif //KRYPTOS_KSHORTESTPATHS_H
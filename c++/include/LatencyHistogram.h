@@ -0,0 +1,92 @@
+// LatencyHistogram.h
+// LatencyHistogram Class Specification
+
+#ifndef KRYPTOS_LATENCYHISTOGRAM_H
+#define KRYPTOS_LATENCYHISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Latencies in nanoseconds counted in log-linear buckets, as in HdrHistogram: every power of two is split into 32
+// buckets, so any value is known to within 1/32 (3%) from 1 ns up to about a minute, in 8KB of counters.
+//
+// Recording is a few relaxed atomic increments, threads record concurrently without locks. A summary copies the
+// counters first, it may miss the values recorded meanwhile but never stops the recorders.
+//
+// Reading the clock twice costs more than the cheapest lookups it would time, so a Timer can time one call in N and
+// only count the others: every call is counted, the latencies come from the timed ones
+class LatencyHistogram {
+public:
+    // percentiles are the highest value of the bucket they fall in, never less than the true value
+    struct Summary {
+        uint64_t count;           // calls
+        uint64_t sampleCount;     // calls that were timed, the latencies below are theirs
+        double meanNanoseconds;
+        uint64_t p50Nanoseconds;
+        uint64_t p90Nanoseconds;
+        uint64_t p99Nanoseconds;
+        uint64_t p999Nanoseconds;
+        uint64_t maxNanoseconds;
+    };
+
+    // counts a call, and records the time from its construction to its destruction for one call in samplingPeriod
+    class Timer {
+    private:
+        LatencyHistogram& histogram;
+        const bool sampled;
+        const std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit Timer(LatencyHistogram& histogram, unsigned int samplingPeriod = 1) :
+                histogram(histogram), sampled(histogram.countCall() % samplingPeriod == 0),
+                start(sampled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()) {}
+
+        ~Timer()
+        {
+            if (sampled)
+                histogram.recordSample((uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start).count());
+        }
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+    };
+
+    static const unsigned int kSubBucketBits = 5;
+    static const unsigned int kNumberOfBuckets = 1024;
+
+private:
+    std::atomic<uint64_t> numberOfCalls;
+    std::atomic<uint64_t> counts[kNumberOfBuckets];
+    std::atomic<uint64_t> totalNanoseconds;
+    std::atomic<uint64_t> maxNanoseconds;
+
+    // values above the last bucket are counted in it
+    static unsigned int bucketOf(uint64_t nanoseconds);
+    static uint64_t highestValueOf(unsigned int bucket);
+
+public:
+    // Constructor: empty
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // one call that took the given time
+    void record(uint64_t nanoseconds);
+
+    // one call, returns the number of calls before it
+    uint64_t countCall();
+
+    // the time of a call that was counted already
+    void recordSample(uint64_t nanoseconds);
+
+    /*! summarize - count, mean, p50, p90, p99, p99.9 and maximum of the values recorded so far
+     */
+    Summary summarize() const;
+
+    void reset();
+};
+
+#endif //KRYPTOS_LATENCYHISTOGRAM_H
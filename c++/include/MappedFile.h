@@ -0,0 +1,60 @@
+// MappedFile.h
+// MappedFile Class Specification
+
+#ifndef KRYPTOS_MAPPEDFILE_H
+#define KRYPTOS_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only view of a whole file, mapped into memory instead of copied through stream buffers.
+// The pages are loaded by the kernel as they are read, and the view stays valid until the object is destroyed
+class MappedFile {
+public:
+    // how the pages are going to be read, passed on to the kernel
+    enum Access {
+        kReadOnce, // front to back, once: read ahead of the reader
+        kKeep      // in any order, for as long as the file is mapped: start reading all of it in the background
+    };
+
+private:
+    const char* data;
+    size_t size;
+    bool open;
+    std::string error;
+
+    void unmap();
+
+public:
+    // Default Constructor: nothing mapped
+    MappedFile();
+
+    // Constructor: maps the file, check isOpen() for the result
+    explicit MappedFile(const std::string& fileName, Access access = kReadOnce);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other);
+    MappedFile& operator=(MappedFile&& other);
+
+    ~MappedFile();
+
+    /*! map - map the file, replacing what was mapped before
+     *
+     * @return - false if the file could not be opened or mapped, getError() tells why
+     */
+    bool map(const std::string& fileName, Access access = kReadOnce);
+
+    // Getters
+    bool isOpen() const;
+
+    // first byte of the file, nullptr for an empty file
+    const char* getData() const;
+
+    size_t getSize() const;
+
+    const std::string& getError() const;
+};
+
+#endif //KRYPTOS_MAPPEDFILE_H
@@ -0,0 +1,82 @@
+// PerfCounters.h
+// PerfCounters Class Specification
+
+#ifndef KRYPTOS_PERFCOUNTERS_H
+#define KRYPTOS_PERFCOUNTERS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Hardware counters of the path kernels and ingestion phases, read with Linux perf_event_open.
+//
+// A Scope names a phase and adds the cycles, instructions, L1 data and last level cache misses, branch misses and page
+// faults of the calling thread between its construction and destruction to the totals of the phase. Work handed to
+// other threads, such as the tiles given to the ThreadPool, is not counted, run with one thread to see all of it.
+//
+// Counting is off until setEnabled(true), a Scope is then a single atomic load. Each thread opens its counters on its
+// first counted scope and reads them all with one system call per scope end. Counters the machine or the permissions
+// do not allow (virtual machines without a PMU, perf_event_paranoid, other systems than Linux) are left out and
+// reported as unavailable, and the phases still get their calls and time
+class PerfCounters {
+public:
+    enum Counter {
+        kCycles,
+        kInstructions,
+        kL1DataMisses,
+        kLastLevelCacheMisses,
+        kBranchMisses,
+        kPageFaults,
+        kNumberOfCounters
+    };
+
+    static const char* const kCounterNames[kNumberOfCounters];
+
+    // totals of a phase over all its calls and threads
+    struct Phase {
+        std::string name;
+        uint64_t calls;
+        uint64_t nanoseconds;
+        uint64_t counts[kNumberOfCounters];
+        bool available[kNumberOfCounters]; // false if no call could count it, its count is then 0
+    };
+
+    // counts the enclosing scope as one call of the phase, name is a string literal
+    class Scope {
+    private:
+        const char* phase;
+        bool active;
+        uint64_t start[kNumberOfCounters + 1]; // counts, then the time
+
+    public:
+        explicit Scope(const char* phase);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+    static std::atomic<bool> enabled;
+
+public:
+    static void setEnabled(bool value);
+
+    static bool isEnabled()
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /*! isAvailable - true if the calling thread can count this counter, opening its counters if needed
+     */
+    static bool isAvailable(Counter counter);
+
+    /*! summarize - the phases counted since the last reset, by name
+     */
+    static std::vector<Phase> summarize();
+
+    static void reset();
+};
+
+#endif //KRYPTOS_PERFCOUNTERS_H
@@ -0,0 +1,46 @@
+// ShortestPathTree.h
+// ShortestPathTree Class Specification
+
+#ifndef KRYPTOS_SHORTESTPATHTREE_H
+#define KRYPTOS_SHORTESTPATHTREE_H
+
+#include <vector>
+
+// Result of a single source shortest path search: the distance from the source to every vertex,
+// and the parent of every vertex on its shortest path. One tree answers the route to every destination.
+class ShortestPathTree {
+private:
+    unsigned int source;
+    std::vector<double> distances;
+    std::vector<int> parents; // -1 for the source and for unreachable vertices
+    bool negativeCycle;
+
+public:
+    // Constructor: every vertex is unreachable except the source
+    ShortestPathTree(unsigned int source, unsigned int numberOfVertices);
+
+    // Getters
+    unsigned int getSource() const;
+    unsigned int getNumberOfVertices() const;
+    double getDistance(unsigned int vertex) const;
+    int getParent(unsigned int vertex) const;
+    bool isReachable(unsigned int vertex) const;
+
+    /*! hasNegativeCycle - true if the search reached a negative cycle. The edges that would have closed it were left
+     *  out, so every path is still a simple route, but it and its distance may not be the cheapest one
+     */
+    bool hasNegativeCycle() const;
+
+    /*! getPath - return the ids of the vertices on the shortest path from the source to given vertex
+     *
+     * @return - path starting with the source and ending with 'to'. Empty if 'to' is unreachable
+     *           or its parents run into a cycle
+     */
+    std::vector<unsigned int> getPath(unsigned int to) const;
+
+    // Setters used by the search
+    void setDistance(unsigned int vertex, double distance, int parent);
+    void setNegativeCycle(bool);
+};
+
+#endif //KRYPTOS_SHORTESTPATHTREE_H
@@ -0,0 +1,93 @@
+// SnapshotFile.h
+// SnapshotFile Class Specification
+
+#ifndef KRYPTOS_SNAPSHOTFILE_H
+#define KRYPTOS_SNAPSHOTFILE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MappedFile.h"
+#include "AllPairsShortestPaths.h"
+#include "GraphSnapshot.h"
+
+// Versioned binary image of a GraphSnapshot, to start from a saved graph instead of parsing every rate again.
+//
+// Layout, in the byte order of the machine that wrote it, every section starting on a 64 byte boundary:
+//   header       magic, format version, byte order mark, counts and the offset of every section below
+//   symbols      uint64_t offsets[V + 1] into the characters, then the characters of every symbol, by currency id
+//   edges        compressed rows: uint64_t offsets[V + 1], then uint32_t targets[E] and double weights[E]
+//   all-pairs    optional: double distances[S * S] and uint32_t nextHops[S * S], S = AllPairsShortestPaths::getStride()
+//
+// Loading maps the file read-only and checks every count and offset against its size before anything is read.
+// The weights are the logs the graph holds, so the loaded graph is exactly the saved one, and the all-pairs matrices
+// are read in place: processes that load the same file share its pages instead of each computing V^3
+class SnapshotFile {
+public:
+    // bumped whenever the layout changes, older files are refused rather than misread
+    static const uint32_t kFormatVersion;
+
+private:
+    struct Header;
+
+    std::shared_ptr<const MappedFile> file;
+    const Header* header;
+
+    const uint64_t* symbolOffsets;
+    const char* symbolCharacters;
+    const uint64_t* edgeOffsets;
+    const uint32_t* edgeTargets;
+    const double* edgeWeights;
+    const double* distances;  // nullptr without all-pairs
+    const uint32_t* nextHops; // nullptr without all-pairs or without routes
+
+    std::string error;
+
+    // record why the file cannot be loaded, and forget it
+    bool fail(const std::string& reason);
+
+public:
+    // Constructor: nothing loaded
+    SnapshotFile();
+
+    /*! save - write the graph and symbols of the snapshot to fileName
+     *
+     * The file is written next to fileName and renamed over it once complete, so a reader never maps half a file
+     *
+     * @param withAllPairs - also write the all-pairs distances and next hops, computing them if no query did yet
+     * @param error - why the file could not be written
+     * @return - false if the file could not be written
+     */
+    static bool save(const GraphSnapshot& snapshot, bool withAllPairs, const std::string& fileName, std::string& error);
+
+    /*! load - map a file written by save and check its layout, replacing what was loaded before
+     *
+     * @return - false if the file cannot be read or is not a valid snapshot of this format, getError() tells why
+     */
+    bool load(const std::string& fileName);
+
+    // Getters
+    bool isLoaded() const;
+    const std::string& getError() const;
+
+    // version of the snapshot that was saved
+    unsigned long getVersion() const;
+
+    uint32_t getNumberOfVertices() const;
+    std::string getSymbol(uint32_t id) const;
+
+    /*! getOutgoingEdges - replace the content of 'edges' with the (target id, weight) of every edge leaving fromId
+     */
+    void getOutgoingEdges(uint32_t fromId, std::vector< std::pair<unsigned int, double> >& edges) const;
+
+    /*! getAllPairs - the saved all-pairs distances, read from the mapped file. nullptr if they were not saved
+     *
+     * The result keeps the file mapped for as long as it is held
+     */
+    std::shared_ptr<const AllPairsShortestPaths> getAllPairs() const;
+};
+
+#endif //KRYPTOS_SNAPSHOTFILE_H
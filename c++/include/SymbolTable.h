@@ -0,0 +1,43 @@
+// SymbolTable.h
+// SymbolTable Class Specification
+
+#ifndef KRYPTOS_SYMBOLTABLE_H
+#define KRYPTOS_SYMBOLTABLE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Interns currency symbols: every distinct symbol gets a dense uint32_t id, assigned in order of first appearance.
+// Symbols are hashed once at the boundary, the rest of the program works with the ids.
+class SymbolTable {
+private:
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<std::string> symbols;
+
+public:
+    // id returned for symbols that are not in the table
+    static const uint32_t kInvalidId;
+
+    // Default Constructor (nothing to initialize)
+    SymbolTable() = default;
+
+    /*! intern - return the id of the symbol, assigning the next free id if the symbol is new
+     */
+    uint32_t intern(const std::string& symbol);
+
+    /*! lookUp - return the id of the symbol, kInvalidId if the symbol was never interned
+     */
+    uint32_t lookUp(const std::string& symbol) const;
+
+    /*! getSymbol - return the symbol with given id. The id must be smaller than size()
+     */
+    const std::string& getSymbol(uint32_t id) const;
+
+    uint32_t size() const;
+
+    void clear();
+};
+
+#endif //KRYPTOS_SYMBOLTABLE_H
@@ -0,0 +1,65 @@
+// ThreadPool.h
+// ThreadPool Class Specification
+
+#ifndef KRYPTOS_THREADPOOL_H
+#define KRYPTOS_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that run the iterations of a loop in parallel.
+// The threads are started once and sleep between loops, so a parallelFor costs a wake-up, not a thread creation.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+
+    // only one loop runs at a time, callers from other threads wait here
+    std::mutex callerMutex;
+
+    // the loop being run, valid while busyWorkers > 0
+    const std::function<void(size_t)>* body;
+    size_t numberOfIterations;
+    std::atomic<size_t> nextIteration;
+
+    unsigned int busyWorkers;
+    unsigned long generation; // incremented for every loop, wakes the workers
+    bool stopping;
+
+    void workerLoop();
+
+    // take iterations from the shared counter until there are none left
+    void runIterations();
+
+public:
+    // Constructor: numberOfThreads includes the calling thread, so 1 starts no workers and runs loops serially
+    explicit ThreadPool(unsigned int numberOfThreads);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool();
+
+    unsigned int getNumberOfThreads() const;
+
+    /*! parallelFor - call body(i) for every i in [0, numberOfIterations), spread over the threads of the pool
+     *
+     * The calling thread takes part and the function returns once every iteration finished.
+     * Iterations run in no particular order and must not throw
+     */
+    void parallelFor(size_t numberOfIterations, const std::function<void(size_t)>& body);
+
+    /*! getHardwareConcurrency - number of hardware threads, at least 1
+     */
+    static unsigned int getHardwareConcurrency();
+};
+
+#endif //KRYPTOS_THREADPOOL_H
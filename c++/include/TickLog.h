@@ -0,0 +1,124 @@
+// TickLog.h
+// TickLogWriter and TickLogReader Class Specification
+
+#ifndef KRYPTOS_TICKLOG_H
+#define KRYPTOS_TICKLOG_H
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "MappedFile.h"
+
+// Append-only binary log of the price updates a GraphManager applied, to replay them later without a feed.
+//
+// The file starts with "KRYPTICK", a uint32_t format version and a uint32_t byte order mark. Records follow, each one
+// byte of kind and its fields packed in the byte order of the machine that wrote them:
+//   kSession    a writer opened the file: the symbol ids of the records before do not hold anymore
+//   kSymbol     uint32_t id, uint16_t length, the characters of the symbol
+//   kRate       uint32_t from id, uint32_t to id, double price, as given to the manager
+//   kPublish    int64_t nanoseconds since the epoch: the rates since the previous kPublish were published together
+//
+// A rate takes 17 bytes, against about 30 for the same line of text and without parsing it back
+namespace TickLog {
+
+    enum Kind : uint8_t {
+        kSession = 1,
+        kSymbol = 2,
+        kRate = 3,
+        kPublish = 4
+    };
+
+    // bumped whenever the layout changes, older logs are refused rather than misread
+    extern const uint32_t kFormatVersion;
+
+    // one record of the log, only the fields of its kind are set
+    struct Record {
+        Kind kind;
+        uint32_t from;        // kRate, and the id of kSymbol
+        uint32_t to;          // kRate
+        double price;         // kRate
+        int64_t timestamp;    // kPublish
+        const char* symbol;   // kSymbol, not terminated, points into the mapped log
+        uint16_t symbolLength;
+    };
+}
+
+// Appends records to a log. Records are buffered in memory and written by every publish record, so the cost on the
+// update path is a copy of a few bytes and the log is at most one batch behind after a crash
+class TickLogWriter {
+private:
+    std::ofstream out;
+    std::string buffer;
+    size_t numberOfRatesBuffered;
+    std::string error;
+
+    void append(const void* data, size_t size);
+
+public:
+    // Constructor: closed
+    TickLogWriter();
+
+    ~TickLogWriter();
+
+    TickLogWriter(const TickLogWriter&) = delete;
+    TickLogWriter& operator=(const TickLogWriter&) = delete;
+
+    /*! open - append to the log, creating it if needed, starting a new session
+     *
+     * @return - false if the file cannot be written or is not a log of this format, getError() tells why
+     */
+    bool open(const std::string& fileName);
+
+    void writeSymbol(uint32_t id, const std::string& symbol);
+    void writeRate(uint32_t fromId, uint32_t toId, double price);
+
+    /*! writePublish - end the batch of rates written since the last call, and write the records out
+     *
+     * Does nothing without rates since the last call
+     */
+    void writePublish(int64_t timestamp);
+
+    /*! close - write the buffered records and close the file
+     *
+     * @return - false if any record could not be written since open, getError() tells why
+     */
+    bool close();
+
+    // Getters
+    bool isOpen() const;
+    const std::string& getError() const;
+};
+
+// Reads the records of a log front to back, from a read-only mapping of the file
+class TickLogReader {
+private:
+    std::unique_ptr<MappedFile> file;
+    const char* position;
+    const char* end;
+    bool truncated;
+    std::string error;
+
+public:
+    // Constructor: nothing open
+    TickLogReader();
+
+    /*! open - map a log and check its file header
+     *
+     * @return - false if the file cannot be read or is not a log of this format, getError() tells why
+     */
+    bool open(const std::string& fileName);
+
+    /*! next - read the next record
+     *
+     * @return - false at the end of the log. A record cut short by a writer that died is not returned, see isTruncated
+     */
+    bool next(TickLog::Record& record);
+
+    // Getters
+    bool isTruncated() const;
+    const std::string& getError() const;
+};
+
+#endif //KRYPTOS_TICKLOG_H
@@ -0,0 +1,142 @@
+// Trace.h
+// Trace Class Specification
+
+#ifndef KRYPTOS_TRACE_H
+#define KRYPTOS_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Tracing of the library, for offline profiling instead of console output.
+//
+// Trace points are macros that compile to nothing unless KRYPTOS_TRACING is defined (make TRACING=1):
+//   KRYPTOS_TRACE_SCOPE(level, category, name)           times the enclosing scope
+//   KRYPTOS_TRACE(level, category, name, message)        one event with a std::string message
+// name is a string literal. The message is only built when the level and category are enabled at runtime.
+//
+// Compiled in, every thread writes its events into its own ring buffer of the last kEventsPerThread events, without
+// locks or system calls. writeChromeJson dumps the buffers of every thread in the Chrome trace event format, to be
+// opened in chrome://tracing or Perfetto
+class Trace {
+public:
+    enum Level {
+        kError = 0,
+        kWarning = 1,
+        kInfo = 2,
+        kDebug = 3
+    };
+
+    // bit mask, one bit per category
+    enum Category {
+        kGraph = 1 << 0,  // graph containers
+        kParser = 1 << 1, // reading rates from files and buffers
+        kUpdate = 1 << 2, // applying rates and publishing snapshots
+        kQuery = 1 << 3,  // routes, costs and cycles
+        kAllCategories = kGraph | kParser | kUpdate | kQuery
+    };
+
+    static const unsigned int kEventsPerThread = 1 << 14;
+
+    // messages are cut to this many characters
+    static const unsigned int kMaxMessageLength = 47;
+
+    // times the scope it is declared in, see KRYPTOS_TRACE_SCOPE
+    class Scope {
+    private:
+        const char* name;
+        Level level;
+        Category category;
+        int64_t start; // -1 when the level or category is disabled
+
+    public:
+        Scope(Level level, Category category, const char* name) :
+                name(name), level(level), category(category), start(isEnabled(level, category) ? now() : -1) {}
+
+        ~Scope()
+        {
+            if (start >= 0)
+                record(level, category, name, start, now() - start, nullptr, 0);
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+    static std::atomic<int> enabledLevel;
+    static std::atomic<unsigned int> enabledCategories;
+
+public:
+    /*! setLevel - record the events of this level and the more severe ones, kInfo by default
+     */
+    static void setLevel(Level level);
+
+    /*! setCategories - record the events of these categories only, all by default
+     */
+    static void setCategories(unsigned int categories);
+
+    static bool isEnabled(Level level, Category category)
+    {
+        return level <= enabledLevel.load(std::memory_order_relaxed) &&
+               (category & enabledCategories.load(std::memory_order_relaxed)) != 0;
+    }
+
+    // nanoseconds since the first event of the process
+    static int64_t now();
+
+    /*! record - write an event to the buffer of the calling thread
+     *
+     * @param duration - nanoseconds, -1 for an event without duration
+     * @param message - characters of the message, nullptr for none
+     */
+    static void record(Level level, Category category, const char* name, int64_t start, int64_t duration,
+                       const char* message, size_t messageLength);
+
+    static void record(Level level, Category category, const char* name, const std::string& message)
+    {
+        record(level, category, name, now(), -1, message.data(), message.size());
+    }
+
+    /*! writeChromeJson - the events of every thread, oldest first per thread, as a Chrome trace
+     *
+     * Threads keep recording while they are dumped: events overwritten during the dump are left out
+     */
+    static void writeChromeJson(std::ostream& out);
+
+    /*! dumpChromeJson - same as writeChromeJson, to a file
+     *
+     * @return - false if the file could not be written, error tells why
+     */
+    static bool dumpChromeJson(const std::string& fileName, std::string& error);
+
+    /*! isCompiledIn - true if the library was built with KRYPTOS_TRACING
+     */
+    static bool isCompiledIn();
+};
+
+#define KRYPTOS_TRACE_CONCATENATE_(a, b) a##b
+#define KRYPTOS_TRACE_CONCATENATE(a, b) KRYPTOS_TRACE_CONCATENATE_(a, b)
+
+#ifdef KRYPTOS_TRACING
+
+#define KRYPTOS_TRACE_SCOPE(level, category, name) \
+    Trace::Scope KRYPTOS_TRACE_CONCATENATE(traceScope, __LINE__)(Trace::level, Trace::category, name)
+
+#define KRYPTOS_TRACE(level, category, name, message) \
+    do { \
+        if (Trace::isEnabled(Trace::level, Trace::category)) \
+            Trace::record(Trace::level, Trace::category, name, message); \
+    } while (0)
+
+#else
+
+#define KRYPTOS_TRACE_SCOPE(level, category, name) do {} while (0)
+// the message is named in sizeof only, never evaluated, so the variables it uses do not turn into unused ones
+#define KRYPTOS_TRACE(level, category, name, message) do { (void) sizeof(message); } while (0)
+
+#endif
+
+#endif //KRYPTOS_TRACE_H
@@ -6,10 +6,10 @@
 #define CMPE130PROJECT_UNDIRECTEDMATRIXGRAPH_H
 
 #include "Graph.h"
+#include "DefaultInitAllocator.h"
 #include <vector>
 #include <list>
 #include <unordered_map>
-#include <stack>
 
 class CurrencyPair;
 
@@ -17,21 +17,48 @@ class CurrencyPair;
 template <class T>
 class UndirectedMatrixGraph : public Graph<T>
 {
-// vector of vectors to create a 2d matrix
-    // vector list of our vertices
-
+protected:
     using Graph<T>::totalNumberOfVertices;
 
-protected:
+    // initial number of rows and columns allocated for the matrix
+    static const unsigned int kInitialCapacity = 16;
+
     std::vector<Vertex<T> > vertexList;
     std::unordered_map<std::string, unsigned int> verticesMap;
-    std::vector< std::vector<double> > adjMatrix;
 
+    // capacity x capacity weights in one row-major buffer, capacity grows by half when a vertex does not fit.
+    // Only the rows of the slots in use are initialized, the pages of the other rows are not touched
+    std::vector<double, DefaultInitAllocator<double> > adjMatrix;
+    unsigned int capacity;
+
+    // removed vertices keep their slot (and id) until more than half of the slots are removed,
+    // then compact() moves the remaining vertices to the front
+    std::vector<bool> removedVertices;
+    unsigned int numberOfRemovedVertices;
+
+    // columns of the entries set in each row of adjMatrix, so searches only visit real neighbors
+    std::vector< std::vector<unsigned int> > neighborLists;
+
+
+    // weight of the edge fromIndex -> toIndex in adjMatrix
+    double& weightAt(unsigned int fromIndex, unsigned int toIndex)
+    {
+        return adjMatrix[(size_t) fromIndex * capacity + toIndex];
+    }
+
+    const double& weightAt(unsigned int fromIndex, unsigned int toIndex) const
+    {
+        return adjMatrix[(size_t) fromIndex * capacity + toIndex];
+    }
+
+    // set adjMatrix[fromIndex][toIndex] and keep the neighbor list of fromIndex in sync
+    void setWeight(unsigned int fromIndex, unsigned int toIndex, double cost);
 
-    void constructPath(int parent[], int j, std::list<T>& path) const;
+    // reallocate the matrix with newCapacity rows and columns, keeping the weights
+    void grow(unsigned int newCapacity);
 
-    int minDistance(const double dist[],
-                    const bool sptSet[], int V) const;
+    // drop the slots of removed vertices. The vertices after a removed slot get smaller ids
+    void compact();
 
 
 public:
@@ -44,16 +71,16 @@ public:
     // @param: Vertex * addThisVertex
 
     //1. adds to list using stl vector function
-    //2. notifies user
+    //2. grows the capacity of the matrix if the new row does not fit
     //3. increments the number of verices
     virtual void addVertex(const T& value);
 
     //This function removes a vertices to our vertex List
     // @param: Vertex * deleteThisVertex
 
-    //1. Checks for whether the vertex exists, if it does, erase from list using stl vector function
+    //1. Checks for whether the vertex exists, if it does, remove all of its edges and mark its slot as removed
     //2. notifies user
-    //3. increments the number of verices
+    //3. decrements the number of vertices, compacts the matrix once most slots are removed
     virtual void removeVertex(const T& value);
 
     //This function adds an edge between two given vertices and sets an associated cost to the edge
@@ -114,6 +141,9 @@ public:
     // function to remove all vertices in the graph
     virtual void reset();
 
+    // copy of the graph, see Graph.h
+    virtual Graph<T>* clone() const;
+
 
     /*! computeShortestDistanceBetweenAllVertices - Calculate shortest paths between all vertices using Floyd-Warshall Algorithm
      *
@@ -126,6 +156,18 @@ public:
     virtual std::list<CurrencyPair> getShortestPairsBetween(const T& from, const T& to) const;
 
 
+    // Id based interface, see Graph.h
+    virtual unsigned int getNumberOfVertexIds() const;
+
+    virtual T getVertexValue(unsigned int id) const;
+
+    virtual void addEdgeById(unsigned int fromId, unsigned int toId, double cost);
+
+    virtual double getWeightById(unsigned int fromId, unsigned int toId) const;
+
+    virtual void getOutgoingEdges(unsigned int fromId, std::vector< std::pair<unsigned int, double> >& edges) const;
+
+
 };
 
 
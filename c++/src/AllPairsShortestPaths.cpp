@@ -0,0 +1,837 @@
+// AllPairsShortestPaths.cpp
+// AllPairsShortestPaths Class Implementation
+
+#include "AllPairsShortestPaths.h"
+#include "PerfCounters.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <new>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KRYPTOS_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+// the kernels use +infinity for missing edges: inf + w stays inf, so the inner loop needs no INF checks
+static const double kInfinity = std::numeric_limits<double>::infinity();
+
+static const unsigned int B = AllPairsShortestPaths::kBlockSize;
+
+// Min-plus update of one tile: C[i][j] = min(C[i][j], A[i][k] + Bk[k][j]) for k, i, j in [0, kBlockSize).
+// The "dependent" kernels keep k as the outermost loop, so they are also correct when C aliases A or Bk
+// (the diagonal and pivot tiles). The "independent" kernels require C to be distinct from A and Bk, which lets them
+// keep a whole row of C in registers while k runs.
+typedef void (*TileKernel)(double* C, const double* A, const double* Bk, unsigned int stride);
+
+// Same update, also tracking the next hops: when A[i][k] + Bk[k][j] improves C[i][j], the route from i to j now starts
+// like the route from i to k, so nextC[i][j] = nextA[i][k]. Only improvements by more than kRelaxationEpsilon count,
+// like in Graph::computeShortestPathTree, so that cycles of rates whose logs cancel out up to rounding do not become
+// negative cycles and the routes stay free of loops
+typedef void (*RouteTileKernel)(double* C, uint32_t* nextC, const double* A, const uint32_t* nextA, const double* Bk,
+                                unsigned int stride);
+
+static void updateTileScalar(double* C, const double* A, const double* Bk, unsigned int stride)
+{
+    for (unsigned int k = 0; k < B; ++k) {
+        const double* pivotRow = Bk + (size_t) k * stride;
+
+        for (unsigned int i = 0; i < B; ++i) {
+            const double viaPivot = A[(size_t) i * stride + k];
+            if (viaPivot == kInfinity)
+                continue;
+
+            double* row = C + (size_t) i * stride;
+            for (unsigned int j = 0; j < B; ++j)
+                row[j] = std::min(row[j], viaPivot + pivotRow[j]);
+        }
+    }
+}
+
+static void updateIndependentTileScalar(double* C, const double* A, const double* Bk, unsigned int stride)
+{
+    for (unsigned int i = 0; i < B; ++i) {
+        double* row = C + (size_t) i * stride;
+        const double* viaRow = A + (size_t) i * stride;
+
+        for (unsigned int k = 0; k < B; ++k) {
+            const double viaPivot = viaRow[k];
+            if (viaPivot == kInfinity)
+                continue;
+
+            const double* pivotRow = Bk + (size_t) k * stride;
+            for (unsigned int j = 0; j < B; ++j)
+                row[j] = std::min(row[j], viaPivot + pivotRow[j]);
+        }
+    }
+}
+
+static void updateRouteTileScalar(double* C, uint32_t* nextC, const double* A, const uint32_t* nextA, const double* Bk,
+                                  unsigned int stride)
+{
+    for (unsigned int k = 0; k < B; ++k) {
+        const double* pivotRow = Bk + (size_t) k * stride;
+
+        for (unsigned int i = 0; i < B; ++i) {
+            const double viaPivot = A[(size_t) i * stride + k];
+            if (viaPivot == kInfinity)
+                continue;
+
+            const uint32_t hop = nextA[(size_t) i * stride + k];
+            double* row = C + (size_t) i * stride;
+            uint32_t* nextRow = nextC + (size_t) i * stride;
+
+            for (unsigned int j = 0; j < B; ++j) {
+                const double candidate = viaPivot + pivotRow[j];
+                if (candidate < row[j] - kRelaxationEpsilon) {
+                    row[j] = candidate;
+                    nextRow[j] = hop;
+                }
+            }
+        }
+    }
+}
+
+#ifdef KRYPTOS_X86_KERNELS
+
+__attribute__((target("sse2")))
+static void updateTileSSE2(double* C, const double* A, const double* Bk, unsigned int stride)
+{
+    for (unsigned int k = 0; k < B; ++k) {
+        const double* pivotRow = Bk + (size_t) k * stride;
+
+        for (unsigned int i = 0; i < B; ++i) {
+            const double viaPivot = A[(size_t) i * stride + k];
+            if (viaPivot == kInfinity)
+                continue;
+
+            const __m128d broadcast = _mm_set1_pd(viaPivot);
+            double* row = C + (size_t) i * stride;
+
+            for (unsigned int j = 0; j < B; j += 2) {
+                const __m128d candidate = _mm_add_pd(broadcast, _mm_load_pd(pivotRow + j));
+                _mm_store_pd(row + j, _mm_min_pd(_mm_load_pd(row + j), candidate));
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void updateTileAVX2(double* C, const double* A, const double* Bk, unsigned int stride)
+{
+    for (unsigned int k = 0; k < B; ++k) {
+        const double* pivotRow = Bk + (size_t) k * stride;
+
+        for (unsigned int i = 0; i < B; ++i) {
+            const double viaPivot = A[(size_t) i * stride + k];
+            if (viaPivot == kInfinity)
+                continue;
+
+            const __m256d broadcast = _mm256_set1_pd(viaPivot);
+            double* row = C + (size_t) i * stride;
+
+            for (unsigned int j = 0; j < B; j += 4) {
+                const __m256d candidate = _mm256_add_pd(broadcast, _mm256_load_pd(pivotRow + j));
+                _mm256_store_pd(row + j, _mm256_min_pd(_mm256_load_pd(row + j), candidate));
+            }
+        }
+    }
+}
+
+__attribute__((target("sse2")))
+static void updateIndependentTileSSE2(double* C, const double* A, const double* Bk, unsigned int stride)
+{
+    static const unsigned int kLanes = 2;
+
+    for (unsigned int i = 0; i < B; ++i) {
+        double* row = C + (size_t) i * stride;
+        const double* viaRow = A + (size_t) i * stride;
+
+        __m128d accumulators[B / kLanes];
+        for (unsigned int j = 0; j < B / kLanes; ++j)
+            accumulators[j] = _mm_load_pd(row + j * kLanes);
+
+        for (unsigned int k = 0; k < B; ++k) {
+            const double viaPivot = viaRow[k];
+            if (viaPivot == kInfinity)
+                continue;
+
+            const __m128d broadcast = _mm_set1_pd(viaPivot);
+            const double* pivotRow = Bk + (size_t) k * stride;
+
+            for (unsigned int j = 0; j < B / kLanes; ++j)
+                accumulators[j] = _mm_min_pd(accumulators[j], _mm_add_pd(broadcast, _mm_load_pd(pivotRow + j * kLanes)));
+        }
+
+        for (unsigned int j = 0; j < B / kLanes; ++j)
+            _mm_store_pd(row + j * kLanes, accumulators[j]);
+    }
+}
+
+__attribute__((target("avx2")))
+static void updateIndependentTileAVX2(double* C, const double* A, const double* Bk, unsigned int stride)
+{
+    static const unsigned int kLanes = 4;
+
+    for (unsigned int i = 0; i < B; ++i) {
+        double* row = C + (size_t) i * stride;
+        const double* viaRow = A + (size_t) i * stride;
+
+        // the row of C stays in registers for all k
+        __m256d accumulators[B / kLanes];
+        for (unsigned int j = 0; j < B / kLanes; ++j)
+            accumulators[j] = _mm256_load_pd(row + j * kLanes);
+
+        for (unsigned int k = 0; k < B; ++k) {
+            const double viaPivot = viaRow[k];
+            if (viaPivot == kInfinity)
+                continue;
+
+            const __m256d broadcast = _mm256_set1_pd(viaPivot);
+            const double* pivotRow = Bk + (size_t) k * stride;
+
+            for (unsigned int j = 0; j < B / kLanes; ++j)
+                accumulators[j] = _mm256_min_pd(accumulators[j], _mm256_add_pd(broadcast, _mm256_load_pd(pivotRow + j * kLanes)));
+        }
+
+        for (unsigned int j = 0; j < B / kLanes; ++j)
+            _mm256_store_pd(row + j * kLanes, accumulators[j]);
+    }
+}
+
+// improvements are rare once the first pivots are done, so the next hops are only touched when a lane improved
+__attribute__((target("avx2")))
+static inline void blendNextHops(uint32_t* nextRow, __m256d improved, __m128i hop)
+{
+    // the 64 bit lanes of the mask become 32 bit lanes, to match the next hops
+    const __m256i lowHalves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    const __m128i mask = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(improved), lowHalves));
+
+    __m128i* next = reinterpret_cast<__m128i*>(nextRow);
+    _mm_store_si128(next, _mm_blendv_epi8(_mm_load_si128(next), hop, mask));
+}
+
+__attribute__((target("avx2")))
+static void updateRouteTileAVX2(double* C, uint32_t* nextC, const double* A, const uint32_t* nextA, const double* Bk,
+                                unsigned int stride)
+{
+    for (unsigned int k = 0; k < B; ++k) {
+        const double* pivotRow = Bk + (size_t) k * stride;
+
+        for (unsigned int i = 0; i < B; ++i) {
+            const double viaPivot = A[(size_t) i * stride + k];
+            if (viaPivot == kInfinity)
+                continue;
+
+            const __m256d broadcast = _mm256_set1_pd(viaPivot);
+            const __m256d epsilon = _mm256_set1_pd(kRelaxationEpsilon);
+            const __m128i hop = _mm_set1_epi32((int) nextA[(size_t) i * stride + k]);
+            double* row = C + (size_t) i * stride;
+            uint32_t* nextRow = nextC + (size_t) i * stride;
+
+            for (unsigned int j = 0; j < B; j += 4) {
+                const __m256d candidate = _mm256_add_pd(broadcast, _mm256_load_pd(pivotRow + j));
+                const __m256d current = _mm256_load_pd(row + j);
+                const __m256d improved = _mm256_cmp_pd(candidate, _mm256_sub_pd(current, epsilon), _CMP_LT_OQ);
+
+                if (_mm256_movemask_pd(improved) != 0) {
+                    _mm256_store_pd(row + j, _mm256_blendv_pd(current, candidate, improved));
+                    blendNextHops(nextRow + j, improved, hop);
+                }
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void updateIndependentRouteTileAVX2(double* C, uint32_t* nextC, const double* A, const uint32_t* nextA,
+                                           const double* Bk, unsigned int stride)
+{
+    static const unsigned int kLanes = 4;
+
+    for (unsigned int i = 0; i < B; ++i) {
+        double* row = C + (size_t) i * stride;
+        uint32_t* nextRow = nextC + (size_t) i * stride;
+        const double* viaRow = A + (size_t) i * stride;
+        const uint32_t* hopRow = nextA + (size_t) i * stride;
+
+        const __m256d epsilon = _mm256_set1_pd(kRelaxationEpsilon);
+
+        // the distances of the row stay in registers, the next hops are written when a lane improves
+        __m256d accumulators[B / kLanes];
+        for (unsigned int j = 0; j < B / kLanes; ++j)
+            accumulators[j] = _mm256_load_pd(row + j * kLanes);
+
+        for (unsigned int k = 0; k < B; ++k) {
+            const double viaPivot = viaRow[k];
+            if (viaPivot == kInfinity)
+                continue;
+
+            const __m256d broadcast = _mm256_set1_pd(viaPivot);
+            const __m128i hop = _mm_set1_epi32((int) hopRow[k]);
+            const double* pivotRow = Bk + (size_t) k * stride;
+
+            for (unsigned int j = 0; j < B / kLanes; ++j) {
+                const __m256d candidate = _mm256_add_pd(broadcast, _mm256_load_pd(pivotRow + j * kLanes));
+                const __m256d improved = _mm256_cmp_pd(candidate, _mm256_sub_pd(accumulators[j], epsilon), _CMP_LT_OQ);
+
+                if (_mm256_movemask_pd(improved) != 0) {
+                    accumulators[j] = _mm256_blendv_pd(accumulators[j], candidate, improved);
+                    blendNextHops(nextRow + j * kLanes, improved, hop);
+                }
+            }
+        }
+
+        for (unsigned int j = 0; j < B / kLanes; ++j)
+            _mm256_store_pd(row + j * kLanes, accumulators[j]);
+    }
+}
+
+#endif
+
+struct KernelChoice {
+    TileKernel kernel;            // for tiles that alias the pivot tiles
+    TileKernel independentKernel; // for all other tiles
+    RouteTileKernel routeKernel;
+    RouteTileKernel independentRouteKernel;
+    const char* name;
+};
+
+// pick the widest kernel supported by the CPU we run on
+static KernelChoice chooseKernel()
+{
+#ifdef KRYPTOS_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return KernelChoice { updateTileAVX2, updateIndependentTileAVX2, updateRouteTileAVX2, updateIndependentRouteTileAVX2, "avx2" };
+    // without AVX2 the next hops are tracked by the scalar kernel, the scalar loop does the same for every tile
+    if (__builtin_cpu_supports("sse2"))
+        return KernelChoice { updateTileSSE2, updateIndependentTileSSE2, updateRouteTileScalar, updateRouteTileScalar, "sse2" };
+#endif
+    return KernelChoice { updateTileScalar, updateIndependentTileScalar, updateRouteTileScalar, updateRouteTileScalar, "scalar" };
+}
+
+static const KernelChoice& selectedKernel()
+{
+    static const KernelChoice choice = chooseKernel();
+    return choice;
+}
+
+
+// posix_memalign instead of aligned_alloc, which is C++17
+static void* allocateAligned(size_t bytes)
+{
+    void* memory = nullptr;
+    if (posix_memalign(&memory, 64, bytes) != 0)
+        throw std::bad_alloc();
+    return memory;
+}
+
+
+const uint32_t AllPairsShortestPaths::kNoRoute = UINT32_MAX;
+
+// Constructor
+AllPairsShortestPaths::AllPairsShortestPaths(unsigned int numberOfVertices, bool withRoutes) :
+        numberOfVertices(0), stride(0), withRoutes(withRoutes), distances(nullptr), nextHops(nullptr)
+{
+    reset(numberOfVertices);
+}
+
+AllPairsShortestPaths::AllPairsShortestPaths(const AllPairsShortestPaths& other) :
+        numberOfVertices(0), stride(0), withRoutes(other.withRoutes), distances(nullptr), nextHops(nullptr)
+{
+    *this = other;
+}
+
+AllPairsShortestPaths& AllPairsShortestPaths::operator=(const AllPairsShortestPaths& other)
+{
+    if (this != &other) {
+        forgetBorrowedMemory();
+
+        if (withRoutes != other.withRoutes) {
+            // force allocate() to set up the next hop matrix, or to drop it
+            std::free(nextHops);
+            nextHops = nullptr;
+            withRoutes = other.withRoutes;
+            stride = 0;
+        }
+
+        allocate(other.numberOfVertices);
+        std::memcpy(distances, other.distances, (size_t) stride * stride * sizeof(double));
+        if (withRoutes)
+            std::memcpy(nextHops, other.nextHops, (size_t) stride * stride * sizeof(uint32_t));
+    }
+
+    return *this;
+}
+
+AllPairsShortestPaths::~AllPairsShortestPaths()
+{
+    forgetBorrowedMemory();
+
+    std::free(distances);
+    std::free(nextHops);
+}
+
+std::shared_ptr<const AllPairsShortestPaths> AllPairsShortestPaths::borrow(unsigned int numberOfVertices, const double* distances,
+                                                                           const uint32_t* nextHops, std::shared_ptr<const void> owner)
+{
+    std::shared_ptr<AllPairsShortestPaths> borrowed = std::make_shared<AllPairsShortestPaths>(0, nextHops != nullptr);
+
+    // the object stays const for its users, nothing writes through these
+    borrowed->numberOfVertices = numberOfVertices;
+    borrowed->stride = (numberOfVertices + B - 1) / B * B;
+    borrowed->distances = const_cast<double*>(distances);
+    borrowed->nextHops = const_cast<uint32_t*>(nextHops);
+    borrowed->borrowedMemory = std::move(owner);
+
+    return borrowed;
+}
+
+void AllPairsShortestPaths::forgetBorrowedMemory()
+{
+    if (!borrowedMemory)
+        return;
+
+    distances = nullptr;
+    nextHops = nullptr;
+    numberOfVertices = 0;
+    stride = 0;
+    borrowedMemory.reset();
+}
+
+void AllPairsShortestPaths::allocate(unsigned int vertices)
+{
+    forgetBorrowedMemory();
+
+    const unsigned int newStride = (vertices + B - 1) / B * B;
+
+    if (newStride != stride || (withRoutes && nextHops == nullptr && newStride > 0)) {
+        std::free(distances);
+        std::free(nextHops);
+        distances = nullptr;
+        nextHops = nullptr;
+
+        if (newStride > 0) {
+            const size_t elements = (size_t) newStride * newStride;
+            distances = static_cast<double*>(allocateAligned(elements * sizeof(double)));
+            if (withRoutes)
+                nextHops = static_cast<uint32_t*>(allocateAligned(elements * sizeof(uint32_t)));
+        }
+    }
+
+    numberOfVertices = vertices;
+    stride = newStride;
+}
+
+void AllPairsShortestPaths::reset(unsigned int vertices)
+{
+    allocate(vertices);
+
+    std::fill(distances, distances + (size_t) stride * stride, kInfinity);
+    for (unsigned int i = 0; i < numberOfVertices; ++i)
+        distances[(size_t) i * stride + i] = 0;
+
+    if (withRoutes) {
+        std::fill(nextHops, nextHops + (size_t) stride * stride, kNoRoute);
+        for (unsigned int i = 0; i < numberOfVertices; ++i)
+            nextHops[(size_t) i * stride + i] = i;
+    }
+}
+
+void AllPairsShortestPaths::setWeight(unsigned int from, unsigned int to, double weight)
+{
+    const size_t index = (size_t) from * stride + to;
+    distances[index] = (weight == INF) ? kInfinity : weight;
+
+    if (withRoutes && from != to)
+        nextHops[index] = (weight == INF) ? kNoRoute : to;
+}
+
+
+/*! compute - blocked Floyd-Warshall
+ *
+ * For every pivot tile kb:
+ * 1. the diagonal tile (kb, kb) is updated with itself
+ * 2. the tiles in pivot row kb and pivot column kb are updated with the diagonal tile
+ * 3. every other tile (i, j) is updated with the tiles (i, kb) and (kb, j)
+ *
+ * The tiles of phases 2 and 3 only read tiles that the phase does not write, so they are spread over the threads of
+ * the pool. Every tile is still updated by the same kernel in the same order, the result is identical to the serial run
+ *
+ * With routes, the next hop tiles are updated along with the distance tiles by the route kernels
+ */
+void AllPairsShortestPaths::compute(ThreadPool* pool)
+{
+    PerfCounters::Scope perfScope("floydWarshall");
+    const KernelChoice& kernels = selectedKernel();
+    const unsigned int numberOfBlocks = stride / B;
+
+    // offset of the top left element of tile (row, column)
+    auto offset = [this](unsigned int row, unsigned int column) {
+        return (size_t) row * B * stride + (size_t) column * B;
+    };
+
+    auto tile = [&](unsigned int row, unsigned int column) {
+        return distances + offset(row, column);
+    };
+
+    // C is updated with A and Bk, in the order of the parameters of TileKernel
+    auto updateTile = [&](unsigned int cRow, unsigned int cColumn, unsigned int aRow, unsigned int aColumn,
+                          unsigned int bRow, unsigned int bColumn) {
+        if (withRoutes)
+            kernels.routeKernel(tile(cRow, cColumn), nextHops + offset(cRow, cColumn),
+                                tile(aRow, aColumn), nextHops + offset(aRow, aColumn), tile(bRow, bColumn), stride);
+        else
+            kernels.kernel(tile(cRow, cColumn), tile(aRow, aColumn), tile(bRow, bColumn), stride);
+    };
+
+    auto updateIndependentTile = [&](unsigned int row, unsigned int column, unsigned int kb) {
+        if (withRoutes)
+            kernels.independentRouteKernel(tile(row, column), nextHops + offset(row, column),
+                                           tile(row, kb), nextHops + offset(row, kb), tile(kb, column), stride);
+        else
+            kernels.independentKernel(tile(row, column), tile(row, kb), tile(kb, column), stride);
+    };
+
+    for (unsigned int kb = 0; kb < numberOfBlocks; ++kb) {
+        updateTile(kb, kb, kb, kb, kb, kb);
+
+        // phase 2: tile 2b is in the pivot row, tile 2b + 1 in the pivot column (b skips the pivot)
+        auto updatePivotRowAndColumn = [&](size_t task) {
+            const unsigned int b = (unsigned int) (task / 2) + (task / 2 >= kb ? 1 : 0);
+
+            if (task % 2 == 0)
+                updateTile(kb, b, kb, kb, kb, b);
+            else
+                updateTile(b, kb, b, kb, kb, kb);
+        };
+
+        // phase 3: one task per tile outside of the pivot row and column
+        auto updateRemainingTile = [&](size_t task) {
+            const unsigned int ib = (unsigned int) (task / (numberOfBlocks - 1));
+            const unsigned int jb = (unsigned int) (task % (numberOfBlocks - 1));
+            const unsigned int row = ib + (ib >= kb ? 1 : 0);
+            const unsigned int column = jb + (jb >= kb ? 1 : 0);
+
+            updateIndependentTile(row, column, kb);
+        };
+
+        const size_t otherBlocks = numberOfBlocks - 1;
+        if (pool != nullptr) {
+            pool->parallelFor(2 * otherBlocks, updatePivotRowAndColumn);
+            pool->parallelFor(otherBlocks * otherBlocks, updateRemainingTile);
+        } else {
+            for (size_t task = 0; task < 2 * otherBlocks; ++task)
+                updatePivotRowAndColumn(task);
+            for (size_t task = 0; task < otherBlocks * otherBlocks; ++task)
+                updateRemainingTile(task);
+        }
+    }
+}
+
+
+std::vector<AllPairsShortestPaths::EdgeChange> AllPairsShortestPaths::coalesce(const std::vector<EdgeChange>& changes)
+{
+    std::vector<EdgeChange> merged(changes);
+
+    // stable, so the changes of one edge stay in the order they were made
+    std::stable_sort(merged.begin(), merged.end(), [](const EdgeChange& a, const EdgeChange& b) {
+        return a.from < b.from || (a.from == b.from && a.to < b.to);
+    });
+
+    size_t last = 0;
+    for (size_t i = 0; i < merged.size(); ++i) {
+        if (merged[i].from == merged[i].to)
+            continue; // the distance of a vertex to itself stays 0
+
+        if (last > 0 && merged[last - 1].from == merged[i].from && merged[last - 1].to == merged[i].to)
+            merged[last - 1].newWeight = merged[i].newWeight;
+        else
+            merged[last++] = merged[i];
+    }
+    merged.resize(last);
+
+    return merged;
+}
+
+unsigned long AllPairsShortestPaths::markPairsUsingEdges(const std::vector<EdgeChange>& increases,
+                                                        std::vector< std::vector<unsigned int> >& affectedTargets,
+                                                        ThreadPool* pool) const
+{
+    affectedTargets.assign(numberOfVertices, std::vector<unsigned int>());
+
+    if (increases.empty())
+        return 0;
+
+    auto markRow = [&](size_t i) {
+        const double* row = distances + (size_t) i * stride;
+        std::vector<char> marked(numberOfVertices, 0);
+
+        // the distance of the source to itself stays 0
+        marked[i] = 1;
+
+        for (auto& change : increases) {
+            if (change.oldWeight == INF)
+                continue; // the edge did not exist, so nothing went through it
+
+            // a route through the edge to any target goes through it to 'to' first
+            const double viaEdge = row[change.from] + change.oldWeight;
+            if (viaEdge == kInfinity || viaEdge > row[change.to] + kRelaxationEpsilon)
+                continue;
+
+            // with a tolerance, so that routes that tie with the edge are searched again as well
+            const double* rowOfTo = distances + (size_t) change.to * stride;
+            for (unsigned int j = 0; j < numberOfVertices; ++j) {
+                if (!marked[j] && rowOfTo[j] != kInfinity && viaEdge + rowOfTo[j] <= row[j] + kRelaxationEpsilon) {
+                    marked[j] = 1;
+                    affectedTargets[i].push_back(j);
+                }
+            }
+        }
+    };
+
+    if (pool != nullptr)
+        pool->parallelFor(numberOfVertices, markRow);
+    else
+        for (unsigned int i = 0; i < numberOfVertices; ++i)
+            markRow(i);
+
+    unsigned long affectedPairs = 0;
+    for (auto& targets : affectedTargets)
+        affectedPairs += targets.size();
+
+    return affectedPairs;
+}
+
+void AllPairsShortestPaths::repairPairs(const std::vector< std::vector<unsigned int> >& affectedTargets,
+                                        const std::vector<EdgeChange>& decreases, Adjacency& outgoingEdges,
+                                        ThreadPool* pool)
+{
+    const unsigned int V = numberOfVertices;
+
+    // back to the old weights, edges that did not exist get an infinite one
+    for (auto& change : decreases) {
+        const unsigned int* begin = outgoingEdges.targets.data() + outgoingEdges.offsets[change.from];
+        const unsigned int* end = outgoingEdges.targets.data() + outgoingEdges.offsets[change.from + 1];
+
+        for (const unsigned int* target = begin; target != end; ++target)
+            if (*target == change.to)
+                outgoingEdges.weights[target - outgoingEdges.targets.data()] =
+                        (change.oldWeight == INF) ? kInfinity : change.oldWeight;
+    }
+
+    // the searches start from the edges coming into the marked targets
+    Adjacency incomingEdges;
+    incomingEdges.offsets.assign(V + 1, 0);
+    for (unsigned int e = 0; e < outgoingEdges.targets.size(); ++e)
+        ++incomingEdges.offsets[outgoingEdges.targets[e] + 1];
+    for (unsigned int v = 0; v < V; ++v)
+        incomingEdges.offsets[v + 1] += incomingEdges.offsets[v];
+
+    incomingEdges.targets.resize(outgoingEdges.targets.size());
+    incomingEdges.weights.resize(outgoingEdges.targets.size());
+    std::vector<unsigned int> position(incomingEdges.offsets.begin(), incomingEdges.offsets.end() - 1);
+    for (unsigned int from = 0; from < V; ++from) {
+        for (unsigned int e = outgoingEdges.offsets[from]; e < outgoingEdges.offsets[from + 1]; ++e) {
+            const unsigned int slot = position[outgoingEdges.targets[e]]++;
+            incomingEdges.targets[slot] = from;
+            incomingEdges.weights[slot] = outgoingEdges.weights[e];
+        }
+    }
+
+    auto repairRow = [&](size_t source) {
+        const std::vector<unsigned int>& targets = affectedTargets[source];
+        if (targets.empty())
+            return;
+
+        double* row = distances + (size_t) source * stride;
+        uint32_t* nextRow = withRoutes ? nextHops + (size_t) source * stride : nullptr;
+
+        // the routes to the other targets did not use the changed edges, so their distances stay valid
+        std::vector<char> affected(V, 0);
+        for (unsigned int j : targets) {
+            affected[j] = 1;
+            row[j] = kInfinity;
+            if (withRoutes)
+                nextRow[j] = kNoRoute;
+        }
+
+        // best way into every marked target straight from a target that stays valid
+        std::deque<unsigned int> queue;
+        std::vector<bool> inQueue(V, false);
+        for (unsigned int j : targets) {
+            for (unsigned int e = incomingEdges.offsets[j]; e < incomingEdges.offsets[j + 1]; ++e) {
+                const unsigned int from = incomingEdges.targets[e];
+                const double candidate = row[from] + incomingEdges.weights[e];
+
+                if (!affected[from] && row[from] != kInfinity && candidate < row[j]) {
+                    row[j] = candidate;
+                    if (withRoutes)
+                        nextRow[j] = (from == source) ? j : nextRow[from];
+                }
+            }
+
+            if (row[j] != kInfinity) {
+                queue.push_back(j);
+                inQueue[j] = true;
+            }
+        }
+
+        // then SPFA among the marked targets, a target queued more often than there are targets is behind a
+        // negative cycle, and the distances found so far are kept
+        std::vector<unsigned int> timesQueued(V, 0);
+        bool negativeCycle = false;
+
+        while (!queue.empty() && !negativeCycle) {
+            const unsigned int u = queue.front();
+            queue.pop_front();
+            inQueue[u] = false;
+
+            for (unsigned int e = outgoingEdges.offsets[u]; e < outgoingEdges.offsets[u + 1]; ++e) {
+                const unsigned int v = outgoingEdges.targets[e];
+                const double candidate = row[u] + outgoingEdges.weights[e];
+
+                if (affected[v] && candidate < row[v] - kRelaxationEpsilon) {
+                    row[v] = candidate;
+                    if (withRoutes)
+                        nextRow[v] = nextRow[u];
+
+                    if (!inQueue[v]) {
+                        if (++timesQueued[v] > targets.size()) {
+                            negativeCycle = true;
+                            break;
+                        }
+
+                        queue.push_back(v);
+                        inQueue[v] = true;
+                    }
+                }
+            }
+        }
+    };
+
+    if (pool != nullptr)
+        pool->parallelFor(V, repairRow);
+    else
+        for (unsigned int source = 0; source < V; ++source)
+            repairRow(source);
+}
+
+void AllPairsShortestPaths::decreaseEdge(unsigned int from, unsigned int to, double weight, ThreadPool* pool)
+{
+    if (from == to || weight == INF)
+        return;
+
+    // copy of the row of 'to', which can change while the rows are updated
+    const std::vector<double> rowOfTo(distances + (size_t) to * stride, distances + (size_t) to * stride + numberOfVertices);
+
+    auto updateRow = [&](size_t i) {
+        double* row = distances + (size_t) i * stride;
+        const double viaEdge = row[from] + weight;
+
+        // if the edge is no shortcut to 'to', it is none to anything behind 'to' either
+        if (viaEdge == kInfinity || !(viaEdge < row[to] - kRelaxationEpsilon))
+            return;
+
+        uint32_t* nextRow = withRoutes ? nextHops + (size_t) i * stride : nullptr;
+        const uint32_t hop = (i == from) ? to : (withRoutes ? nextRow[from] : kNoRoute);
+
+        for (unsigned int j = 0; j < numberOfVertices; ++j) {
+            const double candidate = viaEdge + rowOfTo[j];
+            if (candidate < row[j] - kRelaxationEpsilon) {
+                row[j] = candidate;
+                if (withRoutes)
+                    nextRow[j] = hop;
+            }
+        }
+    };
+
+    if (pool != nullptr)
+        pool->parallelFor(numberOfVertices, updateRow);
+    else
+        for (unsigned int i = 0; i < numberOfVertices; ++i)
+            updateRow(i);
+}
+
+
+// Getters
+unsigned int AllPairsShortestPaths::getNumberOfVertices() const
+{
+    return numberOfVertices;
+}
+
+double AllPairsShortestPaths::getDistance(unsigned int from, unsigned int to) const
+{
+    const double distance = distances[(size_t) from * stride + to];
+    return (distance == kInfinity) ? INF : distance;
+}
+
+std::vector< std::vector<double> > AllPairsShortestPaths::toMatrix() const
+{
+    std::vector< std::vector<double> > matrix(numberOfVertices, std::vector<double>(numberOfVertices));
+
+    for (unsigned int i = 0; i < numberOfVertices; ++i)
+        for (unsigned int j = 0; j < numberOfVertices; ++j)
+            matrix[i][j] = getDistance(i, j);
+
+    return matrix;
+}
+
+bool AllPairsShortestPaths::hasRoutes() const
+{
+    return withRoutes;
+}
+
+unsigned int AllPairsShortestPaths::getStride() const
+{
+    return stride;
+}
+
+const double* AllPairsShortestPaths::getDistanceMatrix() const
+{
+    return distances;
+}
+
+const uint32_t* AllPairsShortestPaths::getNextHopMatrix() const
+{
+    return nextHops;
+}
+
+uint32_t AllPairsShortestPaths::getNextHop(unsigned int from, unsigned int to) const
+{
+    return nextHops[(size_t) from * stride + to];
+}
+
+bool AllPairsShortestPaths::getRoute(unsigned int from, unsigned int to, std::vector<unsigned int>& route) const
+{
+    route.clear();
+
+    if (getNextHop(from, to) == kNoRoute)
+        return false;
+
+    route.push_back(from);
+
+    // a shortest route visits every vertex at most once, a longer walk means the route runs into a negative cycle
+    for (unsigned int current = from; current != to; ) {
+        current = getNextHop(current, to);
+
+        if (current == kNoRoute || route.size() > numberOfVertices) {
+            route.clear();
+            return false;
+        }
+
+        route.push_back(current);
+    }
+
+    return true;
+}
+
+const char* AllPairsShortestPaths::getKernelName()
+{
+    return selectedKernel().name;
+}
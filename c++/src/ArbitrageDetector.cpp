@@ -0,0 +1,162 @@
+// ArbitrageDetector.cpp
+// ArbitrageDetector Class Implementation
+
+#include "ArbitrageDetector.h"
+
+#include <algorithm>
+
+void ArbitrageDetector::enqueue(unsigned int vertex)
+{
+    if (!inQueue[vertex]) {
+        inQueue[vertex] = true;
+        queue.push_back(vertex);
+    }
+}
+
+void ArbitrageDetector::resize(unsigned int numberOfVertices)
+{
+    const unsigned int oldNumberOfVertices = (unsigned int) potentials.size();
+    if (numberOfVertices <= oldNumberOfVertices)
+        return;
+
+    potentials.resize(numberOfVertices, 0);
+    parents.resize(numberOfVertices, -1);
+    isTouched.resize(numberOfVertices, false);
+    neutralizedTargets.resize(numberOfVertices);
+    inQueue.resize(numberOfVertices, false);
+    walkOf.resize(numberOfVertices, -1);
+
+    for (unsigned int vertex = oldNumberOfVertices; vertex < numberOfVertices; ++vertex)
+        enqueue(vertex);
+}
+
+
+
+std::vector<unsigned int> ArbitrageDetector::traceCycle(unsigned int vertex) const
+{
+    // parents point backwards, so reverse to get the edges
+    std::vector<unsigned int> cycle;
+    unsigned int onCycle = vertex;
+    do {
+        cycle.push_back(onCycle);
+        onCycle = (unsigned int) parents[onCycle];
+    } while (onCycle != vertex);
+
+    std::reverse(cycle.begin(), cycle.end());
+    std::rotate(cycle.begin(), std::min_element(cycle.begin(), cycle.end()), cycle.end());
+
+    return cycle;
+}
+
+bool ArbitrageDetector::isCloseAncestor(unsigned int vertex, unsigned int descendant) const
+{
+    int ancestor = (int) descendant;
+    for (unsigned int steps = 0; steps < kShortCycleLength && ancestor >= 0; ++steps) {
+        if (ancestor == (int) vertex)
+            return true;
+        ancestor = parents[ancestor];
+    }
+
+    return false;
+}
+
+
+
+/*! findParentCycles - cycles of the parent pointers
+ *
+ * Every vertex has at most one parent, so each walk along the parents either ends or runs into a cycle.
+ * Walks are colored by the vertex they started from, a walk that meets its own color closed a cycle.
+ * Only touched vertices have parents, so O(touched)
+ */
+bool ArbitrageDetector::findParentCycles(std::vector< std::vector<unsigned int> >& found) const
+{
+    bool any = false;
+
+    for (unsigned int start : touched) {
+        int vertex = (int) start;
+        while (vertex >= 0 && walkOf[vertex] < 0) {
+            walkOf[vertex] = (int) start;
+            vertex = parents[vertex];
+        }
+
+        if (vertex < 0 || walkOf[vertex] != (int) start)
+            continue;
+
+        found.push_back(traceCycle((unsigned int) vertex));
+        any = true;
+    }
+
+    // walks also end on the roots, which have no parent and may not be touched themselves
+    for (unsigned int vertex : touched) {
+        walkOf[vertex] = -1;
+        if (parents[vertex] >= 0)
+            walkOf[parents[vertex]] = -1;
+    }
+
+    return any;
+}
+
+/*! neutralize - leave the edges of a cycle out of the search
+ *
+ * The parent pointers of the cycle all follow its edges, so they are cut as well: the vertices become roots and the
+ * cycle is not found again
+ */
+void ArbitrageDetector::neutralize(const std::vector<unsigned int>& cycle)
+{
+    for (size_t i = 0; i < cycle.size(); ++i) {
+        const unsigned int from = cycle[i];
+        const unsigned int to = cycle[(i + 1) % cycle.size()];
+
+        if (!isNeutralized(from, to)) {
+            if (neutralizedTargets[from].empty())
+                neutralizedSources.push_back(from);
+            neutralizedTargets[from].push_back(to);
+        }
+
+        if (parents[to] == (int) from)
+            parents[to] = -1;
+    }
+}
+
+bool ArbitrageDetector::isNeutralized(unsigned int from, unsigned int to) const
+{
+    const std::vector<unsigned int>& targets = neutralizedTargets[from];
+    return std::find(targets.begin(), targets.end(), to) != targets.end();
+}
+
+void ArbitrageDetector::resetSearch()
+{
+    for (unsigned int vertex : neutralizedSources)
+        neutralizedTargets[vertex].clear();
+    neutralizedSources.clear();
+
+    for (unsigned int vertex : touched) {
+        parents[vertex] = -1;
+        isTouched[vertex] = false;
+    }
+    touched.clear();
+}
+
+void ArbitrageDetector::touch(unsigned int vertex, unsigned int parent)
+{
+    if (!isTouched[vertex]) {
+        isTouched[vertex] = true;
+        touched.push_back(vertex);
+    }
+
+    parents[vertex] = (int) parent;
+}
+
+const std::vector<ArbitrageDetector::Cycle>& ArbitrageDetector::getCycles() const
+{
+    return cycles;
+}
+
+void ArbitrageDetector::sortByWeight(std::vector<Cycle>& cycles)
+{
+    std::sort(cycles.begin(), cycles.end(), [](const Cycle& a, const Cycle& b) {
+        if (a.weight != b.weight)
+            return a.weight < b.weight;
+        return a.vertices < b.vertices;
+    });
+}
@@ -0,0 +1,104 @@
+// ChunkedFileReader.cpp
+// ChunkedFileReader Class Implementation
+
+#include "ChunkedFileReader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+const size_t ChunkedFileReader::kDefaultChunkSize = 1 << 20;
+
+// Constructor
+ChunkedFileReader::ChunkedFileReader(const std::string& fileName, size_t chunkSize) :
+        fd(-1), buffer(chunkSize > 0 ? chunkSize : 1), filled(0), consumed(0), endOfFile(false)
+{
+    fd = ::open(fileName.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        error = "could not open '" + fileName + "': " + std::strerror(errno);
+        return;
+    }
+
+    // read ahead more aggressively, only a hint: macOS has no posix_fadvise
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+ChunkedFileReader::~ChunkedFileReader()
+{
+    if (fd >= 0)
+        close(fd);
+}
+
+bool ChunkedFileReader::nextLines(const char*& data, size_t& length)
+{
+    if (fd < 0)
+        return false;
+
+    // move the cut off line to the front
+    if (consumed > 0) {
+        std::memmove(buffer.data(), buffer.data() + consumed, filled - consumed);
+        filled -= consumed;
+        consumed = 0;
+    }
+
+    for (;;) {
+        if (!endOfFile && filled < buffer.size()) {
+            const ssize_t bytesRead = read(fd, buffer.data() + filled, buffer.size() - filled);
+
+            if (bytesRead < 0) {
+                if (errno == EINTR)
+                    continue;
+
+                error = std::string("could not read: ") + std::strerror(errno);
+                return false;
+            }
+
+            endOfFile = (bytesRead == 0);
+            filled += (size_t) bytesRead;
+        }
+
+        if (endOfFile) {
+            // whatever is left is the last line, with or without its newline
+            if (filled == 0)
+                return false;
+
+            data = buffer.data();
+            length = filled;
+            consumed = filled;
+            return true;
+        }
+
+        // memrchr is a GNU extension, scan backwards with the reverse iterators instead
+        const std::reverse_iterator<const char*> filledEnd(buffer.data());
+        const std::reverse_iterator<const char*> lastNewline =
+                std::find(std::reverse_iterator<const char*>(buffer.data() + filled), filledEnd, '\n');
+        if (lastNewline != filledEnd && filled == buffer.size()) {
+            data = buffer.data();
+            length = (size_t) (lastNewline.base() - buffer.data());
+            consumed = length;
+            return true;
+        }
+
+        // a line longer than the buffer
+        if (filled == buffer.size())
+            buffer.resize(buffer.size() * 2);
+    }
+}
+
+// Getters
+bool ChunkedFileReader::isOpen() const
+{
+    return fd >= 0;
+}
+
+const std::string& ChunkedFileReader::getError() const
+{
+    return error;
+}
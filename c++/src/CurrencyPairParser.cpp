@@ -3,6 +3,22 @@
 // Author: Antonio G. Bares Jr.
 
 #include "CurrencyPairParser.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// powers of ten that are exact doubles
+static const double kExactPowersOfTen[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// largest integer up to which every integer is an exact double
+static const uint64_t kMaxExactInteger = (uint64_t) 1 << 53;
 
 // Utilities
 CurrencyPair CurrencyPairParser::parseLine(const std::string& line)
@@ -32,7 +48,7 @@ std::list<CurrencyPair> CurrencyPairParser::parseFileAndGetListOfCurrencies(cons
     inputFile.open(fileName, std::fstream::in);
     
     if(!inputFile.is_open())
-        std::cout << "File could not be opened!" << std::endl;
+        KRYPTOS_TRACE(kError, kParser, "parseFileAndGetListOfCurrencies", fileName + " could not be opened");
 
     else
     {
@@ -48,4 +64,149 @@ std::list<CurrencyPair> CurrencyPairParser::parseFileAndGetListOfCurrencies(cons
     }
     
     return newList;
-}
\ No newline at end of file
+}
+
+
+// Zero-copy mode
+bool CurrencyPairParser::parseMappedFile(const std::string& fileName, MappedFile& file, std::vector<ParsedRate>& rates,
+                                         std::vector<ParseError>& errors) const
+{
+    if (!file.map(fileName)) {
+        errors.push_back({0, file.getError()});
+        return false;
+    }
+
+    // size the output from the lines in the first 64kB, so it is not copied over and over while it grows
+    const size_t sampleSize = std::min(file.getSize(), (size_t) 65536);
+    const size_t sampleLines = (size_t) std::count(file.getData(), file.getData() + sampleSize, '\n');
+    if (sampleLines > 0)
+        rates.reserve(rates.size() + file.getSize() / sampleSize * sampleLines * 9 / 8 + sampleLines);
+
+    parseBuffer(file.getData(), file.getSize(), rates, errors);
+    return true;
+}
+
+size_t CurrencyPairParser::parseBuffer(const char* data, size_t length, std::vector<ParsedRate>& rates,
+                                       std::vector<ParseError>& errors) const
+{
+    const size_t numberOfRates = rates.size();
+
+    forEachRate(data, length,
+                [&](const ParsedRate& rate) { rates.push_back(rate); },
+                [&](const ParseError& error) { errors.push_back(error); });
+
+    return rates.size() - numberOfRates;
+}
+
+bool CurrencyPairParser::parseLine(const char* line, const char* lineEnd, ParsedRate& rate, std::string& error)
+{
+    const char* firstComma = static_cast<const char*>(std::memchr(line, ',', (size_t) (lineEnd - line)));
+    const char* secondComma = (firstComma == nullptr) ? nullptr :
+            static_cast<const char*>(std::memchr(firstComma + 1, ',', (size_t) (lineEnd - firstComma - 1)));
+
+    if (secondComma == nullptr)
+        error = "expected \"from,to,price\"";
+
+    else if (firstComma == line || secondComma == firstComma + 1)
+        error = "empty currency symbol";
+
+    else if (!parseNumber(secondComma + 1, lineEnd, rate.price))
+        error = "invalid price '" + std::string(secondComma + 1, lineEnd) + "'";
+
+    else {
+        rate.from = {line, (size_t) (firstComma - line)};
+        rate.to = {firstComma + 1, (size_t) (secondComma - firstComma - 1)};
+        return true;
+    }
+
+    return false;
+}
+
+// append the digits at p to the mantissa. Up to 19 significant digits fit, the ones after that only set 'truncated'.
+// Fraction digits lower the exponent, integer digits that do not fit raise it
+static inline const char* parseDigits(const char* p, const char* end, bool fraction, uint64_t& mantissa,
+                                      int& numberOfDigits, int& exponent, bool& truncated)
+{
+    for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+        if (numberOfDigits < 19) {
+            mantissa = mantissa * 10 + (uint64_t) (*p - '0');
+            numberOfDigits += (mantissa != 0); // leading zeros are not significant
+            exponent -= fraction ? 1 : 0;
+        }
+        else {
+            exponent += fraction ? 0 : 1;
+            truncated = truncated || *p != '0';
+        }
+    }
+
+    return p;
+}
+
+bool CurrencyPairParser::parseNumber(const char* begin, const char* end, double& value)
+{
+    // blanks around the number are allowed, as they were by std::stod
+    while (begin != end && (*begin == ' ' || *begin == '\t'))
+        ++begin;
+    while (end != begin && (end[-1] == ' ' || end[-1] == '\t'))
+        --end;
+
+    const char* p = begin;
+
+    const bool negative = (p != end && *p == '-');
+    if (p != end && (*p == '-' || *p == '+'))
+        ++p;
+
+    // up to 19 significant digits fit in the mantissa, more make the fast path inexact
+    uint64_t mantissa = 0;
+    int numberOfDigits = 0;
+    int exponent = 0;
+    bool truncated = false;
+
+    const char* digits = p;
+    p = parseDigits(p, end, false, mantissa, numberOfDigits, exponent, truncated);
+    bool anyDigits = (p != digits);
+
+    if (p != end && *p == '.') {
+        digits = ++p;
+        p = parseDigits(p, end, true, mantissa, numberOfDigits, exponent, truncated);
+        anyDigits = anyDigits || (p != digits);
+    }
+
+    if (!anyDigits)
+        return false;
+
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        const bool negativeExponent = (p != end && *p == '-');
+        if (p != end && (*p == '-' || *p == '+'))
+            ++p;
+
+        if (p == end || *p < '0' || *p > '9')
+            return false;
+
+        int explicitExponent = 0;
+        for (; p != end && *p >= '0' && *p <= '9'; ++p)
+            if (explicitExponent < 100000)
+                explicitExponent = explicitExponent * 10 + (*p - '0');
+
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+
+    if (p != end)
+        return false;
+
+    // both the mantissa and the power of ten are exact, so one rounding gives the correctly rounded result
+    if (!truncated && mantissa <= kMaxExactInteger && exponent >= -22 && exponent <= 22) {
+        const double magnitude = (exponent < 0) ? (double) mantissa / kExactPowersOfTen[-exponent]
+                                                : (double) mantissa * kExactPowersOfTen[exponent];
+        value = negative ? -magnitude : magnitude;
+        return true;
+    }
+
+    // strtod needs a terminated copy
+    const std::string text(begin, end);
+    value = std::strtod(text.c_str(), nullptr);
+
+    // numbers too large for a double come back as infinity, which is no price
+    return std::isfinite(value);
+}
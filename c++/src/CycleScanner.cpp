@@ -0,0 +1,399 @@
+// CycleScanner.cpp
+// CycleScanner Class Implementation
+
+#include "CycleScanner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KRYPTOS_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+// widest vector of the kernels, in doubles. Rows are padded with 0 rates to a multiple of it
+static const unsigned int kLanes = 4;
+
+// anchors handed to a thread at a time, each group keeps its own top N
+static const unsigned int kAnchorsPerGroup = 16;
+
+// Products of two rows: hits[n++] = j for every j in [begin, end) where scale * (x[j] * y[j]) > threshold.
+// begin and end are multiples of kLanes. Returns the number of hits
+typedef unsigned int (*ProductKernel)(const double* x, const double* y, double scale, double threshold,
+                                      unsigned int begin, unsigned int end, unsigned int* hits);
+
+static unsigned int findProductsAboveScalar(const double* x, const double* y, double scale, double threshold,
+                                            unsigned int begin, unsigned int end, unsigned int* hits)
+{
+    unsigned int numberOfHits = 0;
+    for (unsigned int j = begin; j < end; ++j) {
+        if (scale * (x[j] * y[j]) > threshold)
+            hits[numberOfHits++] = j;
+    }
+
+    return numberOfHits;
+}
+
+#ifdef KRYPTOS_X86_KERNELS
+
+__attribute__((target("avx2")))
+static unsigned int findProductsAboveAVX2(const double* x, const double* y, double scale, double threshold,
+                                          unsigned int begin, unsigned int end, unsigned int* hits)
+{
+    const __m256d scales = _mm256_set1_pd(scale);
+    const __m256d thresholds = _mm256_set1_pd(threshold);
+
+    unsigned int numberOfHits = 0;
+    for (unsigned int j = begin; j < end; j += kLanes) {
+        const __m256d products = _mm256_mul_pd(scales, _mm256_mul_pd(_mm256_loadu_pd(x + j), _mm256_loadu_pd(y + j)));
+
+        // almost every lane is below, the hits are written out one bit of the mask at a time
+        int above = _mm256_movemask_pd(_mm256_cmp_pd(products, thresholds, _CMP_GT_OQ));
+        while (above != 0) {
+            hits[numberOfHits++] = j + (unsigned int) __builtin_ctz((unsigned int) above);
+            above &= above - 1;
+        }
+    }
+
+    return numberOfHits;
+}
+
+#endif
+
+struct KernelChoice {
+    ProductKernel kernel;
+    const char* name;
+};
+
+// pick the widest kernel supported by the CPU we run on
+static KernelChoice chooseKernel()
+{
+#ifdef KRYPTOS_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return KernelChoice { findProductsAboveAVX2, "avx2" };
+#endif
+    return KernelChoice { findProductsAboveScalar, "scalar" };
+}
+
+static const KernelChoice& selectedKernel()
+{
+    static const KernelChoice choice = chooseKernel();
+    return choice;
+}
+
+namespace {
+
+// cycle between ranks, ranks[0] is the anchor
+struct Candidate {
+    unsigned int ranks[4];
+    unsigned int length;
+    double profit;
+};
+
+// the N-th best profit is at the front
+bool moreProfitable(const Candidate& a, const Candidate& b)
+{
+    return a.profit > b.profit;
+}
+
+}
+
+// state of the anchors of one group
+struct CycleScanner::Scan {
+    unsigned int maxLength;
+    unsigned int topN;
+    double minProfit;
+    double feeFactors[5]; // (1 - feeRate)^length
+
+    std::vector<Candidate> best; // heap of the best topN so far
+    std::vector<unsigned int> hits;
+
+    // profit a new cycle has to beat
+    double getFloor() const
+    {
+        return best.size() < topN ? minProfit : std::max(minProfit, best.front().profit);
+    }
+
+    // product of the rates a cycle of the given length has to beat
+    double getThreshold(unsigned int length) const
+    {
+        return (1 + getFloor()) / feeFactors[length];
+    }
+
+    void offer(const unsigned int* ranks, unsigned int length, double product)
+    {
+        const double profit = product * feeFactors[length] - 1;
+        if (!(profit > getFloor()))
+            return;
+
+        if (best.size() == topN) {
+            std::pop_heap(best.begin(), best.end(), moreProfitable);
+            best.pop_back();
+        }
+
+        Candidate candidate;
+        std::copy(ranks, ranks + length, candidate.ranks);
+        candidate.length = length;
+        candidate.profit = profit;
+
+        best.push_back(candidate);
+        std::push_heap(best.begin(), best.end(), moreProfitable);
+    }
+};
+
+void CycleScanner::build(const std::vector< std::vector< std::pair<unsigned int, double> > >& edges)
+{
+    std::vector<unsigned int> numberOfPairs(numberOfVertices, 0);
+    for (unsigned int from = 0; from < numberOfVertices; ++from) {
+        for (auto& edge : edges[from]) {
+            ++numberOfPairs[from];
+            ++numberOfPairs[edge.first];
+        }
+    }
+
+    std::shared_ptr<Ranking> newRanking = std::make_shared<Ranking>();
+    std::vector<unsigned int>& vertexOfRank = newRanking->vertexOfRank;
+    std::vector<unsigned int>& rankOf = newRanking->rankOfVertex;
+
+    vertexOfRank.resize(numberOfVertices);
+    for (unsigned int vertex = 0; vertex < numberOfVertices; ++vertex)
+        vertexOfRank[vertex] = vertex;
+
+    std::stable_sort(vertexOfRank.begin(), vertexOfRank.end(), [&](unsigned int a, unsigned int b) {
+        return numberOfPairs[a] < numberOfPairs[b];
+    });
+
+    rankOf.resize(numberOfVertices);
+    for (unsigned int rank = 0; rank < numberOfVertices; ++rank)
+        rankOf[vertexOfRank[rank]] = rank;
+
+    stride = (numberOfVertices + kLanes - 1) / kLanes * kLanes;
+    rateRows.resize(numberOfVertices);
+    transposedRateRows.resize(numberOfVertices);
+    for (unsigned int rank = 0; rank < numberOfVertices; ++rank) {
+        rateRows[rank] = std::make_shared< std::vector<double> >(stride, 0);
+        transposedRateRows[rank] = std::make_shared< std::vector<double> >(stride, 0);
+    }
+
+    std::vector< std::vector<unsigned int> >& higherSuccessors = newRanking->higherSuccessors;
+    std::vector< std::vector<unsigned int> >& higherPredecessors = newRanking->higherPredecessors;
+    higherSuccessors.assign(numberOfVertices, std::vector<unsigned int>());
+    higherPredecessors.assign(numberOfVertices, std::vector<unsigned int>());
+
+    for (unsigned int from = 0; from < numberOfVertices; ++from) {
+        const unsigned int fromRank = rankOf[from];
+
+        for (auto& edge : edges[from]) {
+            const unsigned int toRank = rankOf[edge.first];
+            if (edge.second == INF || toRank == fromRank)
+                continue;
+
+            // the weights are logs of the prices paid, one unit buys exp(-weight)
+            const double rate = std::exp(-edge.second);
+            (*rateRows[fromRank])[toRank] = rate;
+            (*transposedRateRows[toRank])[fromRank] = rate;
+
+            if (toRank > fromRank)
+                higherSuccessors[fromRank].push_back(toRank);
+            else
+                higherPredecessors[toRank].push_back(fromRank);
+        }
+    }
+
+    for (unsigned int rank = 0; rank < numberOfVertices; ++rank) {
+        std::sort(higherSuccessors[rank].begin(), higherSuccessors[rank].end());
+        std::sort(higherPredecessors[rank].begin(), higherPredecessors[rank].end());
+    }
+
+    ranking = newRanking;
+}
+
+unsigned int CycleScanner::getNumberOfVertices() const
+{
+    return numberOfVertices;
+}
+
+
+
+/*! applyEdgeChanges - update the rates after the weights of existing pairs changed
+ *
+ * Every row written is copied once, the first time this call writes it, so the scanner it was copied from keeps its
+ * rates. Costs O(V) per row written instead of the O(V^2) of a new scanner
+ */
+bool CycleScanner::applyEdgeChanges(const std::vector<AllPairsShortestPaths::EdgeChange>& changes)
+{
+    for (auto& change : changes) {
+        if (change.from >= numberOfVertices || change.to >= numberOfVertices)
+            return false;
+
+        if (change.from != change.to && (change.oldWeight == INF) != (change.newWeight == INF))
+            return false;
+    }
+
+    std::vector<bool> rowCopied(numberOfVertices, false);
+    std::vector<bool> transposedRowCopied(numberOfVertices, false);
+
+    const auto writableRow = [](std::vector< std::shared_ptr< std::vector<double> > >& rows, std::vector<bool>& copied,
+                                unsigned int rank) -> std::vector<double>& {
+        if (!copied[rank]) {
+            rows[rank] = std::make_shared< std::vector<double> >(*rows[rank]);
+            copied[rank] = true;
+        }
+
+        return *rows[rank];
+    };
+
+    for (auto& change : changes) {
+        if (change.from == change.to || change.newWeight == INF)
+            continue;
+
+        const unsigned int fromRank = ranking->rankOfVertex[change.from];
+        const unsigned int toRank = ranking->rankOfVertex[change.to];
+        const double rate = std::exp(-change.newWeight);
+
+        writableRow(rateRows, rowCopied, fromRank)[toRank] = rate;
+        writableRow(transposedRateRows, transposedRowCopied, toRank)[fromRank] = rate;
+    }
+
+    return true;
+}
+
+
+
+/*! scanAnchor - every cycle whose vertex of smallest rank is the anchor
+ *
+ * The third vertex c of a cycle runs in the kernel, over the ranks above the anchor. Products through c == b or c == d
+ * read the diagonal, which is 0, so only c <= anchor has to be filtered out of the hits
+ */
+void CycleScanner::scanAnchor(unsigned int anchor, Scan& scan) const
+{
+    const ProductKernel kernel = selectedKernel().kernel;
+    const std::vector< std::vector<unsigned int> >& higherSuccessors = ranking->higherSuccessors;
+    const std::vector< std::vector<unsigned int> >& higherPredecessors = ranking->higherPredecessors;
+
+    const double* anchorRates = rateRows[anchor]->data();
+    const double* anchorTransposed = transposedRateRows[anchor]->data();
+    const unsigned int begin = (anchor + 1) / kLanes * kLanes;
+
+    unsigned int ranks[4] = { anchor, 0, 0, 0 };
+
+    for (unsigned int b : higherSuccessors[anchor]) {
+        const double* successorRates = rateRows[b]->data();
+        ranks[1] = b;
+
+        // anchor -> b -> anchor
+        scan.offer(ranks, 2, anchorRates[b] * anchorTransposed[b]);
+
+        // anchor -> b -> c -> anchor
+        if (scan.maxLength >= 3) {
+            const unsigned int numberOfHits = kernel(successorRates, anchorTransposed, anchorRates[b], scan.getThreshold(3),
+                                                     begin, stride, scan.hits.data());
+            for (unsigned int i = 0; i < numberOfHits; ++i) {
+                const unsigned int c = scan.hits[i];
+                if (c <= anchor)
+                    continue;
+
+                ranks[2] = c;
+                scan.offer(ranks, 3, anchorRates[b] * (successorRates[c] * anchorTransposed[c]));
+            }
+        }
+
+        // anchor -> b -> c -> d -> anchor
+        if (scan.maxLength >= 4) {
+            for (unsigned int d : higherPredecessors[anchor]) {
+                if (d == b)
+                    continue;
+
+                const double* predecessorTransposed = transposedRateRows[d]->data();
+                const double scale = anchorRates[b] * anchorTransposed[d];
+
+                const unsigned int numberOfHits = kernel(successorRates, predecessorTransposed, scale, scan.getThreshold(4),
+                                                         begin, stride, scan.hits.data());
+                for (unsigned int i = 0; i < numberOfHits; ++i) {
+                    const unsigned int c = scan.hits[i];
+                    if (c <= anchor)
+                        continue;
+
+                    ranks[2] = c;
+                    ranks[3] = d;
+                    scan.offer(ranks, 4, scale * (successorRates[c] * predecessorTransposed[c]));
+                }
+            }
+        }
+    }
+}
+
+
+
+/*! scan - the most profitable cycles of up to maxLength exchanges
+ *
+ * Groups of anchors run in parallel, each with its own top N, and the groups are merged at the end.
+ *
+ * A profit of a cycle is only kept above minProfit by more than kRelaxationEpsilon. For small profits that is the
+ * tolerance the path searches apply to the sum of the log weights, so cycles whose rates only fail to cancel out by
+ * rounding, such as the two directions of one market, are not reported as arbitrage
+ */
+std::vector<CycleScanner::Opportunity> CycleScanner::scan(unsigned int maxLength, unsigned int topN, double feeRate,
+                                                          double minProfit, ThreadPool* pool) const
+{
+    std::vector<Opportunity> opportunities;
+    if (topN == 0 || maxLength < 2 || numberOfVertices == 0)
+        return opportunities;
+
+    const unsigned int numberOfGroups = (numberOfVertices + kAnchorsPerGroup - 1) / kAnchorsPerGroup;
+    std::vector< std::vector<Candidate> > groupBest(numberOfGroups);
+
+    const std::function<void(size_t)> scanGroup = [&](size_t group) {
+        Scan scan;
+        scan.maxLength = std::min(maxLength, 4u);
+        scan.topN = topN;
+        scan.minProfit = minProfit + kRelaxationEpsilon;
+        for (unsigned int length = 0; length < 5; ++length)
+            scan.feeFactors[length] = std::pow(1 - feeRate, (double) length);
+        scan.hits.resize(stride);
+
+        const unsigned int end = std::min(numberOfVertices, (unsigned int) (group + 1) * kAnchorsPerGroup);
+        for (unsigned int anchor = (unsigned int) group * kAnchorsPerGroup; anchor < end; ++anchor)
+            scanAnchor(anchor, scan);
+
+        groupBest[group].swap(scan.best);
+    };
+
+    if (pool)
+        pool->parallelFor(numberOfGroups, scanGroup);
+    else
+        for (unsigned int group = 0; group < numberOfGroups; ++group)
+            scanGroup(group);
+
+    for (auto& best : groupBest) {
+        for (auto& candidate : best) {
+            Opportunity opportunity;
+            for (unsigned int i = 0; i < candidate.length; ++i)
+                opportunity.vertices.push_back(ranking->vertexOfRank[candidate.ranks[i]]);
+
+            std::rotate(opportunity.vertices.begin(), std::min_element(opportunity.vertices.begin(), opportunity.vertices.end()),
+                        opportunity.vertices.end());
+            opportunity.profit = candidate.profit;
+
+            opportunities.push_back(std::move(opportunity));
+        }
+    }
+
+    std::sort(opportunities.begin(), opportunities.end(), [](const Opportunity& a, const Opportunity& b) {
+        if (a.profit != b.profit)
+            return a.profit > b.profit;
+        return a.vertices < b.vertices;
+    });
+
+    if (opportunities.size() > topN)
+        opportunities.resize(topN);
+
+    return opportunities;
+}
+
+const char* CycleScanner::getKernelName()
+{
+    return selectedKernel().name;
+}
@@ -2,6 +2,7 @@
 // Created by Mian Hashim Shah on 4/25/18.
 //
 #include "DirectedMatrixGraph.h"
+#include "Trace.h"
 
 template<class T>
 DirectedMatrixGraph<T>::DirectedMatrixGraph() {
@@ -28,10 +29,22 @@ void DirectedMatrixGraph<T>::addEdge(const T &fromValue, const T &toValue, doubl
     if (fromIndex != -1 && toIndex != -1)
     {
         //if they exist, then add it
-        adjMatrix[fromIndex][toIndex] = cost; // add edge between vertices
+        addEdgeById(fromIndex, toIndex, cost);
     }
 }
 
+template<class T>
+void DirectedMatrixGraph<T>::addEdgeById(unsigned int fromId, unsigned int toId, double cost)
+{
+    this->setWeight(fromId, toId, cost); // add edge between vertices
+}
+
+template<class T>
+Graph<T>* DirectedMatrixGraph<T>::clone() const
+{
+    return new DirectedMatrixGraph<T>(*this);
+}
+
 template<class T>
 void DirectedMatrixGraph<T>::removeEdge(const T &fromValue, const T &toValue)
 {
@@ -41,13 +54,13 @@ void DirectedMatrixGraph<T>::removeEdge(const T &fromValue, const T &toValue)
 
     if (fromIndex != -1 && toIndex != -1) {
         //check to see if edge doesnt exist between vertices
-        if (adjMatrix[fromIndex][toIndex] == 0) {
-            std::cout << __FUNCTION__ << ": Edge does not exist.. Nothing to do here" << "\n";
+        if (this->weightAt(fromIndex, toIndex) == INF) {
+            KRYPTOS_TRACE(kDebug, kGraph, "removeEdge", "edge does not exist, nothing to do");
             return;
         }
 
         //if they exist, then remove it
-        adjMatrix[fromIndex][toIndex] = 0.00; //add edge between vertices
+        addEdgeById(fromIndex, toIndex, INF); // no-edge is INF
     }
 }
 
@@ -58,7 +71,7 @@ int DirectedMatrixGraph<T>::lookUpVertex(const T &value) const
 }
 
 template<class T>
-double DirectedMatrixGraph<T>::getWeight(const T &fromValue, const T &toValue)
+double DirectedMatrixGraph<T>::getWeight(const T &fromValue, const T &toValue) const
 {
     return UndirectedMatrixGraph<T>::getWeight(fromValue, toValue);
 }
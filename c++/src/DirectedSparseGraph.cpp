@@ -0,0 +1,491 @@
+// DirectedSparseGraph.cpp
+// DirectedSparseGraph Class Implementation
+
+#include "DirectedSparseGraph.h"
+#include <algorithm>
+#include <functional>
+#include <iomanip> // setprecision
+#include <sstream> // stringstream
+
+#include "CurrencyPair.h"
+#include "AllPairsShortestPaths.h"
+#include "Trace.h"
+
+// minimum number of pending edges before they are merged into the CSR arrays
+static const unsigned long kMinEdgesBeforeCompaction = 64;
+
+//constructor of directed graph using compressed sparse rows
+template<class T>
+DirectedSparseGraph<T>::DirectedSparseGraph() : Graph<T>(), vertices(std::make_shared<Vertices>()), removedVertices(),
+                                                rowOffsets(1, 0), columnIndices(), edgeWeights(), pendingEdges(),
+                                                numberOfPendingEdges(0), numberOfRemovedEdges(0) {}
+
+
+//This function adds a vertex to our vertex list
+// @param: const T& value
+
+//1. checks if the vertex already exists, if yes, then return
+//2. appends the vertex and an empty adjacency row
+//3. increments the number of vertices
+template<class T>
+void DirectedSparseGraph<T>::addVertex(const T& value)
+{
+    if (lookUpVertex(value) != -1)
+        return;
+
+    Vertices& writable = getWritableVertices();
+    writable.verticesMap.insert(std::make_pair(value, (unsigned int) writable.vertexList.size()));
+    writable.vertexList.push_back(Vertex<T>(value));
+    removedVertices.push_back(false);
+
+    // the new row is empty, so it starts where the last row ends
+    rowOffsets.push_back(rowOffsets.back());
+    pendingEdges.emplace_back();
+
+    totalNumberOfVertices++;
+}
+
+//This function removes a vertex from our vertex list
+// @param: const T& value
+
+//1. Checks for whether the vertex exists
+//2. marks the slot as removed and drops all edges to and from the vertex
+//3. decrements the number of vertices
+template<class T>
+void DirectedSparseGraph<T>::removeVertex(const T& value)
+{
+    int index = lookUpVertex(value);
+
+    if (index == -1)
+        return;
+
+    // outgoing edges
+    for (unsigned int e = rowOffsets[index]; e < rowOffsets[index + 1]; ++e) {
+        if (edgeWeights[e] != INF) {
+            edgeWeights[e] = INF;
+            numberOfRemovedEdges++;
+        }
+    }
+    numberOfPendingEdges -= pendingEdges[index].size();
+    pendingEdges[index].clear();
+
+    // incoming edges
+    for (unsigned int i = 0; i < vertices->vertexList.size(); ++i) {
+        if (removedVertices[i])
+            continue;
+
+        double* weight = findEdge(i, (unsigned int) index);
+        if (weight != nullptr)
+            removeEdge(vertices->vertexList[i].getValue(), value);
+    }
+
+    removedVertices[index] = true;
+    getWritableVertices().verticesMap.erase(value);
+    totalNumberOfVertices--;
+
+    KRYPTOS_TRACE(kDebug, kGraph, "removeVertex", "removed vertex at index " + std::to_string(index));
+}
+
+//This function adds an edge between two given vertices and sets an associated cost to the edge
+// @param: const T& fromValue, const T& toValue, double cost
+
+//1. look up in our vertex list if these vertices exist. Return index of both vertices
+//2. if edge already exists between them, update its cost in place
+//3. otherwise queue the edge, it is merged into the CSR arrays on the next compaction
+template<class T>
+void DirectedSparseGraph<T>::addEdge(const T& fromValue, const T& toValue, double cost)
+{
+    int fromIndex = lookUpVertex(fromValue);
+    int toIndex = lookUpVertex(toValue);
+
+    if (fromIndex != -1 && toIndex != -1)
+        addEdgeById((unsigned int) fromIndex, (unsigned int) toIndex, cost);
+}
+
+//This function removes an edge between two given vertices
+// @param: const T& fromValue, const T& toValue
+
+//1. look up in our vertex list if these vertices exist. Return index of both vertices
+//2. check if edge exists between them, if not, then nothing to delete. We exit then
+//3. remove edge between the vertices. Since this is Directed, only one edge is removed
+template<class T>
+void DirectedSparseGraph<T>::removeEdge(const T& fromValue, const T& toValue)
+{
+    int fromIndex = lookUpVertex(fromValue);
+    int toIndex = lookUpVertex(toValue);
+
+    if (fromIndex == -1 || toIndex == -1)
+        return;
+
+    // pending edges are removed right away
+    auto& pending = pendingEdges[fromIndex];
+    for (auto it = pending.begin(); it != pending.end(); ++it) {
+        if (it->first == (unsigned int) toIndex) {
+            pending.erase(it);
+            numberOfPendingEdges--;
+            return;
+        }
+    }
+
+    double* weight = findEdge((unsigned int) fromIndex, (unsigned int) toIndex);
+    if (weight == nullptr) {
+        KRYPTOS_TRACE(kDebug, kGraph, "removeEdge", "edge does not exist, nothing to do");
+        return;
+    }
+
+    // compacted edges are marked and dropped on the next compaction
+    *weight = INF;
+    numberOfRemovedEdges++;
+
+    if (numberOfRemovedEdges > std::max(kMinEdgesBeforeCompaction, (unsigned long) columnIndices.size() / 2))
+        compact();
+}
+
+//This function checks to see if a vertex exists or not
+// @param: const T& value
+
+//1. check if unordered_map contains specified value. if yes, return the associated value (index).
+//2. otherwise return -1 to indicate "not found"
+template<class T>
+int DirectedSparseGraph<T>::lookUpVertex(const T& value) const
+{
+    auto iterator = vertices->verticesMap.find(value);
+
+    if (iterator == vertices->verticesMap.end()) // if iterator points to the end of map, element is not in the map
+        return -1;
+
+    return iterator->second;
+}
+
+//This function returns the weight between two vertices.
+//@param: const T &fromValue, const T &toValue
+//returns double in the form of the weight, INF if there is no edge and -1 if a vertex does not exist
+template<class T>
+double DirectedSparseGraph<T>::getWeight(const T& fromValue, const T& toValue) const
+{
+    int fromIndex = lookUpVertex(fromValue);
+    int toIndex = lookUpVertex(toValue);
+
+    if (fromIndex == -1 || toIndex == -1)
+        return -1;
+
+    return getWeightById((unsigned int) fromIndex, (unsigned int) toIndex);
+}
+
+//This function returns the neighbors of a specified vertex
+//@param: const T& targetCoin
+//returns list of vertices the targetCoin has an edge to
+template<class T>
+std::vector< Vertex<T> > DirectedSparseGraph<T>::getNeighbors(const T& targetCoin) const
+{
+    std::vector< Vertex<T> > listOfNeighbors;
+
+    int index = lookUpVertex(targetCoin);
+    if (index == -1)
+        return listOfNeighbors;
+
+    for (unsigned int e = rowOffsets[index]; e < rowOffsets[index + 1]; ++e) {
+        if (edgeWeights[e] != INF)
+            listOfNeighbors.push_back(vertices->vertexList[columnIndices[e]]);
+    }
+
+    for (auto& edge : pendingEdges[index])
+        listOfNeighbors.push_back(vertices->vertexList[edge.first]);
+
+    return listOfNeighbors;
+}
+
+
+/*! toString - create a string representation of graph with all vertices
+ *
+ * @tparam T - type of the object that this graph holds
+ * @return - string representation of this graph (one adjacency row per line)
+ */
+template<class T>
+std::string DirectedSparseGraph<T>::toString()
+{
+    std::stringstream buffer;
+    buffer << std::fixed << std::setprecision(2);
+
+    for (unsigned int i = 0; i < vertices->vertexList.size(); ++i) {
+        if (removedVertices[i])
+            continue;
+
+        buffer << vertices->vertexList[i].getValue() << " ->";
+        for (unsigned int e = rowOffsets[i]; e < rowOffsets[i + 1]; ++e) {
+            if (edgeWeights[e] != INF)
+                buffer << " " << vertices->vertexList[columnIndices[e]].getValue() << " [" << edgeWeights[e] << "]";
+        }
+        for (auto& edge : pendingEdges[i])
+            buffer << " " << vertices->vertexList[edge.first].getValue() << " [" << edge.second << "]";
+
+        buffer << "\n\n";
+    }
+
+    return buffer.str();
+}
+
+
+/*! reset - clear the values in the graph
+ *
+ * @tparam T - the type of the objects that Graph holds
+ */
+template<class T>
+void DirectedSparseGraph<T>::reset()
+{
+    vertices = std::make_shared<Vertices>();
+    removedVertices.clear();
+    rowOffsets.assign(1, 0);
+    columnIndices.clear();
+    edgeWeights.clear();
+    pendingEdges.clear();
+    numberOfPendingEdges = 0;
+    numberOfRemovedEdges = 0;
+    totalNumberOfVertices = 0;
+}
+
+
+/*! clone - copy the CSR arrays and the edges not compacted yet, and share the vertices
+ *
+ * The copy only takes O(V + E) copies of ids and weights, no values are copied or hashed again. Whichever graph adds
+ * or removes a vertex first copies the vertices for itself
+ *
+ * @tparam T - the type of the objects that Graph holds
+ */
+template<class T>
+Graph<T>* DirectedSparseGraph<T>::clone() const
+{
+    return new DirectedSparseGraph<T>(*this);
+}
+
+
+template<class T>
+typename DirectedSparseGraph<T>::Vertices& DirectedSparseGraph<T>::getWritableVertices()
+{
+    // clones are made by the owner of the graph, so no other copy can start sharing them while they are written
+    if (vertices.use_count() > 1)
+        vertices = std::make_shared<Vertices>(*vertices);
+
+    return *vertices;
+}
+
+
+template<class T>
+unsigned long DirectedSparseGraph<T>::getNumberOfEdges() const
+{
+    return columnIndices.size() - numberOfRemovedEdges + numberOfPendingEdges;
+}
+
+
+template<class T>
+double* DirectedSparseGraph<T>::findEdge(unsigned int fromIndex, unsigned int toIndex)
+{
+    return const_cast<double*>(static_cast<const DirectedSparseGraph<T>*>(this)->findEdge(fromIndex, toIndex));
+}
+
+template<class T>
+const double* DirectedSparseGraph<T>::findEdge(unsigned int fromIndex, unsigned int toIndex) const
+{
+    // compacted row is sorted by column
+    const auto rowBegin = columnIndices.begin() + rowOffsets[fromIndex];
+    const auto rowEnd = columnIndices.begin() + rowOffsets[fromIndex + 1];
+    const auto it = std::lower_bound(rowBegin, rowEnd, toIndex);
+
+    if (it != rowEnd && *it == toIndex) {
+        const double* weight = &edgeWeights[it - columnIndices.begin()];
+        return *weight != INF ? weight : nullptr;
+    }
+
+    // pending edges are few per row, a linear scan is enough
+    for (auto& edge : pendingEdges[fromIndex]) {
+        if (edge.first == toIndex)
+            return &edge.second;
+    }
+
+    return nullptr;
+}
+
+
+/*! compact - merge the pending edges into the CSR arrays and drop the removed ones
+ *
+ * Runs in O(E + P log P) where P is the number of pending edges
+ */
+template<class T>
+void DirectedSparseGraph<T>::compact()
+{
+    const unsigned int V = (unsigned int) vertices->vertexList.size();
+
+    std::vector<unsigned int> newOffsets(V + 1, 0);
+    std::vector<unsigned int> newColumns;
+    std::vector<double> newWeights;
+    newColumns.reserve(getNumberOfEdges());
+    newWeights.reserve(getNumberOfEdges());
+
+    for (unsigned int i = 0; i < V; ++i) {
+        auto& pending = pendingEdges[i];
+        std::sort(pending.begin(), pending.end());
+
+        // merge the sorted compacted row with the sorted pending edges
+        unsigned int e = rowOffsets[i];
+        const unsigned int rowEnd = rowOffsets[i + 1];
+        auto p = pending.begin();
+
+        while (e < rowEnd || p != pending.end()) {
+            if (p == pending.end() || (e < rowEnd && columnIndices[e] < p->first)) {
+                if (edgeWeights[e] != INF) {
+                    newColumns.push_back(columnIndices[e]);
+                    newWeights.push_back(edgeWeights[e]);
+                }
+                ++e;
+            } else {
+                newColumns.push_back(p->first);
+                newWeights.push_back(p->second);
+                ++p;
+            }
+        }
+
+        pending.clear();
+        newOffsets[i + 1] = (unsigned int) newColumns.size();
+    }
+
+    rowOffsets.swap(newOffsets);
+    columnIndices.swap(newColumns);
+    edgeWeights.swap(newWeights);
+    numberOfPendingEdges = 0;
+    numberOfRemovedEdges = 0;
+}
+
+
+template<class T>
+std::list<CurrencyPair> DirectedSparseGraph<T>::constructPairs(const std::vector<unsigned int>& path) const
+{
+    std::list<CurrencyPair> pairs;
+
+    // since pairs are represented like: "S" -> "K"
+    // a path like "S T R" results in the pairs: "S" -> "T" and "T" -> "R"
+    for (unsigned int i = 1; i < path.size(); ++i)
+        pairs.emplace_back(vertices->vertexList[path[i - 1]].getValue(), vertices->vertexList[path[i]].getValue(), getWeightById(path[i - 1], path[i]));
+
+    return pairs;
+}
+
+
+/*! computeShortestDistanceBetweenAllVertices - Calculate shortest paths between all vertices
+ *
+ * @tparam T - the object type that Graph holds
+ * @return 2D vector with shortest paths between all vertices
+ */
+template<class T>
+std::vector< std::vector<double> > DirectedSparseGraph<T>::computeShortestDistanceBetweenAllVertices() const
+{
+    // the result is dense anyway, so run the blocked Floyd-Warshall which also handles negative (log) weights
+    AllPairsShortestPaths dists;
+    dists.load(*this);
+    dists.compute();
+
+    return dists.toMatrix();
+}
+
+
+/*! computeShortestDistanceBetweenVertices - Calculate the shortest path between two vertices
+ *
+ * @param from - source vertex (from which calculate distance)
+ * @param to - destination vertex (to which calculate distance)
+ * @return list with shortest paths between given vertices.
+ *         If those vertices do not exist in the graph or are not connected, return empty list
+ */
+template<class T>
+std::list<CurrencyPair> DirectedSparseGraph<T>::computeShortestDistanceBetweenVertices(const T& from, const T& to) const
+{
+    const int src = lookUpVertex(from);
+    const int dest = lookUpVertex(to);
+
+    if (src == -1 || dest == -1)
+        return std::list<CurrencyPair>();
+
+    return constructPairs(this->getShortestPathBetweenIds((unsigned int) src, (unsigned int) dest));
+}
+
+
+template<class T>
+std::list<CurrencyPair> DirectedSparseGraph<T>::getShortestPairsBetween(const T& from, const T& to) const
+{
+    // find the index of searched values in the graph
+    const int src = lookUpVertex(from);
+    const int dest = lookUpVertex(to);
+
+    // if the source or destination vertex is not in the graph, we just return empty list
+    if (src == -1 || dest == -1)
+        return std::list<CurrencyPair>();
+
+    return constructPairs(this->getShortestPathBetweenIds((unsigned int) src, (unsigned int) dest));
+}
+
+
+
+template<class T>
+unsigned int DirectedSparseGraph<T>::getNumberOfVertexIds() const
+{
+    return (unsigned int) vertices->vertexList.size();
+}
+
+template<class T>
+T DirectedSparseGraph<T>::getVertexValue(unsigned int id) const
+{
+    return vertices->vertexList[id].getValue();
+}
+
+//Same as addEdge, with the vertices given by their ids
+//1. if edge already exists between them, update its cost in place
+//2. otherwise queue the edge, it is merged into the CSR arrays on the next compaction
+template<class T>
+void DirectedSparseGraph<T>::addEdgeById(unsigned int fromId, unsigned int toId, double cost)
+{
+    double* weight = findEdge(fromId, toId);
+    if (weight != nullptr) {
+        *weight = cost;
+        return;
+    }
+
+    // an edge that was removed since the last compaction is still in its sorted position, so revive it
+    const auto rowBegin = columnIndices.begin() + rowOffsets[fromId];
+    const auto rowEnd = columnIndices.begin() + rowOffsets[fromId + 1];
+    const auto it = std::lower_bound(rowBegin, rowEnd, toId);
+    if (it != rowEnd && *it == toId) {
+        edgeWeights[it - columnIndices.begin()] = cost;
+        numberOfRemovedEdges--;
+        return;
+    }
+
+    pendingEdges[fromId].emplace_back(toId, cost);
+    numberOfPendingEdges++;
+
+    // merging costs O(E), so wait until enough edges are pending to keep insertion amortized O(1)
+    if (numberOfPendingEdges > std::max(kMinEdgesBeforeCompaction, (unsigned long) columnIndices.size() / 2))
+        compact();
+}
+
+template<class T>
+double DirectedSparseGraph<T>::getWeightById(unsigned int fromId, unsigned int toId) const
+{
+    // distance of a vertex to itself is 0, the same as the diagonal of the matrix graphs
+    if (fromId == toId)
+        return 0;
+
+    const double* weight = findEdge(fromId, toId);
+    return weight != nullptr ? *weight : INF;
+}
+
+
+template<class T>
+void DirectedSparseGraph<T>::getOutgoingEdges(unsigned int fromId, std::vector< std::pair<unsigned int, double> >& edges) const
+{
+    edges.clear();
+
+    for (unsigned int e = rowOffsets[fromId]; e < rowOffsets[fromId + 1]; ++e) {
+        if (edgeWeights[e] != INF)
+            edges.emplace_back(columnIndices[e], edgeWeights[e]);
+    }
+
+    edges.insert(edges.end(), pendingEdges[fromId].begin(), pendingEdges[fromId].end());
+}
@@ -2,18 +2,63 @@
 // Created by Dmitry Sokolov on 4/4/18.
 //
 
+#include <algorithm>
+#include <chrono>
 #include <utility>
 #include <queue>
 #include <limits>
 #include <unordered_map>
 #include <stack>
+#include <cmath>
+#include <cstring>
 
 #include "../include/GraphManager.h"
 #include "../include/CurrencyPairParser.h"
+#include "../include/PerfCounters.h"
+#include "../include/SnapshotFile.h"
+#include "../include/Trace.h"
 #include "UndirectedMatrixGraph.h"
 
+const double GraphManager::kMaxChangedEdgesPerVertex = 0.5;
+
+const char* const GraphManager::kOperationNames[GraphManager::kNumberOfOperations] = {
+        "updateGraph",
+        "updateGraphFromBuffer",
+        "updateRate",
+        "applyRateBatch",
+        "publish",
+        "findBestExchangeRoute",
+        "findBestExchangeRoutes",
+        "findBestExchangePath",
+        "findBestExchangePaths",
+        "findAlternativeRoutes",
+        "findAlternativePaths",
+        "findShortArbitrageCycles",
+        "getCostForExchange"
+};
+
+// time of the batches of the tick log
+static int64_t nanosecondsSinceEpoch() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
 GraphManager::GraphManager(const std::string nameOfExchange, Graph<std::string> *graph, CurrencyPairParser* pairParser):
-        nameOfExchange(nameOfExchange), graph(graph), parser(pairParser) { }
+        nameOfExchange(nameOfExchange), parser(pairParser), graph(graph), tooManyEdgeChanges(false), numberOfEdges(0),
+        numberOfRefreshes(0), publishedVersion(0), publishedVertices(0), publishedEdges(0), publishedChangedEdges(0) {
+
+    // the graph might already hold vertices, give their symbols the same ids as the vertices
+    std::vector< std::pair<unsigned int, double> > edges;
+    for (unsigned int id = 0; id < graph->getNumberOfVertexIds(); ++id) {
+        symbols.intern(graph->getVertexValue(id));
+
+        graph->getOutgoingEdges(id, edges);
+        numberOfEdges += edges.size();
+    }
+
+    // queries always have a snapshot to pin
+    std::lock_guard<std::mutex> lock(writerMutex);
+    publish();
+}
 
 
 /*! getNameOfExchange
@@ -26,48 +71,347 @@ std::string GraphManager::getNameOfExchange() const {
 
 
 
+/*! getSnapshot - the current version of the graph
+ *
+ * @return - snapshot that stays unchanged while it is held
+ */
+std::shared_ptr<const GraphSnapshot> GraphManager::getSnapshot() const {
+    return std::atomic_load(&snapshot);
+}
+
+
+
+/*! publish - make the working copy the current snapshot
+ *
+ * The graph is copied, the symbols only if currencies were added. All-pairs distances that readers asked for on the
+ * current snapshot are patched with the edges changed since, so the next snapshot has them without a full run. The
+ * layouts of the alternative routes and short cycle searches are patched the same way: a tick that only changes prices
+ * copies the rows of its pairs, instead of the next query laying out the whole graph again
+ */
+void GraphManager::publish(std::shared_ptr<const AllPairsShortestPaths> knownAllPairs) {
+    LatencyHistogram::Timer timer(latencies[kPublish]);
+    KRYPTOS_TRACE_SCOPE(kInfo, kUpdate, "publish");
+    PerfCounters::Scope perfScope("publish");
+
+    const std::shared_ptr<const GraphSnapshot> current = std::atomic_load(&snapshot);
+    std::shared_ptr<const Graph<std::string>> graphCopy(graph->clone());
+
+    if (!publishedSymbols)
+        publishedSymbols = std::make_shared<const SymbolTable>(symbols);
+
+    std::shared_ptr<const AllPairsShortestPaths> allPairs = knownAllPairs;
+    const std::shared_ptr<const AllPairsShortestPaths> currentAllPairs = current ? current->getComputedAllPairs() : nullptr;
+
+    // new currencies change the size of the matrices, and many changes are cheaper to apply all at once.
+    // Either way the next reader asking for the distances computes them
+    if (!allPairs && currentAllPairs && !tooManyEdgeChanges && currentAllPairs->getNumberOfVertices() == graphCopy->getNumberOfVertexIds()) {
+        if (pendingEdgeChanges.empty()) {
+            allPairs = currentAllPairs;
+        } else {
+            std::shared_ptr<AllPairsShortestPaths> patched = std::make_shared<AllPairsShortestPaths>(*currentAllPairs);
+            patched->applyEdgeChanges(*graphCopy, pendingEdgeChanges, threadPool.get());
+            allPairs = patched;
+        }
+    }
+
+    // the layouts only follow prices, new currencies or pairs take new ones, built by the next query that needs them
+    std::shared_ptr<const KShortestPaths> alternativeRoutes;
+    std::shared_ptr<const CycleScanner> cycleScanner;
+
+    if (current && !tooManyEdgeChanges) {
+        const std::shared_ptr<const KShortestPaths> currentRoutes = current->getBuiltAlternativeRoutes();
+        if (currentRoutes && currentRoutes->getNumberOfVertices() == graphCopy->getNumberOfVertexIds()) {
+            if (pendingEdgeChanges.empty()) {
+                alternativeRoutes = currentRoutes;
+            } else {
+                std::shared_ptr<KShortestPaths> patched = std::make_shared<KShortestPaths>(*currentRoutes);
+                if (patched->applyEdgeChanges(pendingEdgeChanges))
+                    alternativeRoutes = patched;
+            }
+        }
+
+        const std::shared_ptr<const CycleScanner> currentScanner = current->getBuiltCycleScanner();
+        if (currentScanner && currentScanner->getNumberOfVertices() == graphCopy->getNumberOfVertexIds()) {
+            if (pendingEdgeChanges.empty()) {
+                cycleScanner = currentScanner;
+            } else {
+                std::shared_ptr<CycleScanner> patched = std::make_shared<CycleScanner>(*currentScanner);
+                if (patched->applyEdgeChanges(pendingEdgeChanges))
+                    cycleScanner = patched;
+            }
+        }
+    }
+
+    // only the pairs that got cheaper can close a new cycle, the first snapshot checks everything
+    const std::vector<ArbitrageDetector::Cycle>& cycles =
+            arbitrageDetector.update(*graph, pendingEdgeChanges, tooManyEdgeChanges || !current);
+
+    std::vector<ArbitrageCycle> arbitrageCycles;
+    for (auto& cycle : cycles) {
+        ArbitrageCycle arbitrage;
+        for (size_t i = 0; i < cycle.vertices.size(); ++i) {
+            const unsigned int from = cycle.vertices[i];
+            const unsigned int to = cycle.vertices[(i + 1) % cycle.vertices.size()];
+            arbitrage.pairs.emplace_back(symbols.getSymbol(from), symbols.getSymbol(to), std::exp(graph->getWeightById(from, to)));
+        }
+
+        // the weights are logs of the prices paid, a cycle of weight w returns exp(-w) times the amount
+        arbitrage.gain = std::expm1(-cycle.weight);
+        arbitrageCycles.push_back(std::move(arbitrage));
+    }
+
+    const uint64_t numberOfChangedEdges = tooManyEdgeChanges || !current ? numberOfEdges : pendingEdgeChanges.size();
+
+    pendingEdgeChanges.clear();
+    tooManyEdgeChanges = false;
+
+    tickLog.writePublish(nanosecondsSinceEpoch());
+
+    const unsigned long version = current ? current->getVersion() + 1 : 0;
+
+    {
+        std::lock_guard<std::mutex> statsLock(statsMutex);
+        ++numberOfRefreshes;
+        publishedVersion = version;
+        publishedVertices = graphCopy->getNumberOfVertexIds();
+        publishedEdges = numberOfEdges;
+        publishedChangedEdges = numberOfChangedEdges;
+    }
+
+    std::atomic_store(&snapshot, std::make_shared<const GraphSnapshot>(version, graphCopy, publishedSymbols, threadPool, allPairs,
+                                                                       std::move(arbitrageCycles), alternativeRoutes,
+                                                                       cycleScanner));
+}
+
+
+
+// Sink for the parser: interns the symbols of every row and hands the rows to the graph in small batches,
+// so nothing grows with the size of the input. The caller holds writerMutex and publishes when the input is done
+class GraphManager::RateIngestor {
+private:
+    GraphManager& manager;
+    RateRecord batch[256];
+    size_t batchSize;
+    size_t numberOfRates;
+    size_t numberOfApplied;
+    size_t numberOfErrors;
+    ParseError firstError;
+    std::string readError;
+
+public:
+    explicit RateIngestor(GraphManager& manager) :
+            manager(manager), batchSize(0), numberOfRates(0), numberOfApplied(0), numberOfErrors(0), firstError{0, ""} {}
+
+    void operator()(const ParsedRate& rate) {
+        ++numberOfRates;
+
+        // rows setRate would ignore do not add their currencies either
+        if (!GraphManager::isValidPrice(rate.price) || (rate.from.length == rate.to.length &&
+                                                         std::memcmp(rate.from.data, rate.to.data, rate.from.length) == 0))
+            return;
+
+        // resolve the symbols once, new currencies are added to the graph
+        const uint32_t fromId = manager.addCurrency(rate.from.toString());
+        const uint32_t toId = manager.addCurrency(rate.to.toString());
+
+        batch[batchSize++] = {fromId, toId, rate.price};
+
+        if (batchSize == sizeof(batch) / sizeof(RateRecord))
+            flush();
+    }
+
+    void operator()(const ParseError& error) {
+        // line 0 is the input itself, it could not be opened or read
+        if (error.lineNumber == 0)
+            readError = error.message;
+
+        // malformed lines are skipped, the rest of the input is still used
+        else if (numberOfErrors++ == 0)
+            firstError = error;
+    }
+
+    // update the graph with the rows not applied yet, and report what was skipped. error tells why nothing was applied
+    size_t finish(const std::string& sourceName, std::string& error) {
+        flush();
+
+        if (!readError.empty()) {
+            KRYPTOS_TRACE(kError, kParser, "readError", readError);
+            error = readError;
+        }
+
+        if (numberOfErrors > 0) {
+            KRYPTOS_TRACE(kWarning, kParser, "skippedLines", std::to_string(numberOfErrors) + " line(s) of " +
+                          sourceName + ", line " + std::to_string(firstError.lineNumber) + ": " + firstError.message);
+        }
+
+        if (numberOfApplied < numberOfRates) {
+            KRYPTOS_TRACE(kWarning, kParser, "ignoredRates", std::to_string(numberOfRates - numberOfApplied) +
+                          " row(s) of " + sourceName + " with a price that is not positive and finite or a currency "
+                          "with itself");
+        }
+
+        // check for result size
+        if (numberOfApplied == 0) {
+            const std::string message = numberOfRates == 0 ? "no currency pairs were found in " + sourceName
+                                                           : "no currency pair of " + sourceName + " could be applied";
+            KRYPTOS_TRACE(kWarning, kParser, "noRates", message);
+            if (error.empty())
+                error = message;
+        }
+
+        return numberOfApplied;
+    }
+
+private:
+    void flush() {
+        numberOfApplied += manager.applyRates(batch, batchSize);
+        batchSize = 0;
+    }
+};
+
 /*! updateGraph - populate graph with data from given data
  *
  * @param fileName - file with data in format "from,to,price"
+ * @return - number of lines applied, 0 if the file could not be read or no row could be applied, error tells why
  */
-void GraphManager::updateGraph(const std::string fileName) {
+size_t GraphManager::updateGraph(const std::string& fileName, std::string& error) {
+    LatencyHistogram::Timer timer(latencies[kUpdateGraph]);
+    KRYPTOS_TRACE_SCOPE(kInfo, kUpdate, "updateGraph");
+    PerfCounters::Scope perfScope("updateGraph");
 
-    // call the parser to obtain the list of currencyPairs
-    std::list<CurrencyPair> pairs = parser->parseFileAndGetListOfCurrencies(fileName);
+    std::lock_guard<std::mutex> lock(writerMutex);
 
-    // check for result size
-    if (pairs.empty()) {
-        std::cout << "No currency pairs were found in the file '" << fileName << "'\n";
-        return;
+    // rows go to the graph while the file is read, queries keep seeing the previous snapshot until it is done
+    RateIngestor ingestor(*this);
+    parser->forEachRateInFile(fileName, ingestor, ingestor);
+
+    const size_t applied = ingestor.finish("the file '" + fileName + "'", error);
+    if (applied > 0)
+        publish();
+
+    return applied;
+}
+
+
+
+/*! updateGraphFromBuffer - populate graph with "from,to,price" lines held in memory
+ *
+ * @param data, length - the lines, parsed in place
+ * @return - number of lines applied
+ */
+size_t GraphManager::updateGraphFromBuffer(const char* data, size_t length) {
+    LatencyHistogram::Timer timer(latencies[kUpdateGraphFromBuffer]);
+    KRYPTOS_TRACE_SCOPE(kInfo, kUpdate, "updateGraphFromBuffer");
+    PerfCounters::Scope perfScope("updateGraphFromBuffer");
+
+    std::lock_guard<std::mutex> lock(writerMutex);
+
+    RateIngestor ingestor(*this);
+    parser->forEachRate(data, length, ingestor, ingestor);
+
+    // an empty buffer is a feed with nothing new, not an error, it is only traced
+    std::string error;
+    const size_t applied = ingestor.finish("the buffer", error);
+    if (applied > 0)
+        publish();
+
+    return applied;
+}
+
+
+
+/*! saveSnapshot - write the current graph and symbols to a binary file
+ *
+ * @return - false if the file could not be written, error tells why
+ */
+bool GraphManager::saveSnapshot(const std::string& fileName, bool withAllPairs, std::string& error) const {
+    return SnapshotFile::save(*getSnapshot(), withAllPairs, fileName, error);
+}
+
+
+
+/*! loadSnapshot - start from a file written by saveSnapshot
+ *
+ * The file is checked whole before the working copy changes. The symbols and edges are copied into the working copy,
+ * which stays updatable, and the saved all-pairs distances go to the first snapshot as they are
+ *
+ * @return - false if the file could not be loaded, error tells why
+ */
+bool GraphManager::loadSnapshot(const std::string& fileName, std::string& error) {
+    SnapshotFile file;
+    if (!file.load(fileName)) {
+        error = file.getError();
+        return false;
     }
 
-    // if for the first time graph is empty, we will need to add vertices while parsing pairs
-    bool shouldAddVertices = graph->isEmpty();
+    std::lock_guard<std::mutex> lock(writerMutex);
 
-    // temp values to store parsed symbols
-    std::string fromSymbol;
-    std::string toSymbol;
-    double price;
+    if (symbols.size() > 0) {
+        error = "a snapshot can only be loaded into an empty graph";
+        return false;
+    }
 
-    for (auto& pair: pairs) {
-        // get the values from the pair
-        fromSymbol = pair.getFromSymbol();
-        toSymbol = pair.getToSymbol();
-        price = pair.getPrice();
+    for (uint32_t id = 0; id < file.getNumberOfVertices(); ++id)
+        addCurrency(file.getSymbol(id));
+
+    // the weights are the saved logs, written as they are so the graph is exactly the saved one
+    std::vector< std::pair<unsigned int, double> > edges;
+    for (uint32_t from = 0; from < file.getNumberOfVertices(); ++from) {
+        file.getOutgoingEdges(from, edges);
+        for (auto& edge : edges)
+            graph->addEdgeById(from, edge.first, edge.second);
+        numberOfEdges += edges.size();
+    }
+
+    // every edge is new: the arbitrage detector checks the whole graph
+    pendingEdgeChanges.clear();
+    tooManyEdgeChanges = true;
+
+    publish(file.getAllPairs());
+    return true;
+}
 
-        // update the graph
-        if (shouldAddVertices) {
-            graph->addVertex(fromSymbol);
-            graph->addVertex(toSymbol);
-        }
 
-        if (fromSymbol == "USD" && toSymbol == "ZEC") {
-            std::cout << "";
+
+/*! startRecording - append every rate applied from now on to a tick log
+ *
+ * The current graph is written first as one batch, one rate per pair: both edges of a pair are set together
+ *
+ * @return - false if the log could not be opened, error tells why
+ */
+bool GraphManager::startRecording(const std::string& fileName, std::string& error) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+
+    if (!tickLog.open(fileName)) {
+        error = tickLog.getError();
+        return false;
+    }
+
+    for (uint32_t id = 0; id < symbols.size(); ++id)
+        tickLog.writeSymbol(id, symbols.getSymbol(id));
+
+    std::vector< std::pair<unsigned int, double> > edges;
+    for (uint32_t from = 0; from < graph->getNumberOfVertexIds(); ++from) {
+        graph->getOutgoingEdges(from, edges);
+        for (auto& edge : edges) {
+            if (from < edge.first || graph->getWeightById(edge.first, from) == INF)
+                tickLog.writeRate(from, edge.first, std::exp(edge.second));
         }
+    }
 
-        graph->addEdge(fromSymbol, toSymbol, price);
-        graph->addEdge(toSymbol, fromSymbol, 1.0/price);
+    tickLog.writePublish(nanosecondsSinceEpoch());
+    return true;
+}
+
+bool GraphManager::stopRecording(std::string& error) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+
+    if (!tickLog.close()) {
+        error = tickLog.getError();
+        return false;
     }
+
+    return true;
 }
 
 
@@ -79,24 +423,69 @@ void GraphManager::updateGraph(const std::string fileName) {
  * @return - the list of optimal currency pairs that will result in least amount of fees. If no pairs found, return empty list
  */
 std::list<CurrencyPair> GraphManager::findBestExchangeRoute(const std::string fromCurrency, const std::string toCurrency) const {
-    std::list<CurrencyPair> pairs = graph->getShortestPairsBetween(fromCurrency, toCurrency);
+    LatencyHistogram::Timer timer(latencies[kFindBestExchangeRoute]);
+    KRYPTOS_TRACE_SCOPE(kInfo, kQuery, "findBestExchangeRoute");
 
-//    pairs = graph->computeShortestDistanceBetweenVertices(fromCurrency, toCurrency);
+    const std::list<CurrencyPair> pairs = getSnapshot()->findBestExchangeRoute(fromCurrency, toCurrency);
 
-    if (!pairs.empty()) {
-        std::cout << "\nPairs:\n";
-        for (auto& pair : pairs)
-            std::cout << pair;
-        std::cout << "\n";
-    } else {
-        std::cout << "No pairs found!\n";
-    }
+    KRYPTOS_TRACE(kDebug, kQuery, "route", fromCurrency + " to " + toCurrency + ": " + std::to_string(pairs.size()) +
+                  " pair(s)");
 
     return pairs;
 }
 
 
 
+/*! findBestExchangeRoutes - best routes between many pairs of currencies
+ *
+ * @param routes - (fromCurrency, toCurrency) pairs of symbols
+ * @return - the pairs of every route, in the order of routes
+ */
+std::vector< std::list<CurrencyPair> > GraphManager::findBestExchangeRoutes(const std::vector< std::pair<std::string, std::string> >& routes) const {
+    LatencyHistogram::Timer timer(latencies[kFindBestExchangeRoutes]);
+    KRYPTOS_TRACE_SCOPE(kInfo, kQuery, "findBestExchangeRoutes");
+    return getSnapshot()->findBestExchangeRoutes(routes);
+}
+
+
+
+/*! getArbitrageCycles - profitable cycles of exchanges in the current graph
+ *
+ * @return - the cycles found when the current snapshot was published
+ */
+std::vector<ArbitrageCycle> GraphManager::getArbitrageCycles() const {
+    return getSnapshot()->getArbitrageCycles();
+}
+
+
+
+/*! findAlternativeRoutes - the k best routes between two currencies
+ *
+ * @param k - maximum number of routes
+ * @param maxHops - maximum number of pairs per route, 0 for no limit
+ * @return - the pairs of every route, best first
+ */
+std::vector< std::list<CurrencyPair> > GraphManager::findAlternativeRoutes(const std::string& fromCurrency, const std::string& toCurrency,
+                                                                          unsigned int k, unsigned int maxHops) const {
+    LatencyHistogram::Timer timer(latencies[kFindAlternativeRoutes]);
+    KRYPTOS_TRACE_SCOPE(kInfo, kQuery, "findAlternativeRoutes");
+    return getSnapshot()->findAlternativeRoutes(fromCurrency, toCurrency, k, maxHops);
+}
+
+
+
+/*! findShortArbitrageCycles - the most profitable cycles of up to maxLength pairs after fees
+ *
+ * @return - the cycles of the current snapshot, most profitable first
+ */
+std::vector<ArbitrageCycle> GraphManager::findShortArbitrageCycles(unsigned int maxLength, unsigned int topN, double feeRate) const {
+    LatencyHistogram::Timer timer(latencies[kFindShortArbitrageCycles]);
+    KRYPTOS_TRACE_SCOPE(kInfo, kQuery, "findShortArbitrageCycles");
+    return getSnapshot()->findShortArbitrageCycles(maxLength, topN, feeRate);
+}
+
+
+
 /*! getCostForExchange - return the cost of exchanging 2 currencies
  *
  * @param fromCurrency - source currency
@@ -105,9 +494,304 @@ std::list<CurrencyPair> GraphManager::findBestExchangeRoute(const std::string fr
  *          return 0.
  */
 double GraphManager::getCostForExchange(std::string fromCurrency, std::string toCurrency) const {
-    double result = graph->getWeight(fromCurrency, toCurrency);
-    if (result < 0 || result == INF)
-        result = 0;
+    LatencyHistogram::Timer timer(latencies[kGetCostForExchange], kLookupSamplingPeriod);
+    KRYPTOS_TRACE_SCOPE(kDebug, kQuery, "getCostForExchange");
+
+    // both ids and the price from the same version
+    const std::shared_ptr<const GraphSnapshot> current = getSnapshot();
+
+    const uint32_t fromId = current->getCurrencyId(fromCurrency);
+    const uint32_t toId = current->getCurrencyId(toCurrency);
+
+    if (fromId == SymbolTable::kInvalidId || toId == SymbolTable::kInvalidId)
+        return 0;
+
+    return current->getCostForExchange(fromId, toId);
+}
+
+
+
+uint32_t GraphManager::internCurrency(const std::string& symbol) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    return addCurrency(symbol);
+}
+
+uint32_t GraphManager::addCurrency(const std::string& symbol) {
+    const uint32_t numberOfCurrencies = symbols.size();
+    const uint32_t id = symbols.intern(symbol);
+
+    // a new symbol gets the next id, which is also the id of the next vertex added to the graph
+    if (id == numberOfCurrencies) {
+        graph->addVertex(symbol);
+        publishedSymbols.reset();
+        tickLog.writeSymbol(id, symbol);
+    }
+
+    return id;
+}
+
+uint32_t GraphManager::getCurrencyId(const std::string& symbol) const {
+    return getSnapshot()->getCurrencyId(symbol);
+}
+
+std::string GraphManager::getCurrencySymbol(uint32_t currencyId) const {
+    const std::shared_ptr<const GraphSnapshot> current = getSnapshot();
+
+    // ids interned since the last publish are not in the snapshot yet
+    if (currencyId >= current->getSymbols().size())
+        return std::string();
+
+    return current->getSymbols().getSymbol(currencyId);
+}
+
+
+
+/*! updateRate - set the price of a currency pair, in both directions
+ *
+ * @param fromCurrency, toCurrency - ids of the currencies
+ * @param price - price as in the data files: "from,to,price"
+ */
+void GraphManager::updateRate(uint32_t fromCurrency, uint32_t toCurrency, double price) {
+    LatencyHistogram::Timer timer(latencies[kUpdateRate]);
+    KRYPTOS_TRACE_SCOPE(kDebug, kUpdate, "updateRate");
+    std::lock_guard<std::mutex> lock(writerMutex);
+
+    if (setRate(fromCurrency, toCurrency, price))
+        publish();
+}
+
+
+
+/*! applyRateBatch - set the prices of many currency pairs at once
+ *
+ * @param records - array of (from id, to id, price)
+ * @return - number of records applied
+ */
+size_t GraphManager::applyRateBatch(const RateRecord* records, size_t numberOfRecords) {
+    LatencyHistogram::Timer timer(latencies[kApplyRateBatch]);
+    KRYPTOS_TRACE_SCOPE(kInfo, kUpdate, "applyRateBatch");
+    PerfCounters::Scope perfScope("applyRateBatch");
+    std::lock_guard<std::mutex> lock(writerMutex);
+
+    const size_t applied = applyRates(records, numberOfRecords);
+    if (applied > 0)
+        publish();
+
+    return applied;
+}
+
+size_t GraphManager::applyRates(const RateRecord* records, size_t numberOfRecords) {
+    PerfCounters::Scope perfScope("applyRates");
+    size_t applied = 0;
+
+    for (size_t i = 0; i < numberOfRecords; ++i) {
+        const RateRecord& record = records[i];
+
+        if (setRate(record.fromCurrency, record.toCurrency, record.rate))
+            ++applied;
+    }
+
+    return applied;
+}
+
+size_t GraphManager::applyRateBatch(const void* buffer, size_t sizeInBytes) {
+    LatencyHistogram::Timer timer(latencies[kApplyRateBatch]);
+    KRYPTOS_TRACE_SCOPE(kInfo, kUpdate, "applyRateBatch");
+    PerfCounters::Scope perfScope("applyRateBatch");
+    std::lock_guard<std::mutex> lock(writerMutex);
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(buffer);
+    const size_t numberOfRecords = sizeInBytes / sizeof(RateRecord);
+    size_t applied = 0;
+
+    // the buffer need not be aligned, copy it through a small aligned chunk on the stack
+    RateRecord chunk[256];
+    const size_t recordsPerChunk = sizeof(chunk) / sizeof(RateRecord);
+
+    for (size_t first = 0; first < numberOfRecords; first += recordsPerChunk) {
+        const size_t count = std::min(recordsPerChunk, numberOfRecords - first);
+        std::memcpy(chunk, bytes + first * sizeof(RateRecord), count * sizeof(RateRecord));
+        applied += applyRates(chunk, count);
+    }
+
+    if (applied > 0)
+        publish();
+
+    return applied;
+}
+
+
+
+bool GraphManager::isValidPrice(double price) {
+    // INF itself marks a missing edge
+    return price > 0 && price < INF;
+}
+
+
+
+/*! setRate - write the edges of a currency pair
+ *
+ * @return - false if the price was ignored
+ */
+bool GraphManager::setRate(uint32_t fromCurrency, uint32_t toCurrency, double price) {
+    // both edges of a currency with itself would be the same edge, the reverse one overwriting the forward one
+    if (fromCurrency >= symbols.size() || toCurrency >= symbols.size() || fromCurrency == toCurrency)
+        return false;
+
+    if (!isValidPrice(price))
+        return false;
+
+    // the reverse weight is the exact negation, so going back and forth sums up to exactly 0
+    const double weight = std::log(price);
+
+    // remember what changed, so the all-pairs distances can be patched instead of computed again. Readers may ask
+    // for the distances of the current snapshot at any time, so this does not depend on whether they exist yet
+    const double oldWeight = graph->getWeightById(fromCurrency, toCurrency);
+    const double oldReverseWeight = graph->getWeightById(toCurrency, fromCurrency);
+
+    if (!tooManyEdgeChanges) {
+        if (pendingEdgeChanges.size() + 2 > kMaxChangedEdgesPerVertex * graph->getNumberOfVertexIds()) {
+            tooManyEdgeChanges = true;
+            pendingEdgeChanges.clear();
+        } else {
+            pendingEdgeChanges.push_back({fromCurrency, toCurrency, oldWeight, weight});
+            pendingEdgeChanges.push_back({toCurrency, fromCurrency, oldReverseWeight, -weight});
+        }
+    }
+
+    // a missing edge weighs INF
+    numberOfEdges += (oldWeight == INF) + (oldReverseWeight == INF);
+
+    graph->addEdgeById(fromCurrency, toCurrency, weight);
+    graph->addEdgeById(toCurrency, fromCurrency, -weight);
+
+    tickLog.writeRate(fromCurrency, toCurrency, price);
+
+    return true;
+}
+
+
+
+/*! getShortestPathTree - best routes from given currency to every other currency
+ *
+ * @param fromCurrency - id of the source currency
+ * @return - tree with the best route to every currency, computed once per source until the next update. nullptr if
+ *           fromCurrency is not a known currency
+ */
+std::shared_ptr<const ShortestPathTree> GraphManager::getShortestPathTree(uint32_t fromCurrency) const {
+    return getSnapshot()->getShortestPathTree(fromCurrency);
+}
+
+
+
+/*! findBestExchangePath - ids of the currencies on the best route
+ *
+ * Weights are logs of the prices, so the shortest path is the route with the smallest total price
+ */
+std::vector<uint32_t> GraphManager::findBestExchangePath(uint32_t fromCurrency, uint32_t toCurrency) const {
+    LatencyHistogram::Timer timer(latencies[kFindBestExchangePath], kLookupSamplingPeriod);
+    KRYPTOS_TRACE_SCOPE(kDebug, kQuery, "findBestExchangePath");
+    return getSnapshot()->findBestExchangePath(fromCurrency, toCurrency);
+}
+
+
+
+/*! findBestExchangePaths - ids of the currencies on the best routes between many pairs
+ */
+std::vector< std::vector<uint32_t> > GraphManager::findBestExchangePaths(const std::vector< std::pair<uint32_t, uint32_t> >& routes) const {
+    LatencyHistogram::Timer timer(latencies[kFindBestExchangePaths]);
+    KRYPTOS_TRACE_SCOPE(kInfo, kQuery, "findBestExchangePaths");
+    return getSnapshot()->findBestExchangePaths(routes);
+}
+
+
+
+/*! findAlternativePaths - ids of the currencies on the k best routes between two currencies
+ */
+std::vector< std::vector<uint32_t> > GraphManager::findAlternativePaths(uint32_t fromCurrency, uint32_t toCurrency, unsigned int k,
+                                                                       unsigned int maxHops) const {
+    LatencyHistogram::Timer timer(latencies[kFindAlternativePaths]);
+    KRYPTOS_TRACE_SCOPE(kInfo, kQuery, "findAlternativePaths");
+    return getSnapshot()->findAlternativePaths(fromCurrency, toCurrency, k, maxHops);
+}
+
+
+
+/*! getCostForExchange - return the price of exchanging 2 currencies directly
+ *
+ * @return - the price stored for the pair, 0 if the currencies do not trade directly
+ */
+double GraphManager::getCostForExchange(uint32_t fromCurrency, uint32_t toCurrency) const {
+    LatencyHistogram::Timer timer(latencies[kGetCostForExchange], kLookupSamplingPeriod);
+    KRYPTOS_TRACE_SCOPE(kDebug, kQuery, "getCostForExchange");
+    return getSnapshot()->getCostForExchange(fromCurrency, toCurrency);
+}
+
+
+
+
+/*! setNumberOfThreads - number of threads used to compute the distances between all currencies
+ *
+ * @param numberOfThreads - 1 runs on the calling thread, 0 uses one thread per hardware thread
+ */
+void GraphManager::setNumberOfThreads(unsigned int numberOfThreads) {
+    if (numberOfThreads == 0)
+        numberOfThreads = ThreadPool::getHardwareConcurrency();
+
+    std::lock_guard<std::mutex> lock(writerMutex);
+
+    if (numberOfThreads == (threadPool ? threadPool->getNumberOfThreads() : 1))
+        return;
+
+    // snapshots still being queried keep the old pool alive, the next one uses the new pool
+    threadPool.reset(numberOfThreads > 1 ? new ThreadPool(numberOfThreads) : nullptr);
+    publish();
+}
+
+unsigned int GraphManager::getNumberOfThreads() const {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    return threadPool ? threadPool->getNumberOfThreads() : 1;
+}
+
+
+
+/*! getAllPairsShortestPaths - distances and next hops between all currencies
+ *
+ * @return - distances and next hops of the current snapshot indexed by currency id, computed on the first call.
+ *          Later snapshots patch them with the updated rates
+ */
+std::shared_ptr<const AllPairsShortestPaths> GraphManager::getAllPairsShortestPaths() const {
+    return getSnapshot()->getAllPairsShortestPaths();
+}
+
+
+
+/*! refreshAllPairs - compute the distances and next hops between all currencies
+ *
+ * Does nothing if they are already up to date
+ */
+void GraphManager::refreshAllPairs() {
+    getAllPairsShortestPaths();
+}
+
+
+
+/*! stats - call counts and latency percentiles of every operation, and the size of the latest snapshot
+ *
+ * Never waits for an update: the histograms are read without locks, the sizes under their own small lock
+ */
+GraphManagerStats GraphManager::stats() const {
+    GraphManagerStats result;
+
+    for (unsigned int operation = 0; operation < kNumberOfOperations; ++operation)
+        result.operations.push_back({kOperationNames[operation], latencies[operation].summarize()});
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    result.numberOfRefreshes = numberOfRefreshes;
+    result.version = publishedVersion;
+    result.numberOfVertices = publishedVertices;
+    result.numberOfEdges = publishedEdges;
+    result.numberOfChangedEdges = publishedChangedEdges;
 
     return result;
-}
\ No newline at end of file
+}
@@ -0,0 +1,337 @@
+// GraphSnapshot.cpp
+// GraphSnapshot Class Implementation
+
+#include <cmath>
+#include <functional>
+
+#include "GraphSnapshot.h"
+#include "Trace.h"
+
+// Constructor
+GraphSnapshot::GraphSnapshot(unsigned long version, std::shared_ptr<const Graph<std::string> > graph,
+                             std::shared_ptr<const SymbolTable> symbols, std::shared_ptr<ThreadPool> threadPool,
+                             std::shared_ptr<const AllPairsShortestPaths> allPairs, std::vector<ArbitrageCycle> arbitrageCycles,
+                             std::shared_ptr<const KShortestPaths> alternativeRoutes, std::shared_ptr<const CycleScanner> cycleScanner) :
+        version(version), graph(std::move(graph)), symbols(std::move(symbols)), threadPool(std::move(threadPool)),
+        arbitrageCycles(std::move(arbitrageCycles)), shortestPathTrees(this->graph->getNumberOfVertexIds()),
+        allPairs(std::move(allPairs)), alternativeRoutes(std::move(alternativeRoutes)), cycleScanner(std::move(cycleScanner))
+{
+}
+
+unsigned long GraphSnapshot::getVersion() const
+{
+    return version;
+}
+
+const Graph<std::string>& GraphSnapshot::getGraph() const
+{
+    return *graph;
+}
+
+const SymbolTable& GraphSnapshot::getSymbols() const
+{
+    return *symbols;
+}
+
+const std::vector<ArbitrageCycle>& GraphSnapshot::getArbitrageCycles() const
+{
+    return arbitrageCycles;
+}
+
+uint32_t GraphSnapshot::getCurrencyId(const std::string& symbol) const
+{
+    return symbols->lookUp(symbol);
+}
+
+
+
+/*! getShortestPathTree - best routes from given currency to every other currency
+ *
+ * @param fromCurrency - id of the source currency
+ * @return - tree with the best route to every currency of this version
+ */
+std::shared_ptr<const ShortestPathTree> GraphSnapshot::getShortestPathTree(uint32_t fromCurrency) const
+{
+    if (!isCurrency(fromCurrency))
+        return nullptr;
+
+    std::shared_ptr<const ShortestPathTree>& slot = shortestPathTrees[fromCurrency];
+
+    std::shared_ptr<const ShortestPathTree> tree = std::atomic_load(&slot);
+    if (!tree) {
+        tree = std::make_shared<const ShortestPathTree>(graph->computeShortestPathTree(fromCurrency));
+        std::atomic_store(&slot, tree);
+    }
+
+    return tree;
+}
+
+
+
+/*! getAllPairsShortestPaths - distances and next hops between all currencies
+ *
+ * Threads asking while the first one computes wait for its result
+ */
+std::shared_ptr<const AllPairsShortestPaths> GraphSnapshot::getAllPairsShortestPaths() const
+{
+    std::call_once(allPairsComputed, [this]() {
+        if (std::atomic_load(&allPairs))
+            return;
+
+        KRYPTOS_TRACE_SCOPE(kInfo, kQuery, "computeAllPairs");
+        std::shared_ptr<AllPairsShortestPaths> distances = std::make_shared<AllPairsShortestPaths>(0, true);
+        distances->load(*graph);
+        distances->compute(threadPool.get());
+        std::atomic_store(&allPairs, std::shared_ptr<const AllPairsShortestPaths>(distances));
+    });
+
+    return std::atomic_load(&allPairs);
+}
+
+std::shared_ptr<const AllPairsShortestPaths> GraphSnapshot::getComputedAllPairs() const
+{
+    return std::atomic_load(&allPairs);
+}
+
+std::shared_ptr<const KShortestPaths> GraphSnapshot::getBuiltAlternativeRoutes() const
+{
+    return std::atomic_load(&alternativeRoutes);
+}
+
+std::shared_ptr<const CycleScanner> GraphSnapshot::getBuiltCycleScanner() const
+{
+    return std::atomic_load(&cycleScanner);
+}
+
+
+
+/*! findBestExchangePath - ids of the currencies on the best route
+ *
+ * Routes are read from the all-pairs next hops if they were computed for this version and give one,
+ * from the shortest path tree of fromCurrency otherwise
+ */
+std::vector<uint32_t> GraphSnapshot::findBestExchangePath(uint32_t fromCurrency, uint32_t toCurrency) const
+{
+    std::vector<unsigned int> path;
+    if (!isCurrency(fromCurrency) || !isCurrency(toCurrency))
+        return std::vector<uint32_t>();
+
+    const std::shared_ptr<const AllPairsShortestPaths> distances = getComputedAllPairs();
+    if (distances)
+        distances->getRoute(fromCurrency, toCurrency, path);
+
+    // next hops that run into a negative cycle give no route, the tree leaves the edges that close cycles out
+    if (path.empty())
+        path = getShortestPathTree(fromCurrency)->getPath(toCurrency);
+
+    // no route at all, fall back to the direct pair if there is one
+    if (path.empty() && fromCurrency != toCurrency && graph->getWeightById(fromCurrency, toCurrency) != INF) {
+        path.push_back(fromCurrency);
+        path.push_back(toCurrency);
+    }
+
+    return std::vector<uint32_t>(path.begin(), path.end());
+}
+
+
+
+/*! findBestExchangeRoute - currency pairs on the best route
+ *
+ * @return - the pairs with their prices, empty if either currency is unknown or there is no route
+ */
+std::list<CurrencyPair> GraphSnapshot::findBestExchangeRoute(const std::string& fromCurrency, const std::string& toCurrency) const
+{
+    const uint32_t fromId = getCurrencyId(fromCurrency);
+    const uint32_t toId = getCurrencyId(toCurrency);
+
+    if (fromId == SymbolTable::kInvalidId || toId == SymbolTable::kInvalidId)
+        return std::list<CurrencyPair>();
+
+    return constructRoute(findBestExchangePath(fromId, toId));
+}
+
+
+
+/*! findBestExchangePaths - ids of the currencies on the best routes between many pairs
+ *
+ * Routes from the same source share one tree. The trees not cached yet are computed first, one source per iteration
+ * of the thread pool, then every route is read from its tree
+ */
+std::vector< std::vector<uint32_t> > GraphSnapshot::findBestExchangePaths(const std::vector< std::pair<uint32_t, uint32_t> >& routes) const
+{
+    const unsigned int numberOfVertices = graph->getNumberOfVertexIds();
+
+    // all-pairs next hops answer every route directly, trees are only needed without them
+    if (!getComputedAllPairs()) {
+        std::vector<uint32_t> sources;
+        std::vector<bool> isSource(numberOfVertices, false);
+
+        for (auto& route : routes) {
+            if (route.first < numberOfVertices && !isSource[route.first]) {
+                isSource[route.first] = true;
+                sources.push_back(route.first);
+            }
+        }
+
+        const std::function<void(size_t)> computeTree = [&](size_t i) {
+            getShortestPathTree(sources[i]);
+        };
+
+        if (threadPool)
+            threadPool->parallelFor(sources.size(), computeTree);
+        else
+            for (size_t i = 0; i < sources.size(); ++i)
+                computeTree(i);
+    }
+
+    std::vector< std::vector<uint32_t> > paths(routes.size());
+    for (size_t i = 0; i < routes.size(); ++i) {
+        if (routes[i].first < numberOfVertices && routes[i].second < numberOfVertices)
+            paths[i] = findBestExchangePath(routes[i].first, routes[i].second);
+    }
+
+    return paths;
+}
+
+
+
+/*! findBestExchangeRoutes - currency pairs on the best routes between many pairs of symbols
+ *
+ * @return - one list of pairs per entry of routes, empty where either currency is unknown or there is no route
+ */
+std::vector< std::list<CurrencyPair> > GraphSnapshot::findBestExchangeRoutes(const std::vector< std::pair<std::string, std::string> >& routes) const
+{
+    // unknown symbols get an id past the last currency, which findBestExchangePaths answers with an empty path
+    const uint32_t unknown = graph->getNumberOfVertexIds();
+
+    std::vector< std::pair<uint32_t, uint32_t> > ids;
+    ids.reserve(routes.size());
+    for (auto& route : routes) {
+        const uint32_t fromId = getCurrencyId(route.first);
+        const uint32_t toId = getCurrencyId(route.second);
+        ids.emplace_back(fromId == SymbolTable::kInvalidId ? unknown : fromId, toId == SymbolTable::kInvalidId ? unknown : toId);
+    }
+
+    const std::vector< std::vector<uint32_t> > paths = findBestExchangePaths(ids);
+
+    std::vector< std::list<CurrencyPair> > pairs;
+    pairs.reserve(paths.size());
+    for (auto& path : paths)
+        pairs.push_back(constructRoute(path));
+
+    return pairs;
+}
+
+
+
+/*! findAlternativePaths - the k best routes between two currencies
+ *
+ * The edges are laid out for the search once per snapshot, unless the manager patched the layout of the previous one,
+ * then every query only searches
+ */
+std::vector< std::vector<uint32_t> > GraphSnapshot::findAlternativePaths(uint32_t fromCurrency, uint32_t toCurrency, unsigned int k,
+                                                                        unsigned int maxHops) const
+{
+    std::call_once(alternativeRoutesBuilt, [this]() {
+        if (!std::atomic_load(&alternativeRoutes))
+            std::atomic_store(&alternativeRoutes, std::shared_ptr<const KShortestPaths>(new KShortestPaths(*graph)));
+    });
+
+    const std::vector<KShortestPaths::Route> routes = std::atomic_load(&alternativeRoutes)->find(fromCurrency, toCurrency, k, maxHops);
+
+    std::vector< std::vector<uint32_t> > paths;
+    paths.reserve(routes.size());
+    for (auto& route : routes)
+        paths.emplace_back(route.path.begin(), route.path.end());
+
+    return paths;
+}
+
+
+
+/*! findAlternativeRoutes - currency pairs on the k best routes between two currencies
+ *
+ * @return - one list of pairs per route, best first. Empty if either currency is unknown or there is no route
+ */
+std::vector< std::list<CurrencyPair> > GraphSnapshot::findAlternativeRoutes(const std::string& fromCurrency, const std::string& toCurrency,
+                                                                           unsigned int k, unsigned int maxHops) const
+{
+    std::vector< std::list<CurrencyPair> > pairs;
+
+    const uint32_t fromId = getCurrencyId(fromCurrency);
+    const uint32_t toId = getCurrencyId(toCurrency);
+
+    if (fromId == SymbolTable::kInvalidId || toId == SymbolTable::kInvalidId)
+        return pairs;
+
+    for (auto& path : findAlternativePaths(fromId, toId, k, maxHops))
+        pairs.push_back(constructRoute(path));
+
+    return pairs;
+}
+
+
+
+/*! findShortArbitrageCycles - the most profitable short cycles after fees
+ *
+ * The rates are laid out for the scan once per snapshot, unless the manager patched the layout of the previous one.
+ * Every scan then runs on the thread pool
+ */
+std::vector<ArbitrageCycle> GraphSnapshot::findShortArbitrageCycles(unsigned int maxLength, unsigned int topN, double feeRate) const
+{
+    std::call_once(cycleScannerBuilt, [this]() {
+        if (!std::atomic_load(&cycleScanner))
+            std::atomic_store(&cycleScanner, std::shared_ptr<const CycleScanner>(new CycleScanner(*graph)));
+    });
+
+    std::vector<ArbitrageCycle> cycles;
+    for (auto& opportunity : std::atomic_load(&cycleScanner)->scan(maxLength, topN, feeRate, 0, threadPool.get())) {
+        // back to the first currency
+        std::vector<uint32_t> path(opportunity.vertices.begin(), opportunity.vertices.end());
+        path.push_back(path.front());
+
+        cycles.push_back({constructRoute(path), opportunity.profit});
+    }
+
+    return cycles;
+}
+
+
+
+/*! constructRoute - convert a path of ids to the currency pairs along it
+ *
+ * Ids are converted back to symbols only for the output
+ */
+std::list<CurrencyPair> GraphSnapshot::constructRoute(const std::vector<uint32_t>& path) const
+{
+    std::list<CurrencyPair> pairs;
+
+    for (unsigned int i = 1; i < path.size(); ++i)
+        pairs.emplace_back(symbols->getSymbol(path[i - 1]), symbols->getSymbol(path[i]), getCostForExchange(path[i - 1], path[i]));
+
+    return pairs;
+}
+
+
+
+/*! getCostForExchange - return the price of exchanging 2 currencies directly
+ *
+ * @return - the price stored for the pair, 0 if the currencies do not trade directly
+ */
+double GraphSnapshot::getCostForExchange(uint32_t fromCurrency, uint32_t toCurrency) const
+{
+    if (!isCurrency(fromCurrency) || !isCurrency(toCurrency))
+        return 0;
+
+    const double weight = graph->getWeightById(fromCurrency, toCurrency);
+    if (weight == INF)
+        return 0;
+
+    // weights are logs of the prices
+    return std::exp(weight);
+}
+
+bool GraphSnapshot::isCurrency(uint32_t currencyId) const
+{
+    return currencyId < graph->getNumberOfVertexIds();
+}
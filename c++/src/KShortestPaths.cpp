@@ -0,0 +1,470 @@
+// KShortestPaths.cpp
+// KShortestPaths Class Implementation
+
+#include "KShortestPaths.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <set>
+
+// missing distances are +infinity, so sums with them need no INF checks
+static const double kInfinity = std::numeric_limits<double>::infinity();
+
+// State shared by all the searches of one query. Buffers are sized once, and every search only resets what the
+// previous one wrote
+struct KShortestPaths::Search {
+    // best distance from the spur vertex found in the rounds done so far
+    std::vector<double> distances;
+
+    // (round, previous vertex) of every improvement of a vertex's distance, in order of rounds. The route of at most
+    // r edges to v ends with the edge from the previous vertex of the last improvement of v up to round r
+    std::vector< std::vector< std::pair<unsigned int, unsigned int> > > improvements;
+
+    // vertices with a finite distance
+    std::vector<unsigned int> touched;
+
+    // vertices improved in the last round, the only ones whose edges need to be relaxed in the next
+    std::vector<unsigned int> frontier;
+    std::vector<double> frontierDistances;
+    std::vector<unsigned int> nextFrontier;
+    std::vector<bool> inNextFrontier;
+
+    // excluded by the root of the current spur: its vertices before the spur vertex, and the edges leaving the spur
+    // vertex that earlier routes with the same root took
+    std::vector<bool> blockedVertices;
+    std::vector<unsigned int> blockedTargets;
+
+    // lower bound on the distance from every vertex to the destination, computed once per query, and the vertex after
+    // it on the route that gave the bound, -1 for the destination and the vertices that cannot reach it
+    std::vector<double> distancesToTarget;
+    std::vector<int> nextHopsToTarget;
+
+    // position of every vertex in the path being made simple, -1 if not in it
+    std::vector<int> positions;
+
+    explicit Search(unsigned int numberOfVertices) :
+            distances(numberOfVertices, kInfinity), improvements(numberOfVertices), inNextFrontier(numberOfVertices, false),
+            blockedVertices(numberOfVertices, false), distancesToTarget(numberOfVertices, kInfinity),
+            nextHopsToTarget(numberOfVertices, -1), positions(numberOfVertices, -1) {}
+
+    // the improvement that gave v its distance after 'round' rounds, nullptr for the spur vertex
+    const std::pair<unsigned int, unsigned int>* getLastImprovement(unsigned int v, unsigned int round) const
+    {
+        const std::vector< std::pair<unsigned int, unsigned int> >& history = improvements[v];
+        auto last = std::upper_bound(history.begin(), history.end(),
+                                     std::make_pair(round, std::numeric_limits<unsigned int>::max()));
+
+        return last == history.begin() ? nullptr : &*(last - 1);
+    }
+
+    // true if vertex is on the route of at most 'round' edges from the spur vertex to end
+    bool isOnRoute(unsigned int vertex, unsigned int end, unsigned int round) const
+    {
+        for (unsigned int v = end; v != vertex; ) {
+            const std::pair<unsigned int, unsigned int>* last = getLastImprovement(v, round);
+            if (last == nullptr)
+                return false;
+
+            round = last->first - 1;
+            v = last->second;
+        }
+
+        return true;
+    }
+
+    // true if vertex is on the route that gave the lower bound of 'start'
+    bool isOnRouteToTarget(unsigned int vertex, unsigned int start) const
+    {
+        for (int v = (int) start; v != -1; v = nextHopsToTarget[v]) {
+            if (v == (int) vertex)
+                return true;
+        }
+
+        return false;
+    }
+
+    // cut the cycles out of a walk, keeping its first and last vertex
+    void eraseLoops(std::vector<unsigned int>& path)
+    {
+        std::vector<unsigned int> simplePath;
+        simplePath.reserve(path.size());
+
+        for (unsigned int vertex : path) {
+            if (positions[vertex] >= 0) {
+                // back at a vertex of the path: drop the cycle that just closed
+                const size_t length = (size_t) positions[vertex] + 1;
+                for (size_t i = length; i < simplePath.size(); ++i)
+                    positions[simplePath[i]] = -1;
+                simplePath.resize(length);
+            } else {
+                positions[vertex] = (int) simplePath.size();
+                simplePath.push_back(vertex);
+            }
+        }
+
+        for (unsigned int vertex : simplePath)
+            positions[vertex] = -1;
+
+        path.swap(simplePath);
+    }
+};
+
+// routes waiting to be returned, cheapest first. The deviation is the index of the vertex where the route leaves the
+// route it was derived from: the spurs before it were already searched
+struct Candidate {
+    KShortestPaths::Route route;
+    unsigned int deviation;
+
+    bool operator<(const Candidate& other) const
+    {
+        if (route.weight != other.route.weight)
+            return route.weight < other.route.weight;
+        return route.path < other.route.path;
+    }
+};
+
+void KShortestPaths::buildRows(const std::vector< std::vector< std::pair<unsigned int, double> > >& edges)
+{
+    outgoingOffsets.assign(numberOfVertices + 1, 0);
+    incomingOffsets.assign(numberOfVertices + 1, 0);
+
+    for (unsigned int from = 0; from < numberOfVertices; ++from) {
+        outgoingOffsets[from + 1] = outgoingOffsets[from] + (unsigned int) edges[from].size();
+        for (auto& edge : edges[from])
+            ++incomingOffsets[edge.first + 1];
+    }
+
+    for (unsigned int to = 0; to < numberOfVertices; ++to)
+        incomingOffsets[to + 1] += incomingOffsets[to];
+
+    outgoingTargets.resize(outgoingOffsets[numberOfVertices]);
+    outgoingWeights.resize(outgoingOffsets[numberOfVertices]);
+    incomingSources.resize(incomingOffsets[numberOfVertices]);
+    incomingWeights.resize(incomingOffsets[numberOfVertices]);
+
+    std::vector<unsigned int> nextIncoming(incomingOffsets.begin(), incomingOffsets.end() - 1);
+
+    for (unsigned int from = 0; from < numberOfVertices; ++from) {
+        unsigned int position = outgoingOffsets[from];
+        for (auto& edge : edges[from]) {
+            outgoingTargets[position] = edge.first;
+            outgoingWeights[position++] = edge.second;
+
+            const unsigned int incoming = nextIncoming[edge.first]++;
+            incomingSources[incoming] = from;
+            incomingWeights[incoming] = edge.second;
+        }
+    }
+}
+
+unsigned int KShortestPaths::getNumberOfVertices() const
+{
+    return numberOfVertices;
+}
+
+bool KShortestPaths::applyEdgeChanges(const std::vector<AllPairsShortestPaths::EdgeChange>& changes)
+{
+    for (auto& change : changes) {
+        if (change.from >= numberOfVertices || change.to >= numberOfVertices)
+            return false;
+
+        if (change.from != change.to && (change.oldWeight == INF) != (change.newWeight == INF))
+            return false;
+    }
+
+    for (auto& change : changes) {
+        if (change.from == change.to || change.newWeight == INF)
+            continue;
+
+        for (unsigned int e = outgoingOffsets[change.from]; e < outgoingOffsets[change.from + 1]; ++e) {
+            if (outgoingTargets[e] == change.to)
+                outgoingWeights[e] = change.newWeight;
+        }
+
+        for (unsigned int e = incomingOffsets[change.to]; e < incomingOffsets[change.to + 1]; ++e) {
+            if (incomingSources[e] == change.from)
+                incomingWeights[e] = change.newWeight;
+        }
+    }
+
+    return true;
+}
+
+double KShortestPaths::getWeight(unsigned int from, unsigned int to) const
+{
+    for (unsigned int e = outgoingOffsets[from]; e < outgoingOffsets[from + 1]; ++e) {
+        if (outgoingTargets[e] == to)
+            return outgoingWeights[e];
+    }
+
+    return INF;
+}
+
+double KShortestPaths::getPathWeight(const std::vector<unsigned int>& path) const
+{
+    double weight = 0;
+    for (size_t i = 1; i < path.size(); ++i)
+        weight += getWeight(path[i - 1], path[i]);
+
+    return weight;
+}
+
+
+
+/*! computeDistancesToTarget - Bellman-Ford rounds over the incoming edges, starting from 'to'
+ *
+ * Distances are updated in place, so a round may already use routes with more edges than the round number: the result
+ * can only be lower than the true distance, which is all a lower bound needs.
+ *
+ * A relaxation that would put a vertex on its own route to 'to' means a negative cycle, which would otherwise lower the
+ * distances of every vertex that reaches it on each round until maxHops. It is skipped, like in
+ * Graph::computeShortestPathTree, so the rounds end, and since no bound holds past such a cycle every reachable vertex
+ * gets -infinity: the spur searches are then not pruned but still only search the vertices that can reach 'to'
+ */
+void KShortestPaths::computeDistancesToTarget(unsigned int to, unsigned int maxHops, Search& search) const
+{
+    std::vector<double>& distances = search.distancesToTarget;
+    distances[to] = 0;
+
+    bool negativeCycle = false;
+
+    search.frontier.assign(1, to);
+
+    for (unsigned int round = 0; round < maxHops && !search.frontier.empty(); ++round) {
+        search.nextFrontier.clear();
+
+        for (unsigned int v : search.frontier) {
+            const double distance = distances[v];
+
+            for (unsigned int e = incomingOffsets[v]; e < incomingOffsets[v + 1]; ++e) {
+                const unsigned int u = incomingSources[e];
+                const double viaV = distance + incomingWeights[e];
+
+                if (viaV < distances[u] - kRelaxationEpsilon) {
+                    if (distances[u] != kInfinity && search.isOnRouteToTarget(u, v)) {
+                        negativeCycle = true;
+                        continue;
+                    }
+
+                    distances[u] = viaV;
+                    search.nextHopsToTarget[u] = (int) v;
+                    if (!search.inNextFrontier[u]) {
+                        search.inNextFrontier[u] = true;
+                        search.nextFrontier.push_back(u);
+                    }
+                }
+            }
+        }
+
+        for (unsigned int u : search.nextFrontier)
+            search.inNextFrontier[u] = false;
+        search.frontier.swap(search.nextFrontier);
+    }
+
+    if (negativeCycle) {
+        for (double& distance : distances) {
+            if (distance != kInfinity)
+                distance = -kInfinity;
+        }
+    }
+}
+
+
+
+/*! searchSpur - hop limited Bellman-Ford from the spur vertex
+ *
+ * Round r relaxes the edges of the vertices improved in round r - 1, with their distances from the end of that round,
+ * so after round r every distance is that of the best route of at most r edges.
+ *
+ * A relaxation of an edge to a vertex already on the route it extends would turn the route into a walk around a
+ * negative cycle. It is skipped, so every route stays simple and the rounds end once only the vertices of the cycle
+ * would keep improving, instead of going around it until maxHops
+ */
+bool KShortestPaths::searchSpur(unsigned int spur, unsigned int to, unsigned int maxHops, double budget, Search& search,
+                                std::vector<unsigned int>& path) const
+{
+    for (unsigned int v : search.touched) {
+        search.distances[v] = kInfinity;
+        search.improvements[v].clear();
+    }
+    search.touched.assign(1, spur);
+
+    search.distances[spur] = 0;
+    search.frontier.assign(1, spur);
+
+    unsigned int round = 0;
+    while (round < maxHops && !search.frontier.empty()) {
+        ++round;
+
+        search.frontierDistances.clear();
+        for (unsigned int u : search.frontier)
+            search.frontierDistances.push_back(search.distances[u]);
+
+        search.nextFrontier.clear();
+
+        for (size_t i = 0; i < search.frontier.size(); ++i) {
+            const unsigned int u = search.frontier[i];
+            const double distance = search.frontierDistances[i];
+
+            for (unsigned int e = outgoingOffsets[u]; e < outgoingOffsets[u + 1]; ++e) {
+                const unsigned int v = outgoingTargets[e];
+
+                if (search.blockedVertices[v])
+                    continue;
+
+                if (u == spur && std::find(search.blockedTargets.begin(), search.blockedTargets.end(), v) != search.blockedTargets.end())
+                    continue;
+
+                const double viaU = distance + outgoingWeights[e];
+
+                // no route through v can end below the budget
+                if (!(viaU + search.distancesToTarget[v] < budget))
+                    continue;
+
+                if (viaU < search.distances[v] - kRelaxationEpsilon) {
+                    // the vertices on the route to u all have a distance already
+                    if (search.distances[v] == kInfinity)
+                        search.touched.push_back(v);
+                    else if (search.isOnRoute(v, u, round - 1))
+                        continue;
+                    search.distances[v] = viaU;
+
+                    // several improvements in one round: only the last one counts
+                    std::vector< std::pair<unsigned int, unsigned int> >& history = search.improvements[v];
+                    if (!history.empty() && history.back().first == round)
+                        history.back().second = u;
+                    else
+                        history.emplace_back(round, u);
+
+                    // routes end at the destination, going on from it cannot give a simple route
+                    if (v != to && !search.inNextFrontier[v]) {
+                        search.inNextFrontier[v] = true;
+                        search.nextFrontier.push_back(v);
+                    }
+                }
+            }
+        }
+
+        for (unsigned int v : search.nextFrontier)
+            search.inNextFrontier[v] = false;
+        search.frontier.swap(search.nextFrontier);
+    }
+
+    if (search.distances[to] == kInfinity)
+        return false;
+
+    // walk back from the destination through the improvements, each step goes one round back
+    path.clear();
+    unsigned int v = to;
+    for (;;) {
+        path.push_back(v);
+
+        const std::pair<unsigned int, unsigned int>* last = search.getLastImprovement(v, round);
+        if (last == nullptr)
+            break; // the spur vertex, at distance 0 before the first round
+
+        round = last->first - 1;
+        v = last->second;
+    }
+
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+
+
+/*! find - Yen's algorithm
+ *
+ * Every route found so far is a template for more: for each vertex along it (the spur), the best route that follows it
+ * up to the spur and then leaves it by an edge no earlier route with the same beginning took is a candidate.
+ * The cheapest candidate is the next route
+ */
+std::vector<KShortestPaths::Route> KShortestPaths::find(unsigned int from, unsigned int to, unsigned int k, unsigned int maxHops) const
+{
+    std::vector<Route> routes;
+
+    if (k == 0 || from >= numberOfVertices || to >= numberOfVertices || from == to)
+        return routes;
+
+    // a simple route has at most V - 1 edges
+    const unsigned int hopLimit = (maxHops == 0 || maxHops > numberOfVertices - 1) ? numberOfVertices - 1 : maxHops;
+
+    Search search(numberOfVertices);
+    computeDistancesToTarget(to, hopLimit, search);
+
+    std::vector<unsigned int> path;
+    if (search.distancesToTarget[from] == kInfinity || !searchSpur(from, to, hopLimit, kInfinity, search, path))
+        return routes;
+
+    search.eraseLoops(path);
+    routes.push_back({path, getPathWeight(path)});
+    std::vector<unsigned int> deviations(1, 0);
+
+    std::set<Candidate> candidates;
+
+    while (routes.size() < k) {
+        const Route previous = routes.back();
+        double rootWeight = 0;
+
+        for (unsigned int i = 0; i + 1 < previous.path.size(); ++i) {
+            if (i > 0)
+                rootWeight += getWeight(previous.path[i - 1], previous.path[i]);
+
+            // the spurs before the deviation were searched with the route this one came from
+            if (i < deviations.back())
+                continue;
+
+            const unsigned int spur = previous.path[i];
+
+            // candidates past the number of routes still needed will never be returned, nor will anything above them
+            const size_t needed = k - routes.size();
+            double budget = kInfinity;
+            if (candidates.size() >= needed)
+                budget = std::next(candidates.begin(), needed - 1)->route.weight;
+
+            if (!(rootWeight + search.distancesToTarget[spur] < budget))
+                continue;
+
+            for (unsigned int j = 0; j < i; ++j)
+                search.blockedVertices[previous.path[j]] = true;
+
+            search.blockedTargets.clear();
+            for (auto& route : routes) {
+                if (route.path.size() > i + 1 && std::equal(previous.path.begin(), previous.path.begin() + i + 1, route.path.begin()))
+                    search.blockedTargets.push_back(route.path[i + 1]);
+            }
+
+            const bool found = searchSpur(spur, to, hopLimit - i, budget - rootWeight, search, path);
+
+            for (unsigned int j = 0; j < i; ++j)
+                search.blockedVertices[previous.path[j]] = false;
+
+            if (!found)
+                continue;
+
+            path.insert(path.begin(), previous.path.begin(), previous.path.begin() + i);
+            search.eraseLoops(path);
+
+            // cutting cycles out of a walk can lead back to a route already returned
+            bool isNew = true;
+            for (auto& route : routes)
+                isNew = isNew && route.path != path;
+
+            if (isNew) {
+                candidates.insert({{path, getPathWeight(path)}, i});
+                if (candidates.size() > needed)
+                    candidates.erase(std::prev(candidates.end()));
+            }
+        }
+
+        if (candidates.empty())
+            break;
+
+        routes.push_back(candidates.begin()->route);
+        deviations.push_back(candidates.begin()->deviation);
+        candidates.erase(candidates.begin());
+    }
+
+    return routes;
+}
@@ -0,0 +1,114 @@
+// LatencyHistogram.cpp
+// LatencyHistogram Class Implementation
+
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const unsigned int kSubBuckets = 1u << LatencyHistogram::kSubBucketBits;
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+/*! bucketOf - bucket of a value
+ *
+ * Values below 32 have a bucket each. Above, a value with its highest bit at position e falls in the group of
+ * buckets of e, at the sub-bucket given by the next 5 bits
+ */
+unsigned int LatencyHistogram::bucketOf(uint64_t nanoseconds)
+{
+    if (nanoseconds < kSubBuckets)
+        return (unsigned int) nanoseconds;
+
+    const unsigned int highestBit = 63 - (unsigned int) __builtin_clzll(nanoseconds);
+    const unsigned int shift = highestBit - kSubBucketBits;
+    const unsigned int subBucket = (unsigned int) (nanoseconds >> shift) - kSubBuckets;
+
+    return std::min((shift + 1) * kSubBuckets + subBucket, kNumberOfBuckets - 1);
+}
+
+uint64_t LatencyHistogram::highestValueOf(unsigned int bucket)
+{
+    if (bucket < kSubBuckets)
+        return bucket;
+
+    const unsigned int shift = bucket / kSubBuckets - 1;
+    const uint64_t lowest = (uint64_t) (kSubBuckets + bucket % kSubBuckets) << shift;
+
+    return lowest + ((uint64_t) 1 << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds)
+{
+    countCall();
+    recordSample(nanoseconds);
+}
+
+uint64_t LatencyHistogram::countCall()
+{
+    return numberOfCalls.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::recordSample(uint64_t nanoseconds)
+{
+    counts[bucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    uint64_t max = maxNanoseconds.load(std::memory_order_relaxed);
+    while (nanoseconds > max && !maxNanoseconds.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+/*! summarize - count, mean and percentiles of the values recorded so far
+ *
+ * The counters are copied once, every percentile is read from the same copy
+ */
+LatencyHistogram::Summary LatencyHistogram::summarize() const
+{
+    uint64_t copy[kNumberOfBuckets];
+    uint64_t count = 0;
+    for (unsigned int bucket = 0; bucket < kNumberOfBuckets; ++bucket) {
+        copy[bucket] = counts[bucket].load(std::memory_order_relaxed);
+        count += copy[bucket];
+    }
+
+    Summary summary = Summary();
+    summary.count = numberOfCalls.load(std::memory_order_relaxed);
+    summary.sampleCount = count;
+    if (count == 0)
+        return summary;
+
+    summary.maxNanoseconds = maxNanoseconds.load(std::memory_order_relaxed);
+    summary.meanNanoseconds = (double) totalNanoseconds.load(std::memory_order_relaxed) / count;
+
+    const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+    uint64_t* const values[] = { &summary.p50Nanoseconds, &summary.p90Nanoseconds, &summary.p99Nanoseconds,
+                                 &summary.p999Nanoseconds };
+
+    unsigned int bucket = 0;
+    uint64_t below = copy[0];
+    for (unsigned int i = 0; i < 4; ++i) {
+        // the value of rank ceil(q * count), counting from 1
+        const uint64_t rank = std::max<uint64_t>(1, (uint64_t) std::ceil(quantiles[i] * count));
+        while (below < rank && bucket + 1 < kNumberOfBuckets)
+            below += copy[++bucket];
+
+        // a bucket holds values up to its highest value, none of them above the maximum
+        *values[i] = std::min(highestValueOf(bucket), summary.maxNanoseconds);
+    }
+
+    return summary;
+}
+
+void LatencyHistogram::reset()
+{
+    for (unsigned int bucket = 0; bucket < kNumberOfBuckets; ++bucket)
+        counts[bucket].store(0, std::memory_order_relaxed);
+
+    numberOfCalls.store(0, std::memory_order_relaxed);
+    totalNanoseconds.store(0, std::memory_order_relaxed);
+    maxNanoseconds.store(0, std::memory_order_relaxed);
+}
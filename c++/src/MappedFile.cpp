@@ -0,0 +1,126 @@
+// MappedFile.cpp
+// MappedFile Class Implementation
+
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Constructors
+MappedFile::MappedFile() : data(nullptr), size(0), open(false)
+{
+}
+
+MappedFile::MappedFile(const std::string& fileName, Access access) : data(nullptr), size(0), open(false)
+{
+    map(fileName, access);
+}
+
+MappedFile::MappedFile(MappedFile&& other) :
+        data(other.data), size(other.size), open(other.open), error(std::move(other.error))
+{
+    other.data = nullptr;
+    other.size = 0;
+    other.open = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other)
+{
+    if (this != &other) {
+        unmap();
+        data = other.data;
+        size = other.size;
+        open = other.open;
+        error = std::move(other.error);
+
+        other.data = nullptr;
+        other.size = 0;
+        other.open = false;
+    }
+
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+void MappedFile::unmap()
+{
+    if (data != nullptr)
+        munmap(const_cast<char*>(data), size);
+
+    data = nullptr;
+    size = 0;
+    open = false;
+}
+
+bool MappedFile::map(const std::string& fileName, Access access)
+{
+    unmap();
+    error.clear();
+
+    const int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "could not open '" + fileName + "': " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        error = "could not stat '" + fileName + "': " + std::strerror(errno);
+        close(fd);
+        return false;
+    }
+
+    // mmap refuses a length of 0, an empty file is open with no data
+    if (status.st_size > 0) {
+        void* address = mmap(nullptr, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (address == MAP_FAILED) {
+            error = "could not map '" + fileName + "': " + std::strerror(errno);
+            close(fd);
+            return false;
+        }
+
+        // a file read front to back once lets the kernel read ahead, one that is kept is needed whole soon
+        madvise(address, (size_t) status.st_size, access == kReadOnce ? MADV_SEQUENTIAL : MADV_WILLNEED);
+
+        data = static_cast<const char*>(address);
+        size = (size_t) status.st_size;
+    }
+
+    // the mapping keeps the file alive
+    close(fd);
+    open = true;
+
+    return true;
+}
+
+// Getters
+bool MappedFile::isOpen() const
+{
+    return open;
+}
+
+const char* MappedFile::getData() const
+{
+    return data;
+}
+
+size_t MappedFile::getSize() const
+{
+    return size;
+}
+
+const std::string& MappedFile::getError() const
+{
+    return error;
+}
@@ -0,0 +1,221 @@
+// PerfCounters.cpp
+// PerfCounters Class Implementation
+
+#include "PerfCounters.h"
+
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* const PerfCounters::kCounterNames[PerfCounters::kNumberOfCounters] = {
+        "cycles",
+        "instructions",
+        "l1dMisses",
+        "llcMisses",
+        "branchMisses",
+        "pageFaults"
+};
+
+std::atomic<bool> PerfCounters::enabled(false);
+
+namespace {
+
+// Counters of one thread, in one group led by the first counter that opened so that they are read together.
+// slot[counter] is the position of the counter in the values of the group, -1 if it could not be opened
+class ThreadCounters {
+private:
+    int leader;
+    int descriptors[PerfCounters::kNumberOfCounters];
+    int slot[PerfCounters::kNumberOfCounters];
+    unsigned int numberOfOpened;
+
+public:
+    ThreadCounters() : leader(-1), numberOfOpened(0)
+    {
+        for (unsigned int counter = 0; counter < PerfCounters::kNumberOfCounters; ++counter) {
+            descriptors[counter] = -1;
+            slot[counter] = -1;
+        }
+
+#ifdef __linux__
+        struct Event {
+            uint32_t type;
+            uint64_t config;
+        };
+
+        const uint64_t l1DataReadMisses = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const Event events[PerfCounters::kNumberOfCounters] = {
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+                { PERF_TYPE_HW_CACHE, l1DataReadMisses },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+                { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS }
+        };
+
+        for (unsigned int counter = 0; counter < PerfCounters::kNumberOfCounters; ++counter) {
+            struct perf_event_attr attributes;
+            std::memset(&attributes, 0, sizeof(attributes));
+            attributes.size = sizeof(attributes);
+            attributes.type = events[counter].type;
+            attributes.config = events[counter].config;
+            attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            attributes.disabled = leader < 0 ? 1 : 0;
+
+            // user space only, which perf_event_paranoid up to 2 allows for the own threads
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+
+            const int descriptor = (int) syscall(__NR_perf_event_open, &attributes, 0, -1, leader, 0);
+            if (descriptor < 0)
+                continue;
+
+            descriptors[counter] = descriptor;
+            slot[counter] = (int) numberOfOpened++;
+            if (leader < 0)
+                leader = descriptor;
+        }
+
+        if (leader >= 0)
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    ~ThreadCounters()
+    {
+#ifdef __linux__
+        for (unsigned int counter = 0; counter < PerfCounters::kNumberOfCounters; ++counter) {
+            if (descriptors[counter] >= 0)
+                close(descriptors[counter]);
+        }
+#endif
+    }
+
+    ThreadCounters(const ThreadCounters&) = delete;
+    ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+    bool isAvailable(unsigned int counter) const
+    {
+        return slot[counter] >= 0;
+    }
+
+    /*! read - counts since the counters were opened, 0 for the unavailable ones
+     *
+     * When the kernel had to share the hardware between more counters than it has, the counts are scaled by the time
+     * the group was enabled over the time it was counting
+     */
+    void read(uint64_t* counts) const
+    {
+        std::memset(counts, 0, PerfCounters::kNumberOfCounters * sizeof(uint64_t));
+
+#ifdef __linux__
+        if (leader < 0)
+            return;
+
+        // number of values, time enabled, time running, then one value per counter
+        uint64_t values[3 + PerfCounters::kNumberOfCounters];
+        if (::read(leader, values, sizeof(values)) < (ssize_t) (3 + numberOfOpened) * (ssize_t) sizeof(uint64_t))
+            return;
+
+        const uint64_t timeEnabled = values[1];
+        const uint64_t timeRunning = values[2];
+        for (unsigned int counter = 0; counter < PerfCounters::kNumberOfCounters; ++counter) {
+            if (slot[counter] < 0)
+                continue;
+
+            const uint64_t value = values[3 + slot[counter]];
+            counts[counter] = timeRunning == 0 || timeRunning == timeEnabled ?
+                              value : (uint64_t) ((double) value * timeEnabled / timeRunning);
+        }
+#endif
+    }
+};
+
+ThreadCounters& countersOfThisThread()
+{
+    static thread_local ThreadCounters counters;
+    return counters;
+}
+
+std::mutex phasesMutex;
+std::map<std::string, PerfCounters::Phase> phases;
+
+uint64_t nanosecondsNow()
+{
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+PerfCounters::Scope::Scope(const char* phase) : phase(phase), active(isEnabled())
+{
+    if (!active)
+        return;
+
+    countersOfThisThread().read(start);
+    start[kNumberOfCounters] = nanosecondsNow();
+}
+
+PerfCounters::Scope::~Scope()
+{
+    if (!active)
+        return;
+
+    uint64_t end[kNumberOfCounters + 1];
+    end[kNumberOfCounters] = nanosecondsNow();
+    const ThreadCounters& counters = countersOfThisThread();
+    counters.read(end);
+
+    std::lock_guard<std::mutex> lock(phasesMutex);
+    auto inserted = phases.insert(std::make_pair(std::string(phase), Phase()));
+    Phase& totals = inserted.first->second;
+    if (inserted.second)
+        totals.name = phase;
+
+    ++totals.calls;
+    totals.nanoseconds += end[kNumberOfCounters] - start[kNumberOfCounters];
+    for (unsigned int counter = 0; counter < kNumberOfCounters; ++counter) {
+        if (!counters.isAvailable(counter))
+            continue;
+
+        totals.counts[counter] += end[counter] - start[counter];
+        totals.available[counter] = true;
+    }
+}
+
+void PerfCounters::setEnabled(bool value)
+{
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+bool PerfCounters::isAvailable(Counter counter)
+{
+    return countersOfThisThread().isAvailable(counter);
+}
+
+std::vector<PerfCounters::Phase> PerfCounters::summarize()
+{
+    std::lock_guard<std::mutex> lock(phasesMutex);
+
+    std::vector<Phase> summary;
+    for (auto& phase : phases)
+        summary.push_back(phase.second);
+
+    return summary;
+}
+
+void PerfCounters::reset()
+{
+    std::lock_guard<std::mutex> lock(phasesMutex);
+    phases.clear();
+}
@@ -0,0 +1,79 @@
+// ShortestPathTree.cpp
+// ShortestPathTree Class Implementation
+
+#include "ShortestPathTree.h"
+#include "Graph.h"
+
+#include <algorithm>
+
+// Constructor
+ShortestPathTree::ShortestPathTree(unsigned int source, unsigned int numberOfVertices) :
+        source(source), distances(numberOfVertices, INF), parents(numberOfVertices, -1), negativeCycle(false)
+{
+    distances[source] = 0;
+}
+
+// Getters
+unsigned int ShortestPathTree::getSource() const
+{
+    return source;
+}
+
+unsigned int ShortestPathTree::getNumberOfVertices() const
+{
+    return (unsigned int) distances.size();
+}
+
+double ShortestPathTree::getDistance(unsigned int vertex) const
+{
+    return distances[vertex];
+}
+
+int ShortestPathTree::getParent(unsigned int vertex) const
+{
+    return parents[vertex];
+}
+
+bool ShortestPathTree::isReachable(unsigned int vertex) const
+{
+    return distances[vertex] != INF;
+}
+
+bool ShortestPathTree::hasNegativeCycle() const
+{
+    return negativeCycle;
+}
+
+std::vector<unsigned int> ShortestPathTree::getPath(unsigned int to) const
+{
+    std::vector<unsigned int> path;
+
+    if (!isReachable(to))
+        return path;
+
+    // a simple path has at most V vertices, a longer walk means the parents form a cycle
+    for (int v = (int) to; v != -1; v = parents[v]) {
+        if (path.size() == distances.size())
+            return std::vector<unsigned int>();
+
+        path.push_back((unsigned int) v);
+    }
+
+    if (path.back() != source)
+        return std::vector<unsigned int>();
+
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+// Setters
+void ShortestPathTree::setDistance(unsigned int vertex, double distance, int parent)
+{
+    distances[vertex] = distance;
+    parents[vertex] = parent;
+}
+
+void ShortestPathTree::setNegativeCycle(bool value)
+{
+    negativeCycle = value;
+}
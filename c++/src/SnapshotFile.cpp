@@ -0,0 +1,362 @@
+// SnapshotFile.cpp
+// SnapshotFile Class Implementation
+
+#include "SnapshotFile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+
+static const char kMagic[8] = { 'K', 'R', 'Y', 'P', 'S', 'N', 'A', 'P' };
+
+// written as a number, read back as 04 03 02 01 on little endian machines: a file from the other byte order is refused
+static const uint32_t kByteOrderMark = 0x01020304;
+
+// sections start on cache lines, which also keeps the all-pairs matrices as aligned as AllPairsShortestPaths needs
+static const uint64_t kSectionAlignment = 64;
+
+const uint32_t SnapshotFile::kFormatVersion = 1;
+
+// offsets are from the start of the file, 0 for a section that was not saved
+struct SnapshotFile::Header {
+    char magic[8];
+    uint32_t formatVersion;
+    uint32_t byteOrderMark;
+    uint64_t version;
+    uint32_t numberOfVertices;
+    uint32_t allPairsStride; // 0 without all-pairs
+    uint64_t numberOfEdges;
+    uint64_t symbolCharactersSize;
+    uint64_t symbolOffsetsAt;
+    uint64_t symbolCharactersAt;
+    uint64_t edgeOffsetsAt;
+    uint64_t edgeTargetsAt;
+    uint64_t edgeWeightsAt;
+    uint64_t distancesAt;
+    uint64_t nextHopsAt;     // 0 without all-pairs or without routes
+    uint64_t fileSize;
+};
+
+static uint64_t alignSection(uint64_t offset)
+{
+    return (offset + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment;
+}
+
+// true if [offset, offset + count * elementSize) is inside the file and aligned for the element type
+static bool isSectionInside(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t fileSize)
+{
+    if (offset % elementSize != 0 || offset > fileSize)
+        return false;
+    return count <= (fileSize - offset) / elementSize;
+}
+
+namespace {
+
+// output stream padding every section to its offset in the header
+class SectionWriter {
+private:
+    std::ofstream& out;
+    uint64_t position;
+
+public:
+    explicit SectionWriter(std::ofstream& out) : out(out), position(0) {}
+
+    void write(uint64_t at, const void* data, uint64_t size)
+    {
+        static const char zeros[kSectionAlignment] = {};
+        while (position < at) {
+            const uint64_t padding = std::min<uint64_t>(at - position, sizeof(zeros));
+            out.write(zeros, (std::streamsize) padding);
+            position += padding;
+        }
+
+        out.write(static_cast<const char*>(data), (std::streamsize) size);
+        position += size;
+    }
+};
+
+}
+
+SnapshotFile::SnapshotFile() :
+        header(nullptr), symbolOffsets(nullptr), symbolCharacters(nullptr), edgeOffsets(nullptr), edgeTargets(nullptr),
+        edgeWeights(nullptr), distances(nullptr), nextHops(nullptr)
+{
+}
+
+
+
+/*! save - write the graph and symbols of the snapshot to fileName
+ *
+ * The sections are laid out in the header first, then written in file order
+ */
+bool SnapshotFile::save(const GraphSnapshot& snapshot, bool withAllPairs, const std::string& fileName, std::string& error)
+{
+    const Graph<std::string>& graph = snapshot.getGraph();
+    const SymbolTable& symbols = snapshot.getSymbols();
+    const uint32_t numberOfVertices = graph.getNumberOfVertexIds();
+
+    if (symbols.size() != numberOfVertices) {
+        error = "the snapshot has " + std::to_string(symbols.size()) + " symbols for " +
+                std::to_string(numberOfVertices) + " vertices";
+        return false;
+    }
+
+    std::vector<uint64_t> symbolOffsetsOut(1, 0);
+    std::string symbolCharactersOut;
+    for (uint32_t id = 0; id < numberOfVertices; ++id) {
+        symbolCharactersOut += symbols.getSymbol(id);
+        symbolOffsetsOut.push_back(symbolCharactersOut.size());
+    }
+
+    std::vector<uint64_t> edgeOffsetsOut(1, 0);
+    std::vector<uint32_t> edgeTargetsOut;
+    std::vector<double> edgeWeightsOut;
+    std::vector< std::pair<unsigned int, double> > edges;
+    for (uint32_t from = 0; from < numberOfVertices; ++from) {
+        graph.getOutgoingEdges(from, edges);
+        for (auto& edge : edges) {
+            edgeTargetsOut.push_back(edge.first);
+            edgeWeightsOut.push_back(edge.second);
+        }
+        edgeOffsetsOut.push_back(edgeTargetsOut.size());
+    }
+
+    // an empty graph has empty matrices, nothing to save
+    const std::shared_ptr<const AllPairsShortestPaths> allPairs =
+            withAllPairs && numberOfVertices > 0 ? snapshot.getAllPairsShortestPaths() : nullptr;
+    const uint64_t allPairsStride = allPairs ? allPairs->getStride() : 0;
+    const uint64_t matrixSize = allPairsStride * allPairsStride;
+
+    Header out;
+    std::memset(&out, 0, sizeof(out));
+    std::memcpy(out.magic, kMagic, sizeof(kMagic));
+    out.formatVersion = kFormatVersion;
+    out.byteOrderMark = kByteOrderMark;
+    out.version = snapshot.getVersion();
+    out.numberOfVertices = numberOfVertices;
+    out.allPairsStride = (uint32_t) allPairsStride;
+    out.numberOfEdges = edgeTargetsOut.size();
+    out.symbolCharactersSize = symbolCharactersOut.size();
+
+    out.symbolOffsetsAt = alignSection(sizeof(Header));
+    out.symbolCharactersAt = alignSection(out.symbolOffsetsAt + symbolOffsetsOut.size() * sizeof(uint64_t));
+    out.edgeOffsetsAt = alignSection(out.symbolCharactersAt + symbolCharactersOut.size());
+    out.edgeTargetsAt = alignSection(out.edgeOffsetsAt + edgeOffsetsOut.size() * sizeof(uint64_t));
+    out.edgeWeightsAt = alignSection(out.edgeTargetsAt + edgeTargetsOut.size() * sizeof(uint32_t));
+    out.fileSize = out.edgeWeightsAt + edgeWeightsOut.size() * sizeof(double);
+
+    if (allPairs) {
+        out.distancesAt = alignSection(out.fileSize);
+        out.fileSize = out.distancesAt + matrixSize * sizeof(double);
+
+        if (allPairs->hasRoutes()) {
+            out.nextHopsAt = alignSection(out.fileSize);
+            out.fileSize = out.nextHopsAt + matrixSize * sizeof(uint32_t);
+        }
+    }
+
+    const std::string temporaryName = fileName + ".tmp";
+    {
+        std::ofstream stream(temporaryName, std::ios::binary | std::ios::trunc);
+        if (!stream) {
+            error = "cannot write " + temporaryName + ": " + std::strerror(errno);
+            return false;
+        }
+
+        SectionWriter writer(stream);
+        writer.write(0, &out, sizeof(out));
+        writer.write(out.symbolOffsetsAt, symbolOffsetsOut.data(), symbolOffsetsOut.size() * sizeof(uint64_t));
+        writer.write(out.symbolCharactersAt, symbolCharactersOut.data(), symbolCharactersOut.size());
+        writer.write(out.edgeOffsetsAt, edgeOffsetsOut.data(), edgeOffsetsOut.size() * sizeof(uint64_t));
+        writer.write(out.edgeTargetsAt, edgeTargetsOut.data(), edgeTargetsOut.size() * sizeof(uint32_t));
+        writer.write(out.edgeWeightsAt, edgeWeightsOut.data(), edgeWeightsOut.size() * sizeof(double));
+        if (out.distancesAt != 0)
+            writer.write(out.distancesAt, allPairs->getDistanceMatrix(), matrixSize * sizeof(double));
+        if (out.nextHopsAt != 0)
+            writer.write(out.nextHopsAt, allPairs->getNextHopMatrix(), matrixSize * sizeof(uint32_t));
+
+        stream.close();
+        if (!stream) {
+            error = "cannot write " + temporaryName + ": " + std::strerror(errno);
+            std::remove(temporaryName.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(temporaryName.c_str(), fileName.c_str()) != 0) {
+        error = "cannot rename " + temporaryName + " to " + fileName + ": " + std::strerror(errno);
+        std::remove(temporaryName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
+
+bool SnapshotFile::fail(const std::string& reason)
+{
+    error = reason;
+
+    file.reset();
+    header = nullptr;
+    symbolOffsets = nullptr;
+    symbolCharacters = nullptr;
+    edgeOffsets = nullptr;
+    edgeTargets = nullptr;
+    edgeWeights = nullptr;
+    distances = nullptr;
+    nextHops = nullptr;
+
+    return false;
+}
+
+/*! load - map a file written by save and check its layout
+ *
+ * Nothing in the file is trusted: every section has to fit in the file, offsets have to be increasing and end where
+ * the counts say, and every edge and next hop has to point at a vertex. A file that passes can be read without further
+ * checks
+ */
+bool SnapshotFile::load(const std::string& fileName)
+{
+    static_assert(sizeof(Header) == 112, "the header is read from files, its layout must not change");
+
+    fail("");
+
+    // the matrices are read in any order for as long as the snapshot lives
+    std::shared_ptr<MappedFile> mapped = std::make_shared<MappedFile>(fileName, MappedFile::kKeep);
+    if (!mapped->isOpen())
+        return fail(mapped->getError());
+
+    const char* data = mapped->getData();
+    const uint64_t size = mapped->getSize();
+
+    if (size < sizeof(Header))
+        return fail(fileName + " is too small to be a snapshot");
+
+    const Header* in = reinterpret_cast<const Header*>(data);
+    if (std::memcmp(in->magic, kMagic, sizeof(kMagic)) != 0)
+        return fail(fileName + " is not a snapshot");
+    if (in->byteOrderMark != kByteOrderMark)
+        return fail(fileName + " was written on a machine of the other byte order");
+    if (in->formatVersion != kFormatVersion)
+        return fail(fileName + " has format version " + std::to_string(in->formatVersion) + ", expected " +
+                    std::to_string(kFormatVersion));
+    if (in->fileSize != size)
+        return fail(fileName + " is truncated");
+
+    const uint64_t numberOfVertices = in->numberOfVertices;
+    const uint64_t matrixSize = (uint64_t) in->allPairsStride * in->allPairsStride;
+
+    if (!isSectionInside(in->symbolOffsetsAt, numberOfVertices + 1, sizeof(uint64_t), size) ||
+        !isSectionInside(in->symbolCharactersAt, in->symbolCharactersSize, 1, size) ||
+        !isSectionInside(in->edgeOffsetsAt, numberOfVertices + 1, sizeof(uint64_t), size) ||
+        !isSectionInside(in->edgeTargetsAt, in->numberOfEdges, sizeof(uint32_t), size) ||
+        !isSectionInside(in->edgeWeightsAt, in->numberOfEdges, sizeof(double), size))
+        return fail(fileName + " has a section outside of the file");
+
+    if (in->allPairsStride != 0) {
+        const uint64_t expectedStride = (numberOfVertices + AllPairsShortestPaths::kBlockSize - 1) /
+                                        AllPairsShortestPaths::kBlockSize * AllPairsShortestPaths::kBlockSize;
+        if (in->allPairsStride != expectedStride || in->distancesAt == 0)
+            return fail(fileName + " has all-pairs distances of the wrong size");
+        if (in->distancesAt % kSectionAlignment != 0 || in->nextHopsAt % kSectionAlignment != 0 ||
+            !isSectionInside(in->distancesAt, matrixSize, sizeof(double), size) ||
+            (in->nextHopsAt != 0 && !isSectionInside(in->nextHopsAt, matrixSize, sizeof(uint32_t), size)))
+            return fail(fileName + " has all-pairs distances outside of the file");
+    } else if (in->distancesAt != 0 || in->nextHopsAt != 0) {
+        return fail(fileName + " has all-pairs distances of the wrong size");
+    }
+
+    const uint64_t* inSymbolOffsets = reinterpret_cast<const uint64_t*>(data + in->symbolOffsetsAt);
+    const uint64_t* inEdgeOffsets = reinterpret_cast<const uint64_t*>(data + in->edgeOffsetsAt);
+    const uint32_t* inEdgeTargets = reinterpret_cast<const uint32_t*>(data + in->edgeTargetsAt);
+    const char* inSymbolCharacters = data + in->symbolCharactersAt;
+
+    if (inSymbolOffsets[0] != 0 || inSymbolOffsets[numberOfVertices] != in->symbolCharactersSize ||
+        inEdgeOffsets[0] != 0 || inEdgeOffsets[numberOfVertices] != in->numberOfEdges)
+        return fail(fileName + " has offsets that do not match its counts");
+
+    // the manager gives the symbols their ids in file order, a repeated symbol would shift every id after it
+    std::unordered_set<std::string> seenSymbols;
+    for (uint64_t id = 0; id < numberOfVertices; ++id) {
+        if (inSymbolOffsets[id] > inSymbolOffsets[id + 1] || inEdgeOffsets[id] > inEdgeOffsets[id + 1])
+            return fail(fileName + " has offsets that are not increasing");
+
+        const std::string symbol(inSymbolCharacters + inSymbolOffsets[id], inSymbolOffsets[id + 1] - inSymbolOffsets[id]);
+        if (!seenSymbols.insert(symbol).second)
+            return fail(fileName + " has the symbol " + symbol + " twice");
+    }
+
+    for (uint64_t edge = 0; edge < in->numberOfEdges; ++edge) {
+        if (inEdgeTargets[edge] >= numberOfVertices)
+            return fail(fileName + " has an edge to a vertex that does not exist");
+    }
+
+    // routes are followed hop by hop without checks, only the padding is never read
+    if (in->nextHopsAt != 0) {
+        const uint32_t* inNextHops = reinterpret_cast<const uint32_t*>(data + in->nextHopsAt);
+        for (uint64_t from = 0; from < numberOfVertices; ++from) {
+            const uint32_t* row = inNextHops + from * in->allPairsStride;
+            for (uint64_t to = 0; to < numberOfVertices; ++to) {
+                if (row[to] >= numberOfVertices && row[to] != AllPairsShortestPaths::kNoRoute)
+                    return fail(fileName + " has a next hop to a vertex that does not exist");
+            }
+        }
+    }
+
+    file = mapped;
+    header = in;
+    symbolOffsets = inSymbolOffsets;
+    symbolCharacters = inSymbolCharacters;
+    edgeOffsets = inEdgeOffsets;
+    edgeTargets = inEdgeTargets;
+    edgeWeights = reinterpret_cast<const double*>(data + in->edgeWeightsAt);
+    distances = in->distancesAt != 0 ? reinterpret_cast<const double*>(data + in->distancesAt) : nullptr;
+    nextHops = in->nextHopsAt != 0 ? reinterpret_cast<const uint32_t*>(data + in->nextHopsAt) : nullptr;
+
+    return true;
+}
+
+bool SnapshotFile::isLoaded() const
+{
+    return header != nullptr;
+}
+
+const std::string& SnapshotFile::getError() const
+{
+    return error;
+}
+
+unsigned long SnapshotFile::getVersion() const
+{
+    return header ? header->version : 0;
+}
+
+uint32_t SnapshotFile::getNumberOfVertices() const
+{
+    return header ? header->numberOfVertices : 0;
+}
+
+std::string SnapshotFile::getSymbol(uint32_t id) const
+{
+    return std::string(symbolCharacters + symbolOffsets[id], symbolOffsets[id + 1] - symbolOffsets[id]);
+}
+
+void SnapshotFile::getOutgoingEdges(uint32_t fromId, std::vector< std::pair<unsigned int, double> >& edges) const
+{
+    edges.clear();
+    for (uint64_t edge = edgeOffsets[fromId]; edge < edgeOffsets[fromId + 1]; ++edge)
+        edges.emplace_back(edgeTargets[edge], edgeWeights[edge]);
+}
+
+std::shared_ptr<const AllPairsShortestPaths> SnapshotFile::getAllPairs() const
+{
+    if (!distances)
+        return nullptr;
+
+    return AllPairsShortestPaths::borrow(header->numberOfVertices, distances, nextHops, file);
+}
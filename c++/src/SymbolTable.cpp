@@ -0,0 +1,47 @@
+// SymbolTable.cpp
+// SymbolTable Class Implementation
+
+#include "SymbolTable.h"
+
+const uint32_t SymbolTable::kInvalidId = UINT32_MAX;
+
+uint32_t SymbolTable::intern(const std::string& symbol)
+{
+    // most symbols are already known, find does not allocate the node that emplace would build and throw away
+    auto iterator = ids.find(symbol);
+    if (iterator != ids.end())
+        return iterator->second;
+
+    auto result = ids.emplace(symbol, (uint32_t) symbols.size());
+
+    if (result.second)
+        symbols.push_back(symbol);
+
+    return result.first->second;
+}
+
+uint32_t SymbolTable::lookUp(const std::string& symbol) const
+{
+    auto iterator = ids.find(symbol);
+
+    if (iterator == ids.end())
+        return kInvalidId;
+
+    return iterator->second;
+}
+
+const std::string& SymbolTable::getSymbol(uint32_t id) const
+{
+    return symbols[id];
+}
+
+uint32_t SymbolTable::size() const
+{
+    return (uint32_t) symbols.size();
+}
+
+void SymbolTable::clear()
+{
+    ids.clear();
+    symbols.clear();
+}
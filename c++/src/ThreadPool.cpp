@@ -0,0 +1,92 @@
+// ThreadPool.cpp
+// ThreadPool Class Implementation
+
+#include "ThreadPool.h"
+
+// Constructor
+ThreadPool::ThreadPool(unsigned int numberOfThreads) :
+        body(nullptr), numberOfIterations(0), nextIteration(0), busyWorkers(0), generation(0), stopping(false)
+{
+    for (unsigned int i = 1; i < numberOfThreads; ++i)
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+unsigned int ThreadPool::getNumberOfThreads() const
+{
+    return (unsigned int) workers.size() + 1;
+}
+
+void ThreadPool::workerLoop()
+{
+    unsigned long seenGeneration = 0;
+
+    for (;;) {
+        std::unique_lock<std::mutex> lock(mutex);
+        workAvailable.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+
+        if (stopping)
+            return;
+
+        seenGeneration = generation;
+        lock.unlock();
+
+        runIterations();
+
+        lock.lock();
+        if (--busyWorkers == 0)
+            workDone.notify_one();
+    }
+}
+
+void ThreadPool::runIterations()
+{
+    for (size_t i = nextIteration.fetch_add(1); i < numberOfIterations; i = nextIteration.fetch_add(1))
+        (*body)(i);
+}
+
+void ThreadPool::parallelFor(size_t iterations, const std::function<void(size_t)>& loopBody)
+{
+    // not worth waking anybody up
+    if (workers.empty() || iterations <= 1) {
+        for (size_t i = 0; i < iterations; ++i)
+            loopBody(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> callerLock(callerMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        body = &loopBody;
+        numberOfIterations = iterations;
+        nextIteration = 0;
+        busyWorkers = (unsigned int) workers.size();
+        ++generation;
+    }
+    workAvailable.notify_all();
+
+    runIterations();
+
+    // every worker has to leave runIterations before body goes out of scope
+    std::unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [this]() { return busyWorkers == 0; });
+    body = nullptr;
+}
+
+unsigned int ThreadPool::getHardwareConcurrency()
+{
+    const unsigned int threads = std::thread::hardware_concurrency();
+    return threads > 0 ? threads : 1;
+}
@@ -0,0 +1,288 @@
+// TickLog.cpp
+// TickLogWriter and TickLogReader Class Implementation
+
+#include "TickLog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+static const char kMagic[8] = { 'K', 'R', 'Y', 'P', 'T', 'I', 'C', 'K' };
+
+// written as a number, a log from a machine of the other byte order reads it reversed and is refused
+static const uint32_t kByteOrderMark = 0x01020304;
+
+static const size_t kFileHeaderSize = sizeof(kMagic) + 2 * sizeof(uint32_t);
+
+// bytes after the kind byte, kSymbol is followed by its characters too
+static const size_t kSymbolFieldsSize = sizeof(uint32_t) + sizeof(uint16_t);
+static const size_t kRateFieldsSize = 2 * sizeof(uint32_t) + sizeof(double);
+static const size_t kPublishFieldsSize = sizeof(int64_t);
+
+const uint32_t TickLog::kFormatVersion = 1;
+
+// empty if the header is one of this format
+static std::string checkFileHeader(const char* header, const std::string& fileName)
+{
+    uint32_t formatVersion;
+    uint32_t byteOrderMark;
+    std::memcpy(&formatVersion, header + sizeof(kMagic), sizeof(formatVersion));
+    std::memcpy(&byteOrderMark, header + sizeof(kMagic) + sizeof(formatVersion), sizeof(byteOrderMark));
+
+    if (std::memcmp(header, kMagic, sizeof(kMagic)) != 0)
+        return fileName + " is not a tick log";
+    if (byteOrderMark != kByteOrderMark)
+        return fileName + " was written on a machine of the other byte order";
+    if (formatVersion != TickLog::kFormatVersion)
+        return fileName + " has format version " + std::to_string(formatVersion) + ", expected " +
+               std::to_string(TickLog::kFormatVersion);
+
+    return "";
+}
+
+
+
+TickLogWriter::TickLogWriter() : numberOfRatesBuffered(0)
+{
+}
+
+TickLogWriter::~TickLogWriter()
+{
+    close();
+}
+
+/*! open - append to the log, creating it if needed
+ *
+ * An existing log is checked first, records of another format would make the whole file unreadable
+ */
+bool TickLogWriter::open(const std::string& fileName)
+{
+    close();
+    error.clear();
+
+    std::ifstream existing(fileName, std::ios::binary | std::ios::ate);
+    const std::streamoff existingSize = existing ? (std::streamoff) existing.tellg() : 0;
+
+    if (existingSize > 0) {
+        char header[kFileHeaderSize];
+        existing.seekg(0);
+        if ((size_t) existingSize < kFileHeaderSize || !existing.read(header, sizeof(header))) {
+            error = fileName + " is not a tick log";
+            return false;
+        }
+
+        error = checkFileHeader(header, fileName);
+        if (!error.empty())
+            return false;
+    }
+    existing.close();
+
+    out.open(fileName, std::ios::binary | std::ios::app);
+    if (!out) {
+        error = "cannot write " + fileName + ": " + std::strerror(errno);
+        return false;
+    }
+
+    if (existingSize == 0) {
+        append(kMagic, sizeof(kMagic));
+        append(&TickLog::kFormatVersion, sizeof(TickLog::kFormatVersion));
+        append(&kByteOrderMark, sizeof(kByteOrderMark));
+    }
+
+    const uint8_t kind = TickLog::kSession;
+    append(&kind, sizeof(kind));
+
+    return true;
+}
+
+void TickLogWriter::append(const void* data, size_t size)
+{
+    buffer.append(static_cast<const char*>(data), size);
+}
+
+void TickLogWriter::writeSymbol(uint32_t id, const std::string& symbol)
+{
+    if (!out.is_open())
+        return;
+
+    // symbols are short tickers, a longer one is cut rather than written with a length that wraps around
+    const uint16_t length = (uint16_t) std::min<size_t>(symbol.size(), UINT16_MAX);
+    const uint8_t kind = TickLog::kSymbol;
+
+    append(&kind, sizeof(kind));
+    append(&id, sizeof(id));
+    append(&length, sizeof(length));
+    append(symbol.data(), length);
+}
+
+void TickLogWriter::writeRate(uint32_t fromId, uint32_t toId, double price)
+{
+    if (!out.is_open())
+        return;
+
+    const uint8_t kind = TickLog::kRate;
+
+    append(&kind, sizeof(kind));
+    append(&fromId, sizeof(fromId));
+    append(&toId, sizeof(toId));
+    append(&price, sizeof(price));
+    ++numberOfRatesBuffered;
+}
+
+/*! writePublish - end the batch of rates written since the last call
+ *
+ * The buffer goes to the file and is flushed here, once per batch instead of once per rate
+ */
+void TickLogWriter::writePublish(int64_t timestamp)
+{
+    if (!out.is_open() || numberOfRatesBuffered == 0)
+        return;
+
+    const uint8_t kind = TickLog::kPublish;
+
+    append(&kind, sizeof(kind));
+    append(&timestamp, sizeof(timestamp));
+
+    out.write(buffer.data(), (std::streamsize) buffer.size());
+    out.flush();
+    buffer.clear();
+    numberOfRatesBuffered = 0;
+
+    if (!out && error.empty())
+        error = std::string("cannot write the tick log: ") + std::strerror(errno);
+}
+
+/*! close - write the buffered records and close the file
+ *
+ * Rates not ended by a publish record are written too, the reader replays them as a last batch without a time
+ */
+bool TickLogWriter::close()
+{
+    if (!out.is_open())
+        return error.empty();
+
+    out.write(buffer.data(), (std::streamsize) buffer.size());
+    out.close();
+    buffer.clear();
+    numberOfRatesBuffered = 0;
+
+    if (!out && error.empty())
+        error = std::string("cannot write the tick log: ") + std::strerror(errno);
+
+    return error.empty();
+}
+
+bool TickLogWriter::isOpen() const
+{
+    return out.is_open();
+}
+
+const std::string& TickLogWriter::getError() const
+{
+    return error;
+}
+
+
+
+TickLogReader::TickLogReader() : position(nullptr), end(nullptr), truncated(false)
+{
+}
+
+bool TickLogReader::open(const std::string& fileName)
+{
+    file.reset(new MappedFile(fileName));
+    position = nullptr;
+    end = nullptr;
+    truncated = false;
+    error.clear();
+
+    if (!file->isOpen()) {
+        error = file->getError();
+        return false;
+    }
+
+    if (file->getSize() < kFileHeaderSize) {
+        error = fileName + " is not a tick log";
+        return false;
+    }
+
+    error = checkFileHeader(file->getData(), fileName);
+    if (!error.empty())
+        return false;
+
+    position = file->getData() + kFileHeaderSize;
+    end = file->getData() + file->getSize();
+    return true;
+}
+
+/*! next - read the next record
+ *
+ * The fields are copied out with memcpy, records are packed and not aligned
+ */
+bool TickLogReader::next(TickLog::Record& record)
+{
+    if (position == end)
+        return false;
+
+    const uint8_t kind = (uint8_t) *position;
+    const size_t available = (size_t) (end - position) - 1;
+    const char* fields = position + 1;
+
+    size_t size = 0;
+    switch (kind) {
+        case TickLog::kSession:
+            break;
+
+        case TickLog::kSymbol:
+            size = kSymbolFieldsSize;
+            if (available >= size) {
+                std::memcpy(&record.from, fields, sizeof(record.from));
+                std::memcpy(&record.symbolLength, fields + sizeof(record.from), sizeof(record.symbolLength));
+                record.symbol = fields + kSymbolFieldsSize;
+                size += record.symbolLength;
+            }
+            break;
+
+        case TickLog::kRate:
+            size = kRateFieldsSize;
+            if (available >= size) {
+                std::memcpy(&record.from, fields, sizeof(record.from));
+                std::memcpy(&record.to, fields + sizeof(record.from), sizeof(record.to));
+                std::memcpy(&record.price, fields + sizeof(record.from) + sizeof(record.to), sizeof(record.price));
+            }
+            break;
+
+        case TickLog::kPublish:
+            size = kPublishFieldsSize;
+            if (available >= size)
+                std::memcpy(&record.timestamp, fields, sizeof(record.timestamp));
+            break;
+
+        default:
+            error = "unknown record kind " + std::to_string(kind) + " at byte " +
+                    std::to_string(position - file->getData()) + " of the tick log";
+            position = end;
+            return false;
+    }
+
+    // the writer died in the middle of a record
+    if (size > available) {
+        truncated = true;
+        position = end;
+        return false;
+    }
+
+    record.kind = (TickLog::Kind) kind;
+    position = fields + size;
+    return true;
+}
+
+bool TickLogReader::isTruncated() const
+{
+    return truncated;
+}
+
+const std::string& TickLogReader::getError() const
+{
+    return error;
+}
@@ -0,0 +1,255 @@
+// Trace.cpp
+// Trace Class Implementation
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<int> Trace::enabledLevel(Trace::kInfo);
+std::atomic<unsigned int> Trace::enabledCategories(Trace::kAllCategories);
+
+namespace {
+
+struct Event {
+    int64_t start;
+    int64_t duration;
+    const char* name;
+    uint8_t level;
+    uint8_t messageLength;
+    uint16_t category;
+    char message[Trace::kMaxMessageLength];
+};
+
+// A slot is written by its thread only. Its sequence is odd while the event is being written, and 2 * (n + 1) once
+// it holds the nth event of the thread: a dump copies the event and keeps it only if the sequence did not change
+struct Slot {
+    std::atomic<uint64_t> sequence;
+    Event event;
+};
+
+struct ThreadBuffer {
+    unsigned int threadId;
+    std::atomic<uint64_t> numberOfEvents;
+    Slot slots[Trace::kEventsPerThread];
+
+    explicit ThreadBuffer(unsigned int threadId) : threadId(threadId), numberOfEvents(0)
+    {
+        for (unsigned int i = 0; i < Trace::kEventsPerThread; ++i)
+            slots[i].sequence.store(0, std::memory_order_relaxed);
+    }
+};
+
+// Buffers outlive their threads so that a dump still has the events of the threads that ended. The mutex is taken
+// once per thread, on its first event, and by the dumps
+std::mutex registryMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> registry;
+
+ThreadBuffer& bufferOfThisThread()
+{
+    static thread_local ThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(std::make_shared<ThreadBuffer>((unsigned int) registry.size() + 1));
+        buffer = registry.back().get();
+    }
+
+    return *buffer;
+}
+
+const char* categoryName(unsigned int category)
+{
+    switch (category) {
+        case Trace::kGraph:
+            return "graph";
+        case Trace::kParser:
+            return "parser";
+        case Trace::kUpdate:
+            return "update";
+        case Trace::kQuery:
+            return "query";
+        default:
+            return "other";
+    }
+}
+
+const char* levelName(unsigned int level)
+{
+    switch (level) {
+        case Trace::kError:
+            return "error";
+        case Trace::kWarning:
+            return "warning";
+        case Trace::kInfo:
+            return "info";
+        default:
+            return "debug";
+    }
+}
+
+void writeJsonString(std::ostream& out, const char* characters, size_t length)
+{
+    out << '"';
+    for (size_t i = 0; i < length; ++i) {
+        const unsigned char c = (unsigned char) characters[i];
+        if (c == '"' || c == '\\') {
+            out << '\\' << (char) c;
+        } else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out << escaped;
+        } else {
+            out << (char) c;
+        }
+    }
+    out << '"';
+}
+
+// microseconds, the unit of the Chrome trace format
+void writeMicroseconds(std::ostream& out, int64_t nanoseconds)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%lld.%03lld", (long long) (nanoseconds / 1000),
+                  (long long) (nanoseconds % 1000));
+    out << text;
+}
+
+}
+
+void Trace::setLevel(Level level)
+{
+    enabledLevel.store(level, std::memory_order_relaxed);
+}
+
+void Trace::setCategories(unsigned int categories)
+{
+    enabledCategories.store(categories, std::memory_order_relaxed);
+}
+
+int64_t Trace::now()
+{
+    static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void Trace::record(Level level, Category category, const char* name, int64_t start, int64_t duration,
+                   const char* message, size_t messageLength)
+{
+    ThreadBuffer& buffer = bufferOfThisThread();
+    const uint64_t n = buffer.numberOfEvents.load(std::memory_order_relaxed);
+    Slot& slot = buffer.slots[n % kEventsPerThread];
+
+    slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Event& event = slot.event;
+    event.start = start;
+    event.duration = duration;
+    event.name = name;
+    event.level = (uint8_t) level;
+    event.category = (uint16_t) category;
+
+    // a cut message ends before the character it would split, the dump stays valid UTF-8
+    size_t length = message == nullptr ? 0 : messageLength;
+    if (length > kMaxMessageLength) {
+        length = kMaxMessageLength;
+        while (length > 0 && ((unsigned char) message[length] & 0xC0) == 0x80)
+            --length;
+    }
+    event.messageLength = (uint8_t) length;
+    if (event.messageLength > 0)
+        std::memcpy(event.message, message, event.messageLength);
+
+    slot.sequence.store(2 * n + 2, std::memory_order_release);
+    buffer.numberOfEvents.store(n + 1, std::memory_order_release);
+}
+
+/*! writeChromeJson - the events of every thread as a Chrome trace
+ *
+ * Events with a duration are complete events ("X"), the others instant events ("i") of their thread
+ */
+void Trace::writeChromeJson(std::ostream& out)
+{
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffers = registry;
+    }
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    bool first = true;
+    for (const std::shared_ptr<ThreadBuffer>& buffer : buffers) {
+        const uint64_t end = buffer->numberOfEvents.load(std::memory_order_acquire);
+        const uint64_t begin = end > kEventsPerThread ? end - kEventsPerThread : 0;
+
+        for (uint64_t n = begin; n < end; ++n) {
+            const Slot& slot = buffer->slots[n % kEventsPerThread];
+            const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence != 2 * n + 2)
+                continue;
+
+            Event event;
+            std::memcpy(&event, &slot.event, sizeof(event));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+                continue;
+
+            out << (first ? "\n" : ",\n") << "{\"name\":";
+            writeJsonString(out, event.name, std::strlen(event.name));
+            out << ",\"cat\":\"" << categoryName(event.category) << "\",\"ph\":\""
+                << (event.duration >= 0 ? "X" : "i") << "\",\"ts\":";
+            writeMicroseconds(out, event.start);
+            if (event.duration >= 0) {
+                out << ",\"dur\":";
+                writeMicroseconds(out, event.duration);
+            } else {
+                out << ",\"s\":\"t\"";
+            }
+            out << ",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"level\":\"" << levelName(event.level)
+                << '"';
+            if (event.messageLength > 0) {
+                out << ",\"message\":";
+                writeJsonString(out, event.message, event.messageLength);
+            }
+            out << "}}";
+            first = false;
+        }
+    }
+
+    out << "\n]}\n";
+}
+
+bool Trace::dumpChromeJson(const std::string& fileName, std::string& error)
+{
+    std::ofstream out(fileName);
+    if (!out) {
+        error = "cannot write " + fileName + ": " + std::strerror(errno);
+        return false;
+    }
+
+    writeChromeJson(out);
+    out.close();
+    if (!out) {
+        error = "cannot write " + fileName + ": " + std::strerror(errno);
+        return false;
+    }
+
+    return true;
+}
+
+bool Trace::isCompiledIn()
+{
+#ifdef KRYPTOS_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
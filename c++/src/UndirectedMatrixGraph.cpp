@@ -6,23 +6,27 @@
 #include <iomanip> // setprecision
 #include <sstream> // stringstream
 #include <limits> // double max value
-#include <stack>
+#include <functional>
+#include <algorithm>
 
 #include "CurrencyPair.h"
+#include "AllPairsShortestPaths.h"
+#include "Trace.h"
 
-// INF represents no-edge
-static const double INF = std::numeric_limits<double>::max();
+template<class T>
+const unsigned int UndirectedMatrixGraph<T>::kInitialCapacity;
 
 //constructor of undirected graph using adjacency matrix
 template<class T>
-UndirectedMatrixGraph<T>::UndirectedMatrixGraph() : Graph<T>(), adjMatrix(), verticesMap() {}
+UndirectedMatrixGraph<T>::UndirectedMatrixGraph() :
+        Graph<T>(), verticesMap(), adjMatrix(), capacity(0), removedVertices(), numberOfRemovedVertices(0), neighborLists() {}
 
 
 //This function adds a vertices to our vertex List
 // @param: Vertex * addThisVertex
 
 //1. adds to list using stl vector function
-//2. notifies user
+//2. grows the capacity of the matrix if the new row does not fit
 //3. increments the number of vertices
 template<class T>
 void UndirectedMatrixGraph<T>::addVertex(const T& value)
@@ -31,6 +35,11 @@ void UndirectedMatrixGraph<T>::addVertex(const T& value)
     if (lookUpVertex(value) != -1)
         return;
 
+    // the capacity grows geometrically, so the matrix is reallocated O(log V) times. The factor is 1.5 rather than 2
+    // because every row in use is initialized up to the capacity
+    if (vertexList.size() == capacity)
+        grow(std::max(kInitialCapacity, capacity + capacity / 2));
+
     Vertex<T> vertex(value);
     vertexList.push_back(vertex);
 
@@ -45,30 +54,23 @@ void UndirectedMatrixGraph<T>::addVertex(const T& value)
 
 //    std::cout << __FUNCTION__ << ": Added vertex "   << "\n";
 
-    unsigned int prevCount = totalNumberOfVertices;
     totalNumberOfVertices++;
 
-    // resize the vectors (as we add a new vertex, columns increase)
-    for (auto it = adjMatrix.begin(); it != adjMatrix.end(); ++it) {
-        while (it->size() < totalNumberOfVertices)
-            it->push_back(INF); // set the distance to INF
-    }
-
-    // create a new vertex vector
-    auto v = std::vector<double>();
-    for (int i = 0; i < totalNumberOfVertices; ++i) // initialize the vector to INF with size: numberOfVertices
-        v.push_back( i == insertedIndex ? 0 : INF); // vertex distance to itself should be 0
+    // the existing rows are INF up to the capacity already, only the new row has to be initialized
+    std::fill(&weightAt(insertedIndex, 0), &weightAt(insertedIndex, 0) + capacity, INF);
+    weightAt(insertedIndex, insertedIndex) = 0; // vertex distance to itself should be 0
 
-    adjMatrix.push_back(v);
+    removedVertices.push_back(false);
+    neighborLists.emplace_back();
 
 };
 
 //This function removes a vertices to our vertex List
 // @param: Vertex * deleteThisVertex
 
-//1. Checks for whether the vertex existss, if it does, erase from list using stl vector function
+//1. Checks for whether the vertex existss, if it does, remove all of its edges and mark its slot as removed
 //2. notifies user
-//3. increments the number of vertices
+//3. decrements the number of vertices, compacts the matrix once most slots are removed
 template<class T>
 void UndirectedMatrixGraph<T>::removeVertex(const T& value)
 {
@@ -76,23 +78,108 @@ void UndirectedMatrixGraph<T>::removeVertex(const T& value)
 
     if (index != -1 && totalNumberOfVertices!=-1) // if index is valid
     {
-        vertexList.erase(vertexList.begin() + index); // remove vertex at that index
-        totalNumberOfVertices--;
+        const unsigned int removed = (unsigned int) index;
 
-        //resize the matrix accordingly
-        adjMatrix.erase(adjMatrix.begin() + index);
-        for (auto iterator = adjMatrix.begin(); iterator != adjMatrix.end(); ++iterator)
-        {
-            iterator->erase(iterator->begin() + index);
-        }
+        // edges going out of the vertex (copy, setWeight edits the list)
+        const std::vector<unsigned int> neighbors(neighborLists[removed]);
+        for (unsigned int column : neighbors)
+            setWeight(removed, column, INF);
+
+        // edges coming into the vertex, for directed graphs these are not in its own neighbor list
+        for (unsigned int row = 0; row < vertexList.size(); ++row)
+            if (row != removed && weightAt(row, removed) != INF)
+                setWeight(row, removed, INF);
+
+        // the slot stays, with INF everywhere but the diagonal, until the next compaction
+        removedVertices[removed] = true;
+        numberOfRemovedVertices++;
+        totalNumberOfVertices--;
 
         // remove the value from the map as well
         verticesMap.erase(std::string(value));
 
-        std::cout << __FUNCTION__ << ": Removed vertex at index " << index << "\n";
+        KRYPTOS_TRACE(kDebug, kGraph, "removeVertex", "removed vertex at index " + std::to_string(index));
+
+        if (numberOfRemovedVertices > totalNumberOfVertices)
+            compact();
     }
 }
 
+
+
+/*! grow - reallocate the matrix with more rows and columns
+ *
+ * @param newCapacity - new number of rows and columns, at least the number of slots in use
+ */
+template<class T>
+void UndirectedMatrixGraph<T>::grow(unsigned int newCapacity)
+{
+    // rows that are not in use yet are left uninitialized, addVertex fills the row of every new slot
+    std::vector<double, DefaultInitAllocator<double> > grown((size_t) newCapacity * newCapacity);
+
+    // copy the rows in use and extend them with INF, so that new columns do not have to be written row by row
+    for (unsigned int row = 0; row < vertexList.size(); ++row) {
+        auto newRow = grown.begin() + (size_t) row * newCapacity;
+        std::copy(adjMatrix.begin() + (size_t) row * capacity, adjMatrix.begin() + (size_t) row * capacity + vertexList.size(), newRow);
+        std::fill(newRow + vertexList.size(), newRow + newCapacity, INF);
+    }
+
+    adjMatrix.swap(grown);
+    capacity = newCapacity;
+}
+
+
+
+/*! compact - drop the slots of removed vertices
+ *
+ * The remaining vertices keep their order, a vertex gets a smaller id for every removed slot before it
+ */
+template<class T>
+void UndirectedMatrixGraph<T>::compact()
+{
+    const unsigned int numberOfSlots = (unsigned int) vertexList.size();
+
+    // new id of every remaining vertex
+    std::vector<unsigned int> newIds(numberOfSlots, 0);
+    unsigned int nextId = 0;
+    for (unsigned int slot = 0; slot < numberOfSlots; ++slot)
+        if (!removedVertices[slot])
+            newIds[slot] = nextId++;
+
+    std::vector<double, DefaultInitAllocator<double> > compacted((size_t) capacity * capacity);
+    std::vector<Vertex<T> > compactedVertices;
+    std::vector< std::vector<unsigned int> > compactedNeighbors;
+    compactedVertices.reserve(nextId);
+    compactedNeighbors.reserve(nextId);
+    verticesMap.clear();
+
+    for (unsigned int slot = 0; slot < numberOfSlots; ++slot) {
+        if (removedVertices[slot])
+            continue;
+
+        const unsigned int id = newIds[slot];
+        std::fill(compacted.begin() + (size_t) id * capacity, compacted.begin() + (size_t) (id + 1) * capacity, INF);
+        compacted[(size_t) id * capacity + id] = weightAt(slot, slot);
+
+        // removed vertices have no edges, so the neighbor lists only point to remaining vertices
+        std::vector<unsigned int> neighbors(neighborLists[slot]);
+        for (auto& column : neighbors) {
+            compacted[(size_t) id * capacity + newIds[column]] = weightAt(slot, column);
+            column = newIds[column];
+        }
+
+        compactedVertices.push_back(vertexList[slot]);
+        compactedNeighbors.push_back(std::move(neighbors));
+        verticesMap.insert(std::make_pair(std::string(vertexList[slot].getValue()), id));
+    }
+
+    adjMatrix.swap(compacted);
+    vertexList.swap(compactedVertices);
+    neighborLists.swap(compactedNeighbors);
+    removedVertices.assign(nextId, false);
+    numberOfRemovedVertices = 0;
+}
+
 //This function adds an edge between two given vertices and sets an associated cost to the edge
 // @param: Vertex * fromVertex, Vertex * toVertex
 
@@ -111,7 +198,7 @@ void UndirectedMatrixGraph<T>::addEdge(const T& fromValue, const T& toValue, dou
     if (fromIndex != -1 && toIndex != -1)
     {
         // if they exist, then add it
-        adjMatrix[fromIndex][toIndex] = adjMatrix[toIndex][fromIndex] = cost; // add edge between vertices
+        addEdgeById(fromIndex, toIndex, cost); // add edge between vertices
     }
 }
 //This function removes an edge between two given vertices
@@ -130,13 +217,13 @@ void UndirectedMatrixGraph<T>::removeEdge(const T& fromValue, const T& toValue)
 
     if (fromIndex != -1 && toIndex != -1) {
         //check to see if edge doesnt exist between vertices
-        if (adjMatrix[fromIndex][toIndex] == 0) {
-            std::cout << __FUNCTION__ << ": Edge does not exist.. Nothing to do here" << "\n";
+        if (weightAt(fromIndex, toIndex) == INF) {
+            KRYPTOS_TRACE(kDebug, kGraph, "removeEdge", "edge does not exist, nothing to do");
             return;
         }
 
         // if they exist, then remove it
-        adjMatrix[fromIndex][toIndex] = adjMatrix[toIndex][fromIndex] = 0.00; //add edge between vertices
+        addEdgeById(fromIndex, toIndex, INF); // no-edge is INF
     }
 }
 
@@ -172,7 +259,7 @@ double UndirectedMatrixGraph<T>::getWeight(const T &fromValue, const T &toValue)
 
     if (fromIndex != -1 && toIndex != -1) //if both vertices exist
     {
-        return adjMatrix[fromIndex][toIndex]; //return weight
+        return weightAt(fromIndex, toIndex); //return weight
     }
     return -1; //if vertices arent available, return -1
 }
@@ -188,9 +275,9 @@ std::vector< Vertex<T> > UndirectedMatrixGraph<T>::getNeighbors(const T &targetC
     int index = lookUpVertex(targetCoin); //gets index of vertex
     if (index != -1) //if vertex exists
     {
-        for (int i = 0; i < this->getNumberOfVertices(); i++)//loop through the rows of matrix
+        for (unsigned int i = 0; i < vertexList.size(); i++)//loop through the row of the matrix
         {
-            if (adjMatrix[index][i] != INF) //if a valid edge exists to the passed vertex
+            if (weightAt(index, i) != INF) //if a valid edge exists to the passed vertex
             {
                 listOfNeighbors.push_back(vertexList[i]);//push the neighbors to the list
             }
@@ -220,8 +307,9 @@ std::string UndirectedMatrixGraph<T>::toString()
     std::string str(spacing + 3, ' ');
 
     // row with headers
-    for (auto it = vertexList.begin(); it != vertexList.end(); ++it) {
-        str += (*it).getValue() + headerSpaces;
+    for (unsigned int i = 0; i < vertexList.size(); ++i) {
+        if (!removedVertices[i])
+            str += vertexList[i].getValue() + headerSpaces;
     }
 
     // remove the last whitespaces
@@ -231,15 +319,20 @@ std::string UndirectedMatrixGraph<T>::toString()
     str += "\n";
 
     std::stringstream buffer;
-    int i = 0; // counter of vertex list
     std::string line; // hold data for each line
 
-    for (auto it = adjMatrix.begin(); it != adjMatrix.end(); ++it) {
-        line += vertexList.at(i++).getValue(); // get the symbol
+    for (unsigned int i = 0; i < vertexList.size(); ++i) {
+        if (removedVertices[i])
+            continue;
+
+        line += vertexList[i].getValue(); // get the symbol
         line += std::string(spacing - (line.length() - baseSymbolLength), ' '); // calculate the spacing based on the symbol length
-        for (auto column = it->begin(); column != it->end(); ++column) {
+        for (unsigned int column = 0; column < vertexList.size(); ++column) {
+            if (removedVertices[column])
+                continue;
+
             buffer.str(std::string());
-            const double value = (*column == INF) ? -1 : *column;
+            const double value = (weightAt(i, column) == INF) ? -1 : weightAt(i, column);
             if (value != -1)
                 buffer << std::fixed << std::setprecision(2) << value << spaces; // get value of double with precision of 2
             else
@@ -262,11 +355,26 @@ std::string UndirectedMatrixGraph<T>::toString()
 template<class T>
 void UndirectedMatrixGraph<T>::reset() {
     vertexList.clear();
+    verticesMap.clear();
     adjMatrix.clear();
+    capacity = 0;
+    removedVertices.clear();
+    numberOfRemovedVertices = 0;
+    neighborLists.clear();
     totalNumberOfVertices = 0;
 }
 
 
+/*! clone - copy the vertices, the matrix and the neighbor lists
+ *
+ * @tparam T - the type of the objects that Graph holds
+ */
+template<class T>
+Graph<T>* UndirectedMatrixGraph<T>::clone() const {
+    return new UndirectedMatrixGraph<T>(*this);
+}
+
+
 
 /*! computeShortestDistanceBetweenAllVertices - Calculate shortest paths between all vertices using Floyd-Warshall Algorithm
  *
@@ -276,46 +384,13 @@ void UndirectedMatrixGraph<T>::reset() {
 template<class T>
 std::vector<std::vector<double> > UndirectedMatrixGraph<T>::computeShortestDistanceBetweenAllVertices() const {
 
-    // get the number of vertices
-    const unsigned int V = this->getNumberOfVertices();
-    // copy the matrix of current distances. this 2D vector will contain the shortest paths after running Floyd-Warshall Algorithm
-    std::vector< std::vector<double> > dists(adjMatrix);
-
-    // implementation of the all-pairs-short algorithm
-    for (int intermediateVertex = 0; intermediateVertex < V; ++intermediateVertex) {
-
-        // Pick all vertices as source one by one
-        for (int sourceVertex = 0; sourceVertex < V; ++sourceVertex) {
-
-            // Pick all vertices as destination for the
-            // above picked source
-            for (int destinationVertex = 0; destinationVertex < V; ++destinationVertex) {
-
-                if (
-                        dists[sourceVertex][intermediateVertex] != INF && // avoid overflow before summing up
-                        dists[intermediateVertex][destinationVertex] != INF &&
-                        dists[sourceVertex][intermediateVertex] + dists[intermediateVertex][destinationVertex]
-                            < dists[sourceVertex][destinationVertex] // check if the sum is smaller than actual path
-                        )
-                {
-                    // save the distance in the matrix
-                    dists[sourceVertex][destinationVertex] = dists[sourceVertex][intermediateVertex] + dists[intermediateVertex][destinationVertex];
-                }
-            }
-        }
-    }
-    // print the resulting vector
-    /*
-    for (int l = 0; l < dists.size();  ++l) {
-        for (int i = 0; i < dists.size();  ++i) {
-            const auto value = dists[l][i] == INF ? 0 : dists[l][i];
-            std::cout << value << "  ";
-        }
-        std::cout << "\n\n";
-    }
-    */
+    // copy the matrix of current distances into the flat buffer of the all-pairs engine,
+    // which will contain the shortest paths after running the blocked Floyd-Warshall Algorithm
+    AllPairsShortestPaths dists;
+    dists.load(*this);
+    dists.compute();
 
-    return dists;
+    return dists.toMatrix();
 }
 
 
@@ -334,10 +409,6 @@ std::list<CurrencyPair> UndirectedMatrixGraph<T>::computeShortestDistanceBetween
     // list with pairs of currencies that we return
     std::list<CurrencyPair> pairs;
 
-    // Pairs found by the all-pairs shortest algorithm
-    // TODO: Rename consideredPairs to a more appropriate identifier
-    std::stack<CurrencyPair> consideredPairs;
-
     // first check if vertices with given values exist in the graph
     const int sourceIndex = lookUpVertex(from);
     const int destIndex = lookUpVertex(to);
@@ -347,110 +418,15 @@ std::list<CurrencyPair> UndirectedMatrixGraph<T>::computeShortestDistanceBetween
     if (sourceIndex == -1 || destIndex == -1)
         return pairs;
 
+    // run the all-pairs algorithm with the next hop matrix, the route is then read back hop by hop
+    AllPairsShortestPaths dists(0, true);
+    dists.load(*this);
+    dists.compute();
 
-    // get the number of vertices
-    const unsigned int V = this->getNumberOfVertices();
-    // copy the matrix of current distances. this 2D vector will contain the shortest paths after running Floyd-Warshall Algorithm
-    std::vector< std::vector<double> > dists(adjMatrix);
-
-
-    // implementation of the all-pairs-short algorithm
-    for (int intermediateVertex = 0; intermediateVertex < V; ++intermediateVertex) {
-
-        // Pick all vertices as source one by one
-        for (int sourceVertex = 0; sourceVertex < V; ++sourceVertex) {
-
-            // Pick all vertices as destination for the
-            // above picked source
-            for (int destinationVertex = 0; destinationVertex < V; ++destinationVertex) {
-
-                if (
-                        dists[sourceVertex][intermediateVertex] != INF && // avoid overflow before summing up
-                        dists[intermediateVertex][destinationVertex] != INF &&
-                        dists[sourceVertex][intermediateVertex] + dists[intermediateVertex][destinationVertex]
-                        < dists[sourceVertex][destinationVertex] // check if the sum is smaller than actual path
-                        )
-                {
-                    // save the distance in the matrix
-                    dists[sourceVertex][destinationVertex] = dists[sourceVertex][intermediateVertex] + dists[intermediateVertex][destinationVertex];
-
-//                    if (vertexList[sourceVertex].getValue() == from && vertexList[destinationVertex].getValue() == to) {
-//                        std::cout << "[" << vertexList[sourceVertex].getValue() << "]"
-//                                  << " - [" << vertexList[intermediateVertex].getValue() << "]"
-//                                  << " - [" << vertexList[destinationVertex].getValue() << "]\n";
-//                    }
-
-                    // and put the pair into the queue
-                    if (vertexList[sourceVertex].getValue() == from) {
-                        auto fromS = vertexList[sourceVertex].getValue();
-                        auto intermidS = vertexList[intermediateVertex].getValue();
-                        auto destS = vertexList[destinationVertex].getValue();
-
-                        consideredPairs.emplace(fromS, intermidS, dists[sourceVertex][intermediateVertex]);
-                        consideredPairs.emplace(intermidS, destS, dists[intermediateVertex][destinationVertex]);
-                    }
-                }
-            }
-        }
-
-
-    }
-
-    // Parse through the stack of pairs
-
-    // prevSource and prevDestination keeps track of the from & to symbols from the previous loop iteration
-    // They're used to keep track of the pattern of pairs
-    auto prevSource = from;
-    auto prevDestination = to;
-
-    // Ensures that the pair being checked is relevant to the shortest path
-    bool isRelevant = true;
-
-
-    // Holds a temporary stack that stores what will become the list of pairs
-    std::stack<CurrencyPair> temp;
-    while (!consideredPairs.empty()) {
-        auto pair = consideredPairs.top();
-        consideredPairs.pop();
-        
-
-        // Check if the pair belongs in the shortest path
-        if ((prevSource == pair.getFromSymbol() ||
-            prevSource == pair.getToSymbol() || 
-            prevDestination == pair.getFromSymbol() ||
-            prevDestination == pair.getToSymbol()) &&
-            isRelevant
-            ) 
-        {
-            temp.push(pair);
-        } 
-        else 
-            isRelevant = false;
-
-        if(pair.getFromSymbol() == from && pair.getToSymbol() == to) {
-            // Empty the temp stack
-            while (!temp.empty())
-                temp.pop();
-            
-            isRelevant = true;
-        }
-
-        prevSource = pair.getFromSymbol();
-        prevDestination = pair.getToSymbol();
-    }
-
-    // Insert temp stack into pairs list
-    int topIndex = temp.size();
-    while(temp.size() > 0) {
-        CurrencyPair pair = temp.top();
-
-        if ((pair.getFromSymbol() == from && temp.size() != topIndex) || pair.getToSymbol() == to && temp.size() > 1) {
-
-        } else {
-            pairs.push_back(pair);
-        }
-
-        temp.pop();
+    std::vector<unsigned int> route;
+    if (dists.getRoute((unsigned int) sourceIndex, (unsigned int) destIndex, route)) {
+        for (unsigned int i = 1; i < route.size(); ++i)
+            pairs.emplace_back(vertexList[route[i - 1]].getValue(), vertexList[route[i]].getValue(), weightAt(route[i - 1], route[i]));
     }
 
     // if we found pairs, we should return it now
@@ -458,9 +434,9 @@ std::list<CurrencyPair> UndirectedMatrixGraph<T>::computeShortestDistanceBetween
         return pairs;
 
     // if not, we still need to check if the graph has the direct cost for our target pair
-    if (dists[sourceIndex][destIndex] != INF) {
+    if (sourceIndex != destIndex && weightAt(sourceIndex, destIndex) != INF) {
         // if the distance is not INF, then return this pair
-        pairs.emplace_back(vertexList[sourceIndex].getValue(), vertexList[destIndex].getValue(), dists[sourceIndex][destIndex]);
+        pairs.emplace_back(vertexList[sourceIndex].getValue(), vertexList[destIndex].getValue(), weightAt(sourceIndex, destIndex));
     }
 
     return pairs;
@@ -469,37 +445,6 @@ std::list<CurrencyPair> UndirectedMatrixGraph<T>::computeShortestDistanceBetween
 
 
 
-template<class T>
-void UndirectedMatrixGraph<T>::constructPath(int parent[], int j, std::list<T>& path) const {
-    // Base Case : If j is source
-    if (parent[j] == - 1)
-        return;
-
-    this->constructPath(parent, parent[j], path);
-
-    path.push_back(vertexList[j].getValue());
-}
-
-
-
-template<class T>
-int UndirectedMatrixGraph<T>::minDistance(const double *dist, const bool *sptSet, int V) const {
-    // initialize min value
-    double min = INF;
-    int min_index = 0;
-
-    for (int v = 0; v < V; v++)
-        if (!sptSet[v] && dist[v] <= min)
-            min = dist[v], min_index = v;
-
-    return min_index;
-}
-
-
-
-
-
-
 template<class T>
 std::list<CurrencyPair> UndirectedMatrixGraph<T>::getShortestPairsBetween(const T& from, const T& to) const {
     // list with pairs of currencies that we return
@@ -513,128 +458,60 @@ std::list<CurrencyPair> UndirectedMatrixGraph<T>::getShortestPairsBetween(const
     if (src == -1 || dest == -1)
         return pairs;
 
-
-    // V - number of vertices
-    int V = this->getNumberOfVertices();
-
-    // array distances[] will hold the shortest distance from source to all vertices
-    double distances[V];
-
-
-    // shortestPathTreeVisited[i] will be true if vertex i is included in shortest distance
-    // from src to i
-    bool shortestPathTreeVisited[V];
-
-    // store shortest path tree
-    int parentVertexArray[V];
-
-    // initialize
-    for (int i = 0; i < V; i++)
-    {
-        parentVertexArray[src] = -1;
-        distances[i] = INF;
-        shortestPathTreeVisited[i] = false;
-    }
-
-    // distance of source vertex from itself is 0
-    distances[src] = 0;
-
-    // find shortest path for all vertices
-    for (int count = 0; count < V - 1; count++) {
-        // choose the minimum distance vertex from the set of
-        // vertices that are not touched.
-        int k = this->minDistance(distances, shortestPathTreeVisited, V);
-
-        // mark this chosen vertex as processed
-        shortestPathTreeVisited[k] = true;
-
-        // Update the distance value of the adjacent vertices of the chosen vertex.
-        for (int v = 0; v < V; v++)
-
-            // Update distances[v] iff is not in shortestPathTreeVisited, and there is an edge from k to v, and
-            // total weight of path from src to v through k is smaller than current value of
-            // distances[v]
-            if (!shortestPathTreeVisited[v] && adjMatrix[k][v] &&
-                    adjMatrix[k][v] != INF &&
-                distances[k] + adjMatrix[k][v] < distances[v]) {
-                distances[v] = distances[k] + adjMatrix[k][v];
-                parentVertexArray[v] = k;
-            }
-    }
-
-
-    // list that represents the paths to take
-    std::list<T> path;
-
-
-    // printing
-//    std::cout << "\n\nFound path:\n";
-//    std::cout << vertexList[src].getValue() << " -> " << vertexList[dest].getValue() << ":\n";
-
-    // save the first starting source vertex to the path
-    path.push_back(vertexList[src].getValue());
-
-    // call recursive method to construct the path
-    this->constructPath(parentVertexArray, dest, path);
-
-    // temp values to store symbols and costs
-    std::string symbol1, symbol2;
-    double cost = 0;
-
-    // iterate over the list and store the values into the temp variables
     // since pairs are represented like: "S" -> "K"
-    // we might have a path list like: "S T R"
+    // we might have a path like: "S T R"
     // Thus, the appropriate pairs are: "S" -> "T" and "T" -> "R"
-    for (auto it = path.begin(); it != path.end(); ) {
-        if (symbol1 == "") {
-            symbol1 = *it;
-            ++it;
-        }
-        else if (symbol2 == "") {
-            symbol2 = *it;
-            ++it;
-        }
-        else {
-            // at this point, we have 2 symbols, so we need to find the cost and put a new currency pair
-            // into the list of pairs
-            cost = getWeight(symbol1, symbol2);
-            pairs.emplace_back(symbol1, symbol2, cost);
-
-            // reset values
-            symbol1 = symbol2 = "";
-            cost = 0;
-            // back track the iterator pointer by 1
-            --it;
-        }
-    }
+    const std::vector<unsigned int> path = this->getShortestPathBetweenIds((unsigned int) src, (unsigned int) dest);
+    for (unsigned int i = 1; i < path.size(); ++i)
+        pairs.emplace_back(vertexList[path[i - 1]].getValue(), vertexList[path[i]].getValue(), weightAt(path[i - 1], path[i]));
 
-    // insert the last currency pair from the path list
-    if (symbol1 != "" && symbol2 != "") {
-        cost = getWeight(symbol1, symbol2);
-        pairs.emplace_back(symbol1, symbol2, cost);
-    }
+    return pairs;
+}
 
 
-    // check if the current set of pairs results in smaller rate than direct conversion
-    double totalConvertedPrice = 1; // converting 1 coin
-    for (auto& pair: pairs) {
-        totalConvertedPrice *= pair.getPrice();
-    }
 
-    // direct price from exchanging 'from' coin to 'to' coin
-    double directedPrice = getWeight(from, to);
+template<class T>
+unsigned int UndirectedMatrixGraph<T>::getNumberOfVertexIds() const {
+    return (unsigned int) vertexList.size();
+}
 
-    // if directed price is smaller, return the currency pair directly
-    if (totalConvertedPrice > directedPrice) {
-        pairs = std::list<CurrencyPair>();
-        pairs.emplace_back(from, to, directedPrice);
-    }
+template<class T>
+T UndirectedMatrixGraph<T>::getVertexValue(unsigned int id) const {
+    return vertexList[id].getValue();
+}
 
-    return pairs;
+template<class T>
+void UndirectedMatrixGraph<T>::addEdgeById(unsigned int fromId, unsigned int toId, double cost) {
+    setWeight(fromId, toId, cost);
+    setWeight(toId, fromId, cost);
 }
 
+template<class T>
+void UndirectedMatrixGraph<T>::setWeight(unsigned int fromIndex, unsigned int toIndex, double cost) {
+    double& weight = weightAt(fromIndex, toIndex);
+
+    // the column is in the neighbor list exactly when the entry is not INF
+    if (weight == INF && cost != INF) {
+        neighborLists[fromIndex].push_back(toIndex);
+    } else if (weight != INF && cost == INF) {
+        auto& neighbors = neighborLists[fromIndex];
+        neighbors.erase(std::remove(neighbors.begin(), neighbors.end(), toIndex), neighbors.end());
+    }
 
+    weight = cost;
+}
 
+template<class T>
+double UndirectedMatrixGraph<T>::getWeightById(unsigned int fromId, unsigned int toId) const {
+    return weightAt(fromId, toId);
+}
 
 
+template<class T>
+void UndirectedMatrixGraph<T>::getOutgoingEdges(unsigned int fromId, std::vector< std::pair<unsigned int, double> >& edges) const {
+    edges.clear();
 
+    // neighbor lists only hold the entries that are not INF
+    for (unsigned int v : neighborLists[fromId])
+        edges.emplace_back(v, weightAt(fromId, v));
+}
@@ -6,6 +6,7 @@
 #include "Graph.h"
 #include "UndirectedMatrixGraph.h"
 #include "DirectedMatrixGraph.h"
+#include "DirectedSparseGraph.h"
 #include "CurrencyPairParser.h"
 #include "GraphManager.h"
 
@@ -15,7 +16,7 @@ const std::string kInputFilename = "updated2.csv";
 
 int main()
 {
-    auto * graph = new DirectedMatrixGraph<std::string>();
+    auto * graph = new DirectedSparseGraph<std::string>();
 
 //    graph->addVertex("BTC");
 //    graph->addVertex("XRP");
@@ -31,7 +32,11 @@ int main()
     GraphManager manager("Best Exchange Co.", graph, new CurrencyPairParser());
 
     // make a graph from file
-    manager.updateGraph(kInputFilename);
+    std::string error;
+    if (manager.updateGraph(kInputFilename, error) == 0) {
+        std::cerr << error << "\n";
+        return 1;
+    }
 
     std::cout << "Printing the graph...\n";
     std::cout << graph->toString();
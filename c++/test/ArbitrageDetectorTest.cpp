@@ -0,0 +1,194 @@
+// ArbitrageDetectorTest.cpp
+// Checks ArbitrageDetector::update against a full Bellman-Ford oracle on random tick streams. After every update:
+//   - every cycle reported is simple, follows edges of the graph and is negative, with its true weight
+//   - the graph without the edges of the cycles reported has no negative cycle left: every cycle that does not share
+//     an edge with a reported one was found in the same update
+// and that disjoint cycles made negative by the same update are all reported by it.
+//
+// usage: arbitragedetector_test    (exits with 1 on the first mismatch)
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ArbitrageDetector.h"
+#include "DirectedSparseGraph.h"
+
+static void fail(const std::string& stream, unsigned int tick, const std::string& message)
+{
+    std::cerr << stream << ", tick " << tick << ": " << message << std::endl;
+    std::exit(1);
+}
+
+// Bellman-Ford from a virtual source with an edge of weight 0 to every vertex, leaving out the excluded edges.
+// True if some distance still improves after V rounds
+static bool hasNegativeCycle(const Graph<std::string>& graph, const std::set< std::pair<unsigned int, unsigned int> >& excluded)
+{
+    const unsigned int numberOfVertices = graph.getNumberOfVertexIds();
+    std::vector<double> distances(numberOfVertices, 0);
+    std::vector< std::pair<unsigned int, double> > edges;
+
+    for (unsigned int round = 0; round <= numberOfVertices; ++round) {
+        bool improved = false;
+        for (unsigned int from = 0; from < numberOfVertices; ++from) {
+            graph.getOutgoingEdges(from, edges);
+            for (auto& edge : edges) {
+                if (excluded.count(std::make_pair(from, edge.first)))
+                    continue;
+
+                if (distances[from] + edge.second < distances[edge.first] - 1e-9) {
+                    distances[edge.first] = distances[from] + edge.second;
+                    improved = true;
+                }
+            }
+        }
+
+        if (!improved)
+            return false;
+    }
+
+    return true;
+}
+
+static void checkCycles(const std::string& stream, unsigned int tick, const Graph<std::string>& graph,
+                        const std::vector<ArbitrageDetector::Cycle>& cycles)
+{
+    std::set< std::pair<unsigned int, unsigned int> > cycleEdges;
+
+    for (auto& cycle : cycles) {
+        const std::vector<unsigned int>& vertices = cycle.vertices;
+        if (vertices.size() < 2 || std::set<unsigned int>(vertices.begin(), vertices.end()).size() != vertices.size())
+            fail(stream, tick, "cycle is not simple");
+
+        double weight = 0;
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            const unsigned int from = vertices[i];
+            const unsigned int to = vertices[(i + 1) % vertices.size()];
+            const double edge = graph.getWeightById(from, to);
+            if (edge == INF)
+                fail(stream, tick, "cycle uses a missing edge");
+
+            weight += edge;
+            cycleEdges.insert(std::make_pair(from, to));
+        }
+
+        if (!(weight < 0) || std::fabs(weight - cycle.weight) > 1e-9)
+            fail(stream, tick, "cycle is not negative or has a wrong weight");
+    }
+
+    if (hasNegativeCycle(graph, cycleEdges))
+        fail(stream, tick, "negative cycle missed");
+}
+
+// set the weight of both directions of a market, recording the changes for the detector
+static void setRate(DirectedSparseGraph<std::string>& graph, unsigned int from, unsigned int to, double weight,
+                    std::vector<AllPairsShortestPaths::EdgeChange>& changes)
+{
+    changes.push_back({from, to, graph.getWeightById(from, to), weight});
+    changes.push_back({to, from, graph.getWeightById(to, from), -weight});
+    graph.addEdgeById(from, to, weight);
+    graph.addEdgeById(to, from, -weight);
+}
+
+// markets between currencies with consistent log prices, a few of them mispriced on every tick, and everything
+// repriced consistently now and then
+static void runTickStream(unsigned int numberOfCurrencies, unsigned int numberOfTicks, unsigned int seed)
+{
+    const std::string stream = std::to_string(numberOfCurrencies) + " currencies, seed " + std::to_string(seed);
+
+    std::mt19937 random(seed);
+    DirectedSparseGraph<std::string> graph;
+    for (unsigned int i = 0; i < numberOfCurrencies; ++i)
+        graph.addVertex("C" + std::to_string(i));
+
+    std::vector<double> logValues(numberOfCurrencies);
+    for (double& value : logValues)
+        value = std::log(1.0 + (random() % 10000) / 100.0);
+
+    std::vector< std::pair<unsigned int, unsigned int> > markets;
+    for (unsigned int i = 1; i < numberOfCurrencies; ++i) {
+        markets.emplace_back(i, random() % std::min(i, 4u));
+        if (random() % 2) {
+            const unsigned int other = random() % numberOfCurrencies;
+            if (other != i)
+                markets.emplace_back(i, other);
+        }
+    }
+
+    std::vector<AllPairsShortestPaths::EdgeChange> changes;
+    for (auto& market : markets)
+        setRate(graph, market.first, market.second, logValues[market.first] - logValues[market.second], changes);
+
+    ArbitrageDetector detector;
+    checkCycles(stream, 0, graph, detector.update(graph, changes, true));
+
+    for (unsigned int tick = 1; tick <= numberOfTicks; ++tick) {
+        changes.clear();
+
+        if (tick % 5 == 0) {
+            for (auto& market : markets)
+                setRate(graph, market.first, market.second, logValues[market.first] - logValues[market.second], changes);
+        }
+
+        const unsigned int numberOfMispricings = 1 + random() % 4;
+        for (unsigned int i = 0; i < numberOfMispricings; ++i) {
+            const std::pair<unsigned int, unsigned int>& market = markets[random() % markets.size()];
+            const double noise = ((int) (random() % 200) - 100) / 10000.0;
+            setRate(graph, market.first, market.second, logValues[market.first] - logValues[market.second] + noise, changes);
+        }
+
+        checkCycles(stream, tick, graph, detector.update(graph, changes, false));
+    }
+}
+
+// three triangles mispriced by the same update are three cycles of that update
+static void checkDisjointTriangles()
+{
+    DirectedSparseGraph<std::string> graph;
+    for (unsigned int i = 0; i < 9; ++i)
+        graph.addVertex("C" + std::to_string(i));
+
+    std::vector<AllPairsShortestPaths::EdgeChange> changes;
+    for (unsigned int t = 0; t < 3; ++t) {
+        setRate(graph, 3 * t, 3 * t + 1, std::log(2.0), changes);
+        setRate(graph, 3 * t + 1, 3 * t + 2, std::log(2.0), changes);
+        setRate(graph, 3 * t + 2, 3 * t, std::log(0.25), changes);
+    }
+
+    ArbitrageDetector detector;
+    if (!detector.update(graph, changes, true).empty())
+        fail("triangles", 0, "cycle reported without arbitrage");
+
+    changes.clear();
+    for (unsigned int t = 0; t < 3; ++t)
+        setRate(graph, 3 * t + 2, 3 * t, std::log(0.2), changes);
+
+    const std::vector<ArbitrageDetector::Cycle>& cycles = detector.update(graph, changes, false);
+    checkCycles("triangles", 1, graph, cycles);
+    if (cycles.size() != 3)
+        fail("triangles", 1, "found " + std::to_string(cycles.size()) + " cycles, expected 3");
+}
+
+int main()
+{
+    checkDisjointTriangles();
+    std::cout << "disjoint triangles: all reported by the update that mispriced them" << std::endl;
+
+    const unsigned int sizes[] = { 8, 60, 200 };
+    unsigned int numberOfStreams = 0;
+    for (unsigned int size : sizes) {
+        for (unsigned int seed = 1; seed <= 10; ++seed) {
+            runTickStream(size, 200, seed);
+            ++numberOfStreams;
+        }
+    }
+
+    std::cout << "tick streams: " << numberOfStreams << " streams of 200 ticks match the Bellman-Ford oracle" << std::endl;
+
+    return 0;
+}
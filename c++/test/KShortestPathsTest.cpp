@@ -0,0 +1,193 @@
+// KShortestPathsTest.cpp
+// Checks KShortestPaths::find against brute force enumeration of the simple paths on random small graphs:
+//   - graphs with negative weights but no negative cycle, with and without hop limits: same ranked weights
+//   - graphs with negative cycles: only distinct simple routes along real edges, with their true weights
+//
+// usage: kshortestpaths_test    (exits with 1 on the first mismatch)
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "DirectedSparseGraph.h"
+#include "KShortestPaths.h"
+
+static const unsigned int kNumberOfGraphs = 257;
+static const unsigned int kMaxK = 12;
+
+static void fail(unsigned int graph, const std::string& message)
+{
+    std::cerr << "graph " << graph << ": " << message << std::endl;
+    std::exit(1);
+}
+
+// random graph of a few vertices. Without negative cycles the weights are differences of vertex potentials plus a
+// positive margin, so edges may be negative but every cycle costs more than 0
+static DirectedSparseGraph<std::string> makeGraph(std::mt19937& random, bool negativeCycles)
+{
+    DirectedSparseGraph<std::string> graph;
+
+    const unsigned int numberOfVertices = 3 + random() % 6;
+    for (unsigned int v = 0; v < numberOfVertices; ++v)
+        graph.addVertex(std::to_string(v));
+
+    std::uniform_real_distribution<double> potential(-2, 2);
+    std::uniform_real_distribution<double> margin(0.01, 1);
+    std::vector<double> potentials(numberOfVertices);
+    for (double& p : potentials)
+        p = potential(random);
+
+    const unsigned int numberOfEdges = numberOfVertices * (1 + random() % 3);
+    for (unsigned int e = 0; e < numberOfEdges; ++e) {
+        const unsigned int from = random() % numberOfVertices;
+        const unsigned int to = random() % numberOfVertices;
+        if (from == to)
+            continue;
+
+        const double weight = negativeCycles ? potential(random) : potentials[to] - potentials[from] + margin(random);
+        graph.addEdgeById(from, to, weight);
+    }
+
+    return graph;
+}
+
+// weights of every simple path of at most maxHops edges (0 for no limit) from 'from' to 'to'
+static void enumeratePaths(const Graph<std::string>& graph, unsigned int vertex, unsigned int to, unsigned int maxHops,
+                           std::vector<bool>& onPath, unsigned int hops, double weight, std::vector<double>& weights)
+{
+    if (vertex == to) {
+        weights.push_back(weight);
+        return;
+    }
+
+    if (maxHops != 0 && hops == maxHops)
+        return;
+
+    onPath[vertex] = true;
+
+    std::vector< std::pair<unsigned int, double> > edges;
+    graph.getOutgoingEdges(vertex, edges);
+    for (auto& edge : edges) {
+        if (!onPath[edge.first])
+            enumeratePaths(graph, edge.first, to, maxHops, onPath, hops + 1, weight + edge.second, weights);
+    }
+
+    onPath[vertex] = false;
+}
+
+// every route starts at 'from', ends at 'to', is simple, follows edges of the graph, has its true weight and is new
+static void checkRoutes(unsigned int graphIndex, const Graph<std::string>& graph, unsigned int from, unsigned int to,
+                        unsigned int maxHops, const std::vector<KShortestPaths::Route>& routes)
+{
+    std::set< std::vector<unsigned int> > seen;
+
+    for (auto& route : routes) {
+        const std::vector<unsigned int>& path = route.path;
+        if (path.size() < 2 || path.front() != from || path.back() != to)
+            fail(graphIndex, "route does not join the queried vertices");
+
+        if (maxHops != 0 && path.size() - 1 > maxHops)
+            fail(graphIndex, "route longer than the hop limit");
+
+        if (std::set<unsigned int>(path.begin(), path.end()).size() != path.size())
+            fail(graphIndex, "route is not simple");
+
+        double weight = 0;
+        for (size_t i = 1; i < path.size(); ++i) {
+            const double edge = graph.getWeightById(path[i - 1], path[i]);
+            if (edge == INF)
+                fail(graphIndex, "route uses a missing edge");
+            weight += edge;
+        }
+
+        if (std::fabs(weight - route.weight) > 1e-9)
+            fail(graphIndex, "route weight is not the sum of its edges");
+
+        if (!seen.insert(path).second)
+            fail(graphIndex, "route returned twice");
+    }
+}
+
+int main()
+{
+    std::mt19937 random(17);
+    unsigned long numberOfQueries = 0;
+
+    for (unsigned int graphIndex = 0; graphIndex < kNumberOfGraphs; ++graphIndex) {
+        const DirectedSparseGraph<std::string> graph = makeGraph(random, false);
+        const KShortestPaths search(graph);
+        const unsigned int numberOfVertices = graph.getNumberOfVertexIds();
+
+        for (unsigned int from = 0; from < numberOfVertices; ++from) {
+            for (unsigned int to = 0; to < numberOfVertices; ++to) {
+                if (from == to)
+                    continue;
+
+                for (unsigned int maxHops = 0; maxHops <= 3; ++maxHops) {
+                    std::vector<bool> onPath(numberOfVertices, false);
+                    std::vector<double> expected;
+                    enumeratePaths(graph, from, to, maxHops, onPath, 0, 0, expected);
+                    std::sort(expected.begin(), expected.end());
+                    if (expected.size() > kMaxK)
+                        expected.resize(kMaxK);
+
+                    const std::vector<KShortestPaths::Route> routes = search.find(from, to, kMaxK, maxHops);
+                    checkRoutes(graphIndex, graph, from, to, maxHops, routes);
+
+                    if (routes.size() != expected.size())
+                        fail(graphIndex, "found " + std::to_string(routes.size()) + " routes, expected " +
+                                         std::to_string(expected.size()));
+
+                    for (size_t i = 0; i < routes.size(); ++i) {
+                        if (std::fabs(routes[i].weight - expected[i]) > 1e-9)
+                            fail(graphIndex, "route " + std::to_string(i) + " is not the next best");
+                    }
+
+                    ++numberOfQueries;
+                }
+            }
+        }
+    }
+
+    std::cout << "without negative cycles: " << kNumberOfGraphs << " graphs, " << numberOfQueries
+              << " queries match brute force" << std::endl;
+
+    numberOfQueries = 0;
+    for (unsigned int graphIndex = 0; graphIndex < kNumberOfGraphs; ++graphIndex) {
+        const DirectedSparseGraph<std::string> graph = makeGraph(random, true);
+        const KShortestPaths search(graph);
+        const unsigned int numberOfVertices = graph.getNumberOfVertexIds();
+
+        for (unsigned int from = 0; from < numberOfVertices; ++from) {
+            for (unsigned int to = 0; to < numberOfVertices; ++to) {
+                if (from == to)
+                    continue;
+
+                for (unsigned int maxHops = 0; maxHops <= 3; ++maxHops) {
+                    std::vector<bool> onPath(numberOfVertices, false);
+                    std::vector<double> expected;
+                    enumeratePaths(graph, from, to, maxHops, onPath, 0, 0, expected);
+
+                    const std::vector<KShortestPaths::Route> routes = search.find(from, to, kMaxK, maxHops);
+                    checkRoutes(graphIndex + kNumberOfGraphs, graph, from, to, maxHops, routes);
+
+                    // a route exists exactly when some simple path does
+                    if (routes.empty() != expected.empty())
+                        fail(graphIndex + kNumberOfGraphs, "route found for unreachable vertex or missed");
+
+                    ++numberOfQueries;
+                }
+            }
+        }
+    }
+
+    std::cout << "with negative cycles: " << kNumberOfGraphs << " graphs, " << numberOfQueries
+              << " queries give valid simple routes" << std::endl;
+
+    return 0;
+}
@@ -4,6 +4,342 @@
 
 #include "GraphManagerInterface.h"
 
+namespace {
+
+// Read an array of [src, dest] symbol pairs. Returns false if the value has any other shape
+bool toRouteList(v8::Local<v8::Value> value, std::vector< std::pair<std::string, std::string> >& routes)
+{
+    if (!value->IsArray())
+        return false;
+
+    v8::Local<v8::Array> array = value.As<v8::Array>();
+    routes.reserve(array->Length());
+
+    for (uint32_t i = 0; i < array->Length(); ++i) {
+        v8::Local<v8::Value> route = Nan::Get(array, i).ToLocalChecked();
+        if (!route->IsArray() || route.As<v8::Array>()->Length() != 2)
+            return false;
+
+        v8::Local<v8::Value> src = Nan::Get(route.As<v8::Array>(), 0).ToLocalChecked();
+        v8::Local<v8::Value> dest = Nan::Get(route.As<v8::Array>(), 1).ToLocalChecked();
+        if (!src->IsString() || !dest->IsString())
+            return false;
+
+        v8::String::Utf8Value utf8SrcStr(src->ToString());
+        v8::String::Utf8Value utf8DestStr(dest->ToString());
+        routes.emplace_back(std::string(*utf8SrcStr), std::string(*utf8DestStr));
+    }
+
+    return true;
+}
+
+// One array per route, holding the same "from,to,price" strings as findBestExchangeRoute
+v8::Local<v8::Array> toRouteArrays(const std::vector< std::list<CurrencyPair> >& routes)
+{
+    v8::Local<v8::Array> result = Nan::New<v8::Array>(routes.size());
+
+    for (size_t i = 0; i < routes.size(); ++i) {
+        v8::Local<v8::Array> array = Nan::New<v8::Array>(routes[i].size());
+
+        unsigned j = 0;
+        for (auto it = routes[i].cbegin(); it != routes[i].cend(); ++it)
+        {
+            std::string pairsString = it->getFromSymbol() + "," + it->getToSymbol() + "," + std::to_string(it->getPrice());
+            Nan::Set(array, j++, Nan::New(pairsString).ToLocalChecked());
+        }
+
+        Nan::Set(result, i, array);
+    }
+
+    return result;
+}
+
+// One object per cycle: 'pairs', an array of "from,to,price" strings, and 'gain'
+v8::Local<v8::Array> toCycleObjects(const std::vector<ArbitrageCycle>& cycles)
+{
+    std::vector< std::list<CurrencyPair> > pairs;
+    pairs.reserve(cycles.size());
+    for (auto& cycle : cycles)
+        pairs.push_back(cycle.pairs);
+
+    v8::Local<v8::Array> pairArrays = toRouteArrays(pairs);
+    v8::Local<v8::Array> result = Nan::New<v8::Array>(cycles.size());
+
+    for (size_t i = 0; i < cycles.size(); ++i) {
+        v8::Local<v8::Object> cycle = Nan::New<v8::Object>();
+        Nan::Set(cycle, Nan::New("pairs").ToLocalChecked(), Nan::Get(pairArrays, i).ToLocalChecked());
+        Nan::Set(cycle, Nan::New("gain").ToLocalChecked(), Nan::New(cycles[i].gain));
+        Nan::Set(result, i, cycle);
+    }
+
+    return result;
+}
+
+// Counts and sizes as numbers, latencies in microseconds: { version, refreshes, vertices, edges, changedEdges,
+// operations: { name: { count, samples, meanUs, p50Us, p90Us, p99Us, p999Us, maxUs } } }, samples being the timed calls
+v8::Local<v8::Object> toStatsObject(const GraphManagerStats& stats)
+{
+    v8::Local<v8::Object> operations = Nan::New<v8::Object>();
+    for (auto& operation : stats.operations) {
+        const LatencyHistogram::Summary& latency = operation.latency;
+
+        v8::Local<v8::Object> summary = Nan::New<v8::Object>();
+        Nan::Set(summary, Nan::New("count").ToLocalChecked(), Nan::New(static_cast<double>(latency.count)));
+        Nan::Set(summary, Nan::New("samples").ToLocalChecked(), Nan::New(static_cast<double>(latency.sampleCount)));
+        Nan::Set(summary, Nan::New("meanUs").ToLocalChecked(), Nan::New(latency.meanNanoseconds / 1e3));
+        Nan::Set(summary, Nan::New("p50Us").ToLocalChecked(), Nan::New(latency.p50Nanoseconds / 1e3));
+        Nan::Set(summary, Nan::New("p90Us").ToLocalChecked(), Nan::New(latency.p90Nanoseconds / 1e3));
+        Nan::Set(summary, Nan::New("p99Us").ToLocalChecked(), Nan::New(latency.p99Nanoseconds / 1e3));
+        Nan::Set(summary, Nan::New("p999Us").ToLocalChecked(), Nan::New(latency.p999Nanoseconds / 1e3));
+        Nan::Set(summary, Nan::New("maxUs").ToLocalChecked(), Nan::New(latency.maxNanoseconds / 1e3));
+        Nan::Set(operations, Nan::New(operation.name).ToLocalChecked(), summary);
+    }
+
+    v8::Local<v8::Object> result = Nan::New<v8::Object>();
+    Nan::Set(result, Nan::New("version").ToLocalChecked(), Nan::New(static_cast<double>(stats.version)));
+    Nan::Set(result, Nan::New("refreshes").ToLocalChecked(), Nan::New(static_cast<double>(stats.numberOfRefreshes)));
+    Nan::Set(result, Nan::New("vertices").ToLocalChecked(), Nan::New(static_cast<double>(stats.numberOfVertices)));
+    Nan::Set(result, Nan::New("edges").ToLocalChecked(), Nan::New(static_cast<double>(stats.numberOfEdges)));
+    Nan::Set(result, Nan::New("changedEdges").ToLocalChecked(), Nan::New(static_cast<double>(stats.numberOfChangedEdges)));
+    Nan::Set(result, Nan::New("operations").ToLocalChecked(), operations);
+
+    return result;
+}
+
+// { phase: { calls, ms, cycles, instructions, ... } }, totals of every call, null for the unavailable counters
+v8::Local<v8::Object> toPerfObject(const std::vector<PerfCounters::Phase>& phases)
+{
+    v8::Local<v8::Object> result = Nan::New<v8::Object>();
+    for (auto& phase : phases) {
+        v8::Local<v8::Object> counts = Nan::New<v8::Object>();
+        Nan::Set(counts, Nan::New("calls").ToLocalChecked(), Nan::New(static_cast<double>(phase.calls)));
+        Nan::Set(counts, Nan::New("ms").ToLocalChecked(), Nan::New(phase.nanoseconds / 1e6));
+
+        for (unsigned int counter = 0; counter < PerfCounters::kNumberOfCounters; ++counter) {
+            v8::Local<v8::Value> value = Nan::Null();
+            if (phase.available[counter])
+                value = Nan::New(static_cast<double>(phase.counts[counter]));
+            Nan::Set(counts, Nan::New(PerfCounters::kCounterNames[counter]).ToLocalChecked(), value);
+        }
+
+        Nan::Set(result, Nan::New(phase.name).ToLocalChecked(), counts);
+    }
+
+    return result;
+}
+
+// Settle the Promise::Resolver given as the data of the function with its first argument
+void resolvePromise(const Nan::FunctionCallbackInfo<v8::Value>& info)
+{
+    info.Data().As<v8::Promise::Resolver>()->Resolve(Nan::GetCurrentContext(), info[0]).FromMaybe(false);
+}
+
+void rejectPromise(const Nan::FunctionCallbackInfo<v8::Value>& info)
+{
+    info.Data().As<v8::Promise::Resolver>()->Reject(Nan::GetCurrentContext(), info[0]).FromMaybe(false);
+}
+
+// Base of the async methods: Execute runs on the libuv thread pool, the Promise is resolved or rejected back on
+// the main thread. Queries run alongside updates, on the snapshot that was current when they started
+class GraphManagerWorker : public Nan::AsyncWorker
+{
+protected:
+    GraphManager& graphManager;
+    Nan::Persistent<v8::Promise::Resolver> resolver;
+
+    // runs on the libuv thread pool
+    virtual void ExecuteWork() = 0;
+
+    // value the Promise resolves with
+    virtual v8::Local<v8::Value> Result() = 0;
+
+    // Settling the Promise queues its reactions as microtasks, which nothing drains when the work completes outside of
+    // JavaScript. Calling through the async resource, as Nan::Callback does, runs inside a callback scope: the
+    // microtasks run when it closes, and async_hooks see the reactions in the context of the call that started the work
+    void settle(Nan::FunctionCallback settlePromise, v8::Local<v8::Value> value)
+    {
+        v8::Local<v8::Function> function = Nan::New<v8::Function>(settlePromise, Nan::New(resolver));
+        async_resource->runInAsyncScope(Nan::GetCurrentContext()->Global(), function, 1, &value);
+    }
+
+public:
+    GraphManagerWorker(v8::Local<v8::Object> self, GraphManager& graphManager) :
+        Nan::AsyncWorker(nullptr, "kryptos:GraphManager"), graphManager(graphManager)
+    {
+        // keep the JS object, and with it the manager, alive until the work is done
+        SaveToPersistent("self", self);
+        resolver.Reset(v8::Promise::Resolver::New(Nan::GetCurrentContext()).ToLocalChecked());
+    }
+
+    ~GraphManagerWorker()
+    {
+        resolver.Reset();
+    }
+
+    v8::Local<v8::Promise> GetPromise()
+    {
+        return Nan::New(resolver)->GetPromise();
+    }
+
+    void Execute() override
+    {
+        try {
+            ExecuteWork();
+        } catch (const std::exception& e) {
+            SetErrorMessage(e.what());
+        }
+    }
+
+    void HandleOKCallback() override
+    {
+        Nan::HandleScope scope;
+        settle(resolvePromise, Result());
+    }
+
+    void HandleErrorCallback() override
+    {
+        Nan::HandleScope scope;
+        settle(rejectPromise, Nan::Error(ErrorMessage()));
+    }
+};
+
+class UpdateGraphWorker : public GraphManagerWorker
+{
+private:
+    std::string fileName;
+    size_t applied;
+
+public:
+    UpdateGraphWorker(v8::Local<v8::Object> self, GraphManager& graphManager,
+                      const std::string& fileName) :
+        GraphManagerWorker(self, graphManager), fileName(fileName), applied(0) {}
+
+    // a file that could not be read or had no rates rejects the Promise
+    void ExecuteWork() override
+    {
+        std::string error;
+        applied = graphManager.updateGraph(fileName, error);
+        if (applied == 0)
+            SetErrorMessage(error.c_str());
+    }
+
+    v8::Local<v8::Value> Result() override
+    {
+        return Nan::New(static_cast<double>(applied));
+    }
+};
+
+class UpdateGraphFromBufferWorker : public GraphManagerWorker
+{
+private:
+    const char* data;
+    size_t length;
+    size_t applied;
+
+public:
+    // The Buffer is kept alive by the worker, its bytes are parsed in place on the thread pool
+    UpdateGraphFromBufferWorker(v8::Local<v8::Object> self, GraphManager& graphManager,
+                                v8::Local<v8::Value> buffer) :
+        GraphManagerWorker(self, graphManager), data(nullptr), length(0), applied(0)
+    {
+        SaveToPersistent("buffer", buffer);
+
+        Nan::TypedArrayContents<char> contents(buffer);
+        data = *contents;
+        length = contents.length();
+    }
+
+    void ExecuteWork() override
+    {
+        applied = graphManager.updateGraphFromBuffer(data, length);
+    }
+
+    v8::Local<v8::Value> Result() override
+    {
+        return Nan::New(static_cast<double>(applied));
+    }
+};
+
+class FindBestExchangeRouteWorker : public GraphManagerWorker
+{
+private:
+    std::string srcStr;
+    std::string destStr;
+    std::list<CurrencyPair> pairs;
+
+public:
+    FindBestExchangeRouteWorker(v8::Local<v8::Object> self, GraphManager& graphManager,
+                                const std::string& srcStr, const std::string& destStr) :
+        GraphManagerWorker(self, graphManager), srcStr(srcStr), destStr(destStr) {}
+
+    void ExecuteWork() override
+    {
+        pairs = graphManager.findBestExchangeRoute(srcStr, destStr);
+    }
+
+    // same strings as findBestExchangeRoute
+    v8::Local<v8::Value> Result() override
+    {
+        v8::Local<v8::Array> array = Nan::New<v8::Array>(pairs.size());
+
+        unsigned i = 0;
+        for (auto it = pairs.cbegin(); it != pairs.cend(); ++it)
+        {
+            std::string pairsString = it->getFromSymbol() + "," + it->getToSymbol() + "," + std::to_string(it->getPrice());
+            Nan::Set(array, i++, Nan::New(pairsString).ToLocalChecked());
+        }
+
+        return array;
+    }
+};
+
+class FindBestExchangeRoutesWorker : public GraphManagerWorker
+{
+private:
+    std::vector< std::pair<std::string, std::string> > routes;
+    std::vector< std::list<CurrencyPair> > pairs;
+
+public:
+    FindBestExchangeRoutesWorker(v8::Local<v8::Object> self, GraphManager& graphManager,
+                                 std::vector< std::pair<std::string, std::string> >&& routes) :
+        GraphManagerWorker(self, graphManager), routes(std::move(routes)) {}
+
+    void ExecuteWork() override
+    {
+        pairs = graphManager.findBestExchangeRoutes(routes);
+    }
+
+    v8::Local<v8::Value> Result() override
+    {
+        return toRouteArrays(pairs);
+    }
+};
+
+class GetCostForExchangeWorker : public GraphManagerWorker
+{
+private:
+    std::string srcStr;
+    std::string destStr;
+    double cost;
+
+public:
+    GetCostForExchangeWorker(v8::Local<v8::Object> self, GraphManager& graphManager,
+                             const std::string& srcStr, const std::string& destStr) :
+        GraphManagerWorker(self, graphManager), srcStr(srcStr), destStr(destStr), cost(0) {}
+
+    void ExecuteWork() override
+    {
+        cost = graphManager.getCostForExchange(srcStr, destStr);
+    }
+
+    v8::Local<v8::Value> Result() override
+    {
+        return Nan::New(cost);
+    }
+};
+
+}
+
 // Module Init
 NAN_MODULE_INIT(GraphManagerInterface::Init)
 {
@@ -17,7 +353,27 @@ NAN_MODULE_INIT(GraphManagerInterface::Init)
     // Nan::SetPrototypeMethod(ctor, "getLastUpdateTimestamp", getLastUpdateTimestamp);
     Nan::SetPrototypeMethod(ctor, "getCostForExchange", getCostForExchange);
     Nan::SetPrototypeMethod(ctor, "updateGraph", updateGraph);
+    Nan::SetPrototypeMethod(ctor, "updateGraphFromBuffer", updateGraphFromBuffer);
+    Nan::SetPrototypeMethod(ctor, "internCurrency", internCurrency);
+    Nan::SetPrototypeMethod(ctor, "applyRateBatch", applyRateBatch);
+    Nan::SetPrototypeMethod(ctor, "saveSnapshot", saveSnapshot);
+    Nan::SetPrototypeMethod(ctor, "loadSnapshot", loadSnapshot);
+    Nan::SetPrototypeMethod(ctor, "startRecording", startRecording);
+    Nan::SetPrototypeMethod(ctor, "stopRecording", stopRecording);
+    Nan::SetPrototypeMethod(ctor, "getStats", getStats);
+    Nan::SetPrototypeMethod(ctor, "dumpTrace", dumpTrace);
+    Nan::SetPrototypeMethod(ctor, "setPerfCounters", setPerfCounters);
+    Nan::SetPrototypeMethod(ctor, "getPerfCounters", getPerfCounters);
+    Nan::SetPrototypeMethod(ctor, "updateGraphAsync", updateGraphAsync);
+    Nan::SetPrototypeMethod(ctor, "updateGraphFromBufferAsync", updateGraphFromBufferAsync);
+    Nan::SetPrototypeMethod(ctor, "findBestExchangeRouteAsync", findBestExchangeRouteAsync);
+    Nan::SetPrototypeMethod(ctor, "getCostForExchangeAsync", getCostForExchangeAsync);
     Nan::SetPrototypeMethod(ctor, "findBestExchangeRoute", findBestExchangeRoute);
+    Nan::SetPrototypeMethod(ctor, "findBestExchangeRoutes", findBestExchangeRoutes);
+    Nan::SetPrototypeMethod(ctor, "findAlternativeRoutes", findAlternativeRoutes);
+    Nan::SetPrototypeMethod(ctor, "getArbitrageCycles", getArbitrageCycles);
+    Nan::SetPrototypeMethod(ctor, "findShortArbitrageCycles", findShortArbitrageCycles);
+    Nan::SetPrototypeMethod(ctor, "findBestExchangeRoutesAsync", findBestExchangeRoutesAsync);
 
     target->Set(Nan::New("GraphManagerInterface").ToLocalChecked(), ctor->GetFunction());
 }
@@ -55,7 +411,7 @@ NAN_METHOD(GraphManagerInterface::New)
     info.GetReturnValue().Set(info.Holder());
 }
 
-GraphManagerInterface::GraphManagerInterface(std::string& nameOfExchange): graphManager(new GraphManager(nameOfExchange, new DirectedMatrixGraph<std::string>(), new CurrencyPairParser()))
+GraphManagerInterface::GraphManagerInterface(std::string& nameOfExchange): graphManager(new GraphManager(nameOfExchange, new DirectedSparseGraph<std::string>(), new CurrencyPairParser()))
 {
 }
 
@@ -122,7 +478,193 @@ NAN_METHOD(GraphManagerInterface::updateGraph)
     v8::String::Utf8Value utf8Str(info[0]->ToString());
     std::string str = std::string(*utf8Str);
 
-    self->graphManager->updateGraph(str);
+    std::string error;
+    size_t applied = self->graphManager->updateGraph(str, error);
+    if (applied == 0)
+        return Nan::ThrowError(Nan::New(error).ToLocalChecked());
+
+    info.GetReturnValue().Set(static_cast<double>(applied));
+}
+
+NAN_METHOD(GraphManagerInterface::updateGraphFromBuffer)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 1)
+        return Nan::ThrowError(Nan::New("'updateGraphFromBuffer' expects 1 argument'").ToLocalChecked());
+
+    if (!info[0]->IsArrayBufferView())
+        return Nan::ThrowError(Nan::New("'updateGraphFromBuffer' expects a Buffer or TypedArray with \"from,to,price\" lines").ToLocalChecked());
+
+    // The bytes of the Buffer are parsed in place, nothing is copied or written to disk
+    Nan::TypedArrayContents<char> contents(info[0]);
+    size_t applied = self->graphManager->updateGraphFromBuffer(*contents, contents.length());
+
+    info.GetReturnValue().Set(static_cast<double>(applied));
+}
+
+NAN_METHOD(GraphManagerInterface::internCurrency)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 1)
+        return Nan::ThrowError(Nan::New("'internCurrency' expects 1 argument'").ToLocalChecked());
+
+    if (!info[0]->IsString())
+        return Nan::ThrowError(Nan::New("'internCurrency' expects a string argument").ToLocalChecked());
+
+    // Convert argument to std::string type
+    v8::String::Utf8Value utf8Str(info[0]->ToString());
+    std::string str = std::string(*utf8Str);
+
+    info.GetReturnValue().Set(self->graphManager->internCurrency(str));
+}
+
+NAN_METHOD(GraphManagerInterface::applyRateBatch)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 1)
+        return Nan::ThrowError(Nan::New("'applyRateBatch' expects 1 argument'").ToLocalChecked());
+
+    if (!info[0]->IsArrayBufferView())
+        return Nan::ThrowError(Nan::New("'applyRateBatch' expects a Buffer or TypedArray of records").ToLocalChecked());
+
+    // Records of 16 bytes: uint32 from id, uint32 to id (from internCurrency), float64 price, host byte order
+    Nan::TypedArrayContents<char> contents(info[0]);
+    size_t applied = self->graphManager->applyRateBatch(static_cast<const void*>(*contents), contents.length());
+
+    info.GetReturnValue().Set(static_cast<double>(applied));
+}
+
+NAN_METHOD(GraphManagerInterface::saveSnapshot)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 1 && info.Length() != 2)
+        return Nan::ThrowError(Nan::New("'saveSnapshot' expects 1 or 2 arguments'").ToLocalChecked());
+
+    if (!info[0]->IsString() || (info.Length() == 2 && !info[1]->IsBoolean()))
+        return Nan::ThrowError(Nan::New("'saveSnapshot' expects a file name and an optional boolean").ToLocalChecked());
+
+    // Convert argument to std::string type
+    v8::String::Utf8Value utf8Str(info[0]->ToString());
+    std::string str = std::string(*utf8Str);
+
+    const bool withAllPairs = info.Length() == 2 && Nan::To<bool>(info[1]).FromJust();
+
+    std::string error;
+    if (!self->graphManager->saveSnapshot(str, withAllPairs, error))
+        return Nan::ThrowError(Nan::New("'saveSnapshot' failed: " + error).ToLocalChecked());
+}
+
+NAN_METHOD(GraphManagerInterface::loadSnapshot)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 1)
+        return Nan::ThrowError(Nan::New("'loadSnapshot' expects 1 argument'").ToLocalChecked());
+
+    if (!info[0]->IsString())
+        return Nan::ThrowError(Nan::New("'loadSnapshot' expects a string argument").ToLocalChecked());
+
+    // Convert argument to std::string type
+    v8::String::Utf8Value utf8Str(info[0]->ToString());
+    std::string str = std::string(*utf8Str);
+
+    std::string error;
+    if (!self->graphManager->loadSnapshot(str, error))
+        return Nan::ThrowError(Nan::New("'loadSnapshot' failed: " + error).ToLocalChecked());
+}
+
+NAN_METHOD(GraphManagerInterface::startRecording)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 1)
+        return Nan::ThrowError(Nan::New("'startRecording' expects 1 argument'").ToLocalChecked());
+
+    if (!info[0]->IsString())
+        return Nan::ThrowError(Nan::New("'startRecording' expects a string argument").ToLocalChecked());
+
+    // Convert argument to std::string type
+    v8::String::Utf8Value utf8Str(info[0]->ToString());
+    std::string str = std::string(*utf8Str);
+
+    std::string error;
+    if (!self->graphManager->startRecording(str, error))
+        return Nan::ThrowError(Nan::New("'startRecording' failed: " + error).ToLocalChecked());
+}
+
+NAN_METHOD(GraphManagerInterface::stopRecording)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 0)
+        return Nan::ThrowError(Nan::New("'stopRecording' expects no arguments'").ToLocalChecked());
+
+    std::string error;
+    if (!self->graphManager->stopRecording(error))
+        return Nan::ThrowError(Nan::New("'stopRecording' failed: " + error).ToLocalChecked());
+}
+
+NAN_METHOD(GraphManagerInterface::getStats)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 0)
+        return Nan::ThrowError(Nan::New("'getStats' expects no arguments'").ToLocalChecked());
+
+    info.GetReturnValue().Set(toStatsObject(self->graphManager->stats()));
+}
+
+NAN_METHOD(GraphManagerInterface::dumpTrace)
+{
+    if (info.Length() != 1)
+        return Nan::ThrowError(Nan::New("'dumpTrace' expects 1 argument'").ToLocalChecked());
+
+    if (!info[0]->IsString())
+        return Nan::ThrowError(Nan::New("'dumpTrace' expects a string argument").ToLocalChecked());
+
+    // Convert argument to std::string type
+    v8::String::Utf8Value utf8Str(info[0]->ToString());
+    std::string str = std::string(*utf8Str);
+
+    std::string error;
+    if (!Trace::dumpChromeJson(str, error))
+        return Nan::ThrowError(Nan::New("'dumpTrace' failed: " + error).ToLocalChecked());
+
+    info.GetReturnValue().Set(Nan::New(Trace::isCompiledIn()));
+}
+
+NAN_METHOD(GraphManagerInterface::setPerfCounters)
+{
+    if (info.Length() != 1)
+        return Nan::ThrowError(Nan::New("'setPerfCounters' expects 1 argument'").ToLocalChecked());
+
+    if (!info[0]->IsBoolean())
+        return Nan::ThrowError(Nan::New("'setPerfCounters' expects a boolean argument").ToLocalChecked());
+
+    const bool enabled = Nan::To<bool>(info[0]).FromJust();
+    if (enabled)
+        PerfCounters::reset();
+    PerfCounters::setEnabled(enabled);
+}
+
+NAN_METHOD(GraphManagerInterface::getPerfCounters)
+{
+    if (info.Length() != 0)
+        return Nan::ThrowError(Nan::New("'getPerfCounters' expects no arguments'").ToLocalChecked());
+
+    info.GetReturnValue().Set(toPerfObject(PerfCounters::summarize()));
 }
 
 NAN_METHOD(GraphManagerInterface::findBestExchangeRoute)
@@ -143,8 +685,6 @@ NAN_METHOD(GraphManagerInterface::findBestExchangeRoute)
     std::string srcStr = std::string(*utf8SrcStr);
     std::string destStr = std::string(*utf8DestStr);
 
-    std::cout << "Finding best route.." << std::endl;
-
     std::list<CurrencyPair> pairs = self->graphManager->findBestExchangeRoute(srcStr, destStr);
     v8::Local<v8::Array> array = Nan::New<v8::Array>(pairs.size());
 
@@ -155,7 +695,6 @@ NAN_METHOD(GraphManagerInterface::findBestExchangeRoute)
     unsigned i = 0;
     for (auto it = pairs.cbegin(); it != pairs.cend(); ++it)
     {
-        std::cout << *it << std::endl;
         std::string pairsString = it->getFromSymbol() + "," + it->getToSymbol() + "," + std::to_string(it->getPrice());
 
         // Convert std::string to v8::String type
@@ -166,4 +705,175 @@ NAN_METHOD(GraphManagerInterface::findBestExchangeRoute)
     }
 
     info.GetReturnValue().Set(array);
-}
\ No newline at end of file
+}
+
+NAN_METHOD(GraphManagerInterface::findBestExchangeRoutes)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 1)
+        return Nan::ThrowError(Nan::New("'findBestExchangeRoutes' expects 1 argument'").ToLocalChecked());
+
+    std::vector< std::pair<std::string, std::string> > routes;
+    if (!toRouteList(info[0], routes))
+        return Nan::ThrowError(Nan::New("'findBestExchangeRoutes' expects an array of [src, dest] string pairs").ToLocalChecked());
+
+    info.GetReturnValue().Set(toRouteArrays(self->graphManager->findBestExchangeRoutes(routes)));
+}
+
+NAN_METHOD(GraphManagerInterface::findAlternativeRoutes)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 3 && info.Length() != 4)
+        return Nan::ThrowError(Nan::New("'findAlternativeRoutes' expects 3 or 4 arguments'").ToLocalChecked());
+
+    if (!info[0]->IsString() || !info[1]->IsString())
+        return Nan::ThrowError(Nan::New("'findAlternativeRoutes' expects string currencies").ToLocalChecked());
+
+    if (!info[2]->IsUint32() || (info.Length() == 4 && !info[3]->IsUint32()))
+        return Nan::ThrowError(Nan::New("'findAlternativeRoutes' expects a number of routes and an optional maximum number of hops").ToLocalChecked());
+
+    // Convert arguments to std::string type
+    v8::String::Utf8Value utf8SrcStr(info[0]->ToString());
+    v8::String::Utf8Value utf8DestStr(info[1]->ToString());
+
+    std::string srcStr = std::string(*utf8SrcStr);
+    std::string destStr = std::string(*utf8DestStr);
+
+    const unsigned int k = Nan::To<uint32_t>(info[2]).FromJust();
+    const unsigned int maxHops = info.Length() == 4 ? Nan::To<uint32_t>(info[3]).FromJust() : 0;
+
+    info.GetReturnValue().Set(toRouteArrays(self->graphManager->findAlternativeRoutes(srcStr, destStr, k, maxHops)));
+}
+
+NAN_METHOD(GraphManagerInterface::getArbitrageCycles)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 0)
+        return Nan::ThrowError(Nan::New("'getArbitrageCycles' expects no arguments'").ToLocalChecked());
+
+    info.GetReturnValue().Set(toCycleObjects(self->graphManager->getArbitrageCycles()));
+}
+
+NAN_METHOD(GraphManagerInterface::findShortArbitrageCycles)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 3)
+        return Nan::ThrowError(Nan::New("'findShortArbitrageCycles' expects 3 arguments'").ToLocalChecked());
+
+    if (!info[0]->IsUint32() || !info[1]->IsUint32() || !info[2]->IsNumber())
+        return Nan::ThrowError(Nan::New("'findShortArbitrageCycles' expects a maximum length, a number of cycles and a fee rate").ToLocalChecked());
+
+    const unsigned int maxLength = Nan::To<uint32_t>(info[0]).FromJust();
+    const unsigned int topN = Nan::To<uint32_t>(info[1]).FromJust();
+    const double feeRate = Nan::To<double>(info[2]).FromJust();
+
+    info.GetReturnValue().Set(toCycleObjects(self->graphManager->findShortArbitrageCycles(maxLength, topN, feeRate)));
+}
+
+NAN_METHOD(GraphManagerInterface::updateGraphAsync)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 1)
+        return Nan::ThrowError(Nan::New("'updateGraphAsync' expects 1 argument'").ToLocalChecked());
+
+    if (!info[0]->IsString())
+        return Nan::ThrowError(Nan::New("'updateGraphAsync' expects a string argument").ToLocalChecked());
+
+    // Convert argument to std::string type
+    v8::String::Utf8Value utf8Str(info[0]->ToString());
+    std::string str = std::string(*utf8Str);
+
+    UpdateGraphWorker* worker = new UpdateGraphWorker(info.This(), *self->graphManager, str);
+    info.GetReturnValue().Set(worker->GetPromise());
+    Nan::AsyncQueueWorker(worker);
+}
+
+NAN_METHOD(GraphManagerInterface::updateGraphFromBufferAsync)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 1)
+        return Nan::ThrowError(Nan::New("'updateGraphFromBufferAsync' expects 1 argument'").ToLocalChecked());
+
+    if (!info[0]->IsArrayBufferView())
+        return Nan::ThrowError(Nan::New("'updateGraphFromBufferAsync' expects a Buffer or TypedArray with \"from,to,price\" lines").ToLocalChecked());
+
+    UpdateGraphFromBufferWorker* worker = new UpdateGraphFromBufferWorker(info.This(), *self->graphManager, info[0]);
+    info.GetReturnValue().Set(worker->GetPromise());
+    Nan::AsyncQueueWorker(worker);
+}
+
+NAN_METHOD(GraphManagerInterface::findBestExchangeRouteAsync)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 2)
+        return Nan::ThrowError(Nan::New("'findBestExchangeRouteAsync' expects 2 arguments'").ToLocalChecked());
+
+    if(!info[0]->IsString() || !info[1]->IsString())
+        return Nan::ThrowError(Nan::New("'findBestExchangeRouteAsync' expects string parameters").ToLocalChecked());
+
+    // Convert arguments to std::string type
+    v8::String::Utf8Value utf8SrcStr(info[0]->ToString());
+    v8::String::Utf8Value utf8DestStr(info[1]->ToString());
+
+    std::string srcStr = std::string(*utf8SrcStr);
+    std::string destStr = std::string(*utf8DestStr);
+
+    FindBestExchangeRouteWorker* worker = new FindBestExchangeRouteWorker(info.This(), *self->graphManager, srcStr, destStr);
+    info.GetReturnValue().Set(worker->GetPromise());
+    Nan::AsyncQueueWorker(worker);
+}
+
+NAN_METHOD(GraphManagerInterface::findBestExchangeRoutesAsync)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 1)
+        return Nan::ThrowError(Nan::New("'findBestExchangeRoutesAsync' expects 1 argument'").ToLocalChecked());
+
+    // the symbols are copied out of the JS values here, the worker thread cannot touch them
+    std::vector< std::pair<std::string, std::string> > routes;
+    if (!toRouteList(info[0], routes))
+        return Nan::ThrowError(Nan::New("'findBestExchangeRoutesAsync' expects an array of [src, dest] string pairs").ToLocalChecked());
+
+    FindBestExchangeRoutesWorker* worker = new FindBestExchangeRoutesWorker(info.This(), *self->graphManager, std::move(routes));
+    info.GetReturnValue().Set(worker->GetPromise());
+    Nan::AsyncQueueWorker(worker);
+}
+
+NAN_METHOD(GraphManagerInterface::getCostForExchangeAsync)
+{
+    // Unwrap the object
+    GraphManagerInterface* self = Nan::ObjectWrap::Unwrap<GraphManagerInterface>(info.This());
+
+    if (info.Length() != 2)
+        return Nan::ThrowError(Nan::New("'getCostForExchangeAsync' expects 2 arguments'").ToLocalChecked());
+
+    if (!info[0]->IsString() || !info[1]->IsString())
+        return Nan::ThrowError(Nan::New("'getCostForExchangeAsync' expects both arguments to be string types").ToLocalChecked());
+
+    // Convert arguments to std::string type
+    v8::String::Utf8Value utf8SrcStr(info[0]->ToString());
+    v8::String::Utf8Value utf8DestStr(info[1]->ToString());
+
+    std::string srcStr = std::string(*utf8SrcStr);
+    std::string destStr = std::string(*utf8DestStr);
+
+    GetCostForExchangeWorker* worker = new GetCostForExchangeWorker(info.This(), *self->graphManager, srcStr, destStr);
+    info.GetReturnValue().Set(worker->GetPromise());
+    Nan::AsyncQueueWorker(worker);
+}
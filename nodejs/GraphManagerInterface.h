@@ -6,14 +6,19 @@
 #include <memory>
 #include <string>
 #include <list>
+#include <utility>
+#include <vector>
 #include "../c++/include/GraphManager.h"
 #include "../c++/include/CurrencyPair.h"
 #include "../c++/include/CurrencyPairParser.h"
-#include "../c++/include/DirectedMatrixGraph.h"
+#include "../c++/include/DirectedSparseGraph.h"
+#include "../c++/include/PerfCounters.h"
+#include "../c++/include/Trace.h"
 
 class GraphManagerInterface : public Nan::ObjectWrap
 {
 private:
+    // safe to use from the libuv thread pool: updates are serialized by the manager, queries read snapshots
     std::unique_ptr<GraphManager> graphManager;
 
 public:
@@ -35,7 +40,58 @@ public:
     // static NAN_METHOD(getLastUpdateTimestamp);
     static NAN_METHOD(getCostForExchange);
 
+    // Calls and latency percentiles of every native operation and the size of the graph, see GraphManager::stats():
+    // { version, refreshes, vertices, edges, changedEdges, operations: { name: { count, samples, meanUs, p50Us, p90Us,
+    // p99Us, p999Us, maxUs } } }
+    static NAN_METHOD(getStats);
+
+    // (fileName): write the trace events of every thread as Chrome trace JSON, see Trace.h. Returns false when the
+    // library was built without tracing, the file then has no events
+    static NAN_METHOD(dumpTrace);
+
+    // (enabled): count cycles, instructions, cache and branch misses of the path kernels and ingestion phases, see
+    // PerfCounters.h. Enabling starts the counts over. getPerfCounters() returns { phase: { calls, ms, cycles,
+    // instructions, l1dMisses, llcMisses, branchMisses, pageFaults } }, null for the counters the machine does not offer
+    static NAN_METHOD(setPerfCounters);
+    static NAN_METHOD(getPerfCounters);
+
     // Methods
     static NAN_METHOD(updateGraph);
+    static NAN_METHOD(updateGraphFromBuffer);
+    static NAN_METHOD(internCurrency);
+    static NAN_METHOD(applyRateBatch);
     static NAN_METHOD(findBestExchangeRoute);
+
+    // (fileName, withAllPairs): write the graph to a binary snapshot, with the all-pairs distances if withAllPairs is
+    // true (false if left out). loadSnapshot(fileName) starts an empty graph from such a file. Both throw on failure
+    static NAN_METHOD(saveSnapshot);
+    static NAN_METHOD(loadSnapshot);
+
+    // (fileName): append every rate applied from now on to a tick log, for bench/TickReplay. stopRecording() closes it.
+    // Both throw on failure
+    static NAN_METHOD(startRecording);
+    static NAN_METHOD(stopRecording);
+
+    // routes: array of [src, dest] symbol pairs. Returns one array of "from,to,price" strings per route, computing
+    // the routes from the same source together
+    static NAN_METHOD(findBestExchangeRoutes);
+
+    // (src, dest, k, maxHops): the k best routes, best first, each as an array of "from,to,price" strings.
+    // maxHops is optional, no limit if left out
+    static NAN_METHOD(findAlternativeRoutes);
+
+    // Arbitrage found by the last update, most profitable first. Each cycle is an object with 'pairs', an array of
+    // "from,to,price" strings ending where it started, and 'gain', the relative profit of going around once
+    static NAN_METHOD(getArbitrageCycles);
+
+    // (maxLength, topN, feeRate): every cycle of up to maxLength (2 to 4) pairs ranked by gain after paying feeRate on
+    // each exchange, in the format of getArbitrageCycles
+    static NAN_METHOD(findShortArbitrageCycles);
+
+    // Async methods: the work runs on the libuv thread pool and the returned Promise resolves with the result
+    static NAN_METHOD(updateGraphAsync);
+    static NAN_METHOD(updateGraphFromBufferAsync);
+    static NAN_METHOD(findBestExchangeRouteAsync);
+    static NAN_METHOD(getCostForExchangeAsync);
+    static NAN_METHOD(findBestExchangeRoutesAsync);
 };
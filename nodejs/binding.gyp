@@ -2,19 +2,20 @@
   "targets": [
     {
       "target_name": "module",
-      "sources": [ 
+      "sources": [
         "GraphManagerModule.cpp",
         "GraphManagerInterface.cpp"
         ],
         'link_settings': {
             'libraries': [
-              '-lproject',
-              '-std=c++11',
-              '-mmacosx-version-min=10.13'
+              '-lproject'
             ],
             'library_dirs': [
               '$(srcdir)/lib',
             ],
+            'ldflags': [
+              '-pthread'
+            ],
       },
 
       "include_dirs": [
@@ -22,11 +23,29 @@
         "../c++/src",
         "../c++/include"
       ],
+      # the async workers catch exceptions thrown by the library, and its ThreadPool needs pthreads
+      'cflags': [
+        '-pthread'
+      ],
+      'cflags_cc!': [
+        '-fno-exceptions'
+      ],
+      'conditions': [
+        ['OS=="mac"', {
+          'link_settings': {
+            'libraries': [
+              '-std=c++11',
+              '-mmacosx-version-min=10.13'
+            ],
+          },
+        }],
+      ],
       'xcode_settings': {
         'OTHER_CFLAGS': [
           '-std=c++11',
           "-mmacosx-version-min=10.13"
         ],
+        'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',
         'MACOSX_DEPLOYMENT_TARGET': '10.13'
       }
     }
@@ -142,22 +142,38 @@ exports.getTickersMap = function(_callback) {
     });
 }
 
+// "quote,base,last" line for every ticker
+function formatCurrencyData(tickers) {
+    let lines = [];
+
+    tickers.forEach(function(tickerData, symbol) {
+        lines.push(`${tickerData.get('quoteCurrency')},${tickerData.get('baseCurrency')},${tickerData.get('last')}\n`);
+    });
+
+    return lines.join('');
+}
+
 exports.writeNewCurrencyDataToFile = function(filename, _callback) {
     exports.getTickersMap(function(err, data) {
         if(!err)
         {
-            data.forEach(function(tickerData, symbol) {
-
-                let dataToWrite = `${tickerData.get('quoteCurrency')},${tickerData.get('baseCurrency')},${tickerData.get('last')}\n`;
-
-                fs.appendFileSync(filename, dataToWrite);
+            fs.writeFile(filename, formatCurrencyData(data), function(err) {
+                console.log("Done");
+                _callback(err);
             });
-            console.log("Done");
-
-            _callback(null);
         }
         else
             _callback(err);
 
     });
+}
+
+// Same data as writeNewCurrencyDataToFile, in a Buffer for graphManager.updateGraphFromBuffer
+exports.getCurrencyDataBuffer = function(_callback) {
+    exports.getTickersMap(function(err, data) {
+        if(!err)
+            _callback(null, Buffer.from(formatCurrencyData(data)));
+        else
+            _callback(err, null);
+    });
 }
\ No newline at end of file
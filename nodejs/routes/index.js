@@ -18,11 +18,11 @@ getCurrenciesMapPromise = function() {
   });
 }
 
-writeNewCurrencyDataToFilePromise = function(filename) {
+getCurrencyDataBufferPromise = function() {
   return new Promise(function(resolve, reject) {
-    client.writeNewCurrencyDataToFile(filename, function(err) {
+    client.getCurrencyDataBuffer(function(err, buffer) {
       if (!err)
-        resolve();
+        resolve(buffer);
       else
         reject(err);
     })
@@ -64,16 +64,23 @@ router.get('/', function(req, res, next) {
          res.render('index', { title: 'Kryptos' , hasResult: false, currenciesMap: currenciesMap, tradesArray: tradesArray});
        }
        else {
-        const filename = `currency_data-${Date.now()}.csv`
-        var writeDataPromise = writeNewCurrencyDataToFilePromise(filename);
+        var currencyDataPromise = getCurrencyDataBufferPromise();
   
-        writeDataPromise.then(function() {
-          graphManager.updateGraph(filename);
-          tradesArray = graphManager.findBestExchangeRoute(req.query.src, req.query.dest);
+        currencyDataPromise.then(function(buffer) {
+          // the tickers go straight from memory into the graph, no file is written.
+          // The native work runs on the libuv thread pool, other requests are served meanwhile
+          return graphManager.updateGraphFromBufferAsync(buffer);
+        }).then(function() {
+          return Promise.all([
+            graphManager.findBestExchangeRouteAsync(req.query.src, req.query.dest),
+            graphManager.getCostForExchangeAsync(req.query.src, req.query.dest)
+          ]);
+        }).then(function(results) {
+          tradesArray = results[0];
           console.log(tradesArray);
 
           var calculatedSourceAmount = req.query.amount;
-          var directSrcAmount = graphManager.getCostForExchange(req.query.src, req.query.dest) * req.query.amount;
+          var directSrcAmount = results[1] * req.query.amount;
 
           tradesArray.forEach(function(element) {
             let tradePair = element.split(',')